@@ -73,7 +73,7 @@ E_SBFSPOT ArchData::importDayData(std::vector<InverterData>& inverters, time_t s
 
 	startTime -= 86400;		// fix Issue CP23: to overcome problem with DST transition - RB@20140330
     struct tm start_tm;
-    memcpy(&start_tm, localtime(&startTime), sizeof(start_tm));
+    start_tm = localtime_tm(startTime);
 
     start_tm.tm_hour = 0;
     start_tm.tm_min = 0;
@@ -98,13 +98,15 @@ E_SBFSPOT ArchData::importDayData(std::vector<InverterData>& inverters, time_t s
 
     E_SBFSPOT rc = E_OK;
     E_SBFSPOT hasData = E_ARCHNODATA;
+    const sma::LocalDay day(startTime);
 
     for (auto& inverter : inverters)
     {
-        if ((inverter.DevClass != CommunicationProduct) && (inverter.SUSyID != SID_MULTIGATE))
+        if (!inverter.unreachable && (inverter.DevClass != CommunicationProduct) && (inverter.SUSyID != SID_MULTIGATE))
 		{
             auto buffer = m_sbfSpot.encodeHistoricDayDataRequest(inverter.SUSyID, inverter.serial, startTime - 300, startTime + 86100, inverter.BTAddress);
             m_socket.send(buffer, inverter.IPAddress);
+            const uint16_t packetId = m_sbfSpot.packetId();
 
 			do
 			{
@@ -115,11 +117,9 @@ E_SBFSPOT ArchData::importDayData(std::vector<InverterData>& inverters, time_t s
 				time_t datetime_next = 0;
 				bool dblrecord = false;		// Flag for double records (twins)
 
-				const int recordsize = 12;
-
 				do
 				{
-                    rc = m_socket.getPacket(m_buffer, inverter.BTAddress, 1);
+                    rc = m_socket.getPacket(m_buffer, inverter.BTAddress, 1, inverter.serial, packetId);
                     if (rc != E_OK) return E_NODATA;
 
                     packetcount = m_buffer.data()[25];
@@ -131,12 +131,15 @@ E_SBFSPOT ArchData::importDayData(std::vector<InverterData>& inverters, time_t s
 					else
 					{
                         unsigned short rcvpcktID = get_short(m_buffer.data().data()+27) & 0x7FFF;
-						if ((validPcktID == 1) || (pcktID == rcvpcktID))
+						if ((validPcktID == 1) || (packetId == rcvpcktID))
 						{
 							validPcktID = 1;
-							for(int x = 41; x < (packetposition - 3); x += recordsize)
+                            m_records.clear();
+                            if (m_buffer.data().size() > 41)
+                                sma::decodeArchiveRecords(m_buffer.data().data() + 41, m_buffer.data().size() - 41, m_records);
+							for (size_t i = 0; i < m_records.size(); i++)
 							{
-                                datetime_next = (time_t)get_long(m_buffer.data().data() + x);
+                                datetime_next = m_records.datetime[i];
 								if (0 != (datetime_next - datetime)) // Fix Issue 108: sbfspot v307 crashes for daily export (-adnn)
 								{
 									totalWh_prev = totalWh;
@@ -147,17 +150,16 @@ E_SBFSPOT ArchData::importDayData(std::vector<InverterData>& inverters, time_t s
 								else
 									dblrecord = true;
 
-                                totalWh = (unsigned long long)get_longlong(m_buffer.data().data() + x + 4);
-								if (totalWh != NaN_U64) // Fix Issue 109: Bad request 400: Power value too high for system size
+                                totalWh = m_records.totalWh[i];
+								if (m_records.valid[i]) // Fix Issue 109: Bad request 400: Power value too high for system size
 								{
 									if (totalWh > 0) hasData = E_OK;
 									if (totalWh_prev != 0)
 									{
-										struct tm timeinfo;
-										memcpy(&timeinfo, localtime(&datetime), sizeof(timeinfo));
-										if (start_tm.tm_mday == timeinfo.tm_mday)
+										const int slot = day.slot(datetime);
+										if (slot >= 0)
 										{
-											unsigned int idx = (timeinfo.tm_hour * 12) + (timeinfo.tm_min / 5);
+											unsigned int idx = slot;
                                             if (idx < inverter.dayData.size())
                                             {
 												if (VERBOSE_HIGHEST && dblrecord)
@@ -187,7 +189,7 @@ E_SBFSPOT ArchData::importDayData(std::vector<InverterData>& inverters, time_t s
 						}
 						else
 						{
-							if (DEBUG_HIGHEST) printf("Packet ID mismatch. Expected %d, received %d\n", pcktID, rcvpcktID);
+							if (DEBUG_HIGHEST) printf("Packet ID mismatch. Expected %d, received %d\n", packetId, rcvpcktID);
 							validPcktID = 0;
 							packetcount = 0;
 						}
@@ -237,7 +239,7 @@ E_SBFSPOT ArchData::importDayData(std::vector<InverterData>& inverters, time_t s
 
 E_SBFSPOT ArchData::importMonthData(std::vector<InverterData>& inverters, tm *start_tm)
 {
-    if (VERBOSE_NORMAL)
+    if (VERBOSE_NORMAL && !m_quiet)
     {
         puts("**********************");
         puts("* importMonthData() *");
@@ -255,7 +257,7 @@ E_SBFSPOT ArchData::importMonthData(std::vector<InverterData>& inverters, tm *st
     start_tm->tm_mday = 1;
     time_t startTime = mktime(start_tm);
 
-    if (VERBOSE_NORMAL)
+    if (VERBOSE_NORMAL && !m_quiet)
         printf("startTime = %lu -> %s\n", startTime, strftime_t("%d/%m/%Y %H:%M:%S", startTime));
 
     for (auto& inverter : inverters)
@@ -275,33 +277,22 @@ E_SBFSPOT ArchData::importMonthData(std::vector<InverterData>& inverters, tm *st
 
     for (auto& inverter : inverters)
     {
-        if ((inverter.DevClass != CommunicationProduct) && (inverter.SUSyID != SID_MULTIGATE))
+        if (!inverter.unreachable && (inverter.DevClass != CommunicationProduct) && (inverter.SUSyID != SID_MULTIGATE))
 		{
-			do
-			{
-				pcktID++;
-                m_buffer.writePacketHeader(0x01, inverter.BTAddress);
-                m_buffer.writePacket(0x09, 0xE0, 0, inverter.SUSyID, inverter.serial);
-                m_buffer.writeLong(0x70200200);
-                m_buffer.writeLong(startTime - 86400 - 86400);
-                m_buffer.writeLong(startTime + 86400 * (sizeof(inverter.monthData)/sizeof(MonthData) +1));
-                m_buffer.writePacketTrailer();
-                m_buffer.writePacketLength();
-			}
-            while (!m_buffer.isCrcValid());
-            m_socket.send(m_buffer.data(), inverter.IPAddress);
+            auto buffer = m_sbfSpot.encodeHistoricMonthDataRequest(inverter.SUSyID, inverter.serial, startTime - 86400 - 86400, startTime + 86400 * (sizeof(inverter.monthData)/sizeof(MonthData) +1), inverter.BTAddress);
+            m_socket.send(buffer, inverter.IPAddress);
+            const uint16_t packetId = m_sbfSpot.packetId();
 
 			do
 			{
 				unsigned long long totalWh = 0;
 				unsigned long long totalWh_prev = 0;
-				const int recordsize = 12;
 				time_t datetime;
 
 				unsigned int idx = 0;
 				do
 				{
-                    rc = m_socket.getPacket(m_buffer, inverter.BTAddress, 1);
+                    rc = m_socket.getPacket(m_buffer, inverter.BTAddress, 1, inverter.serial, packetId);
                     if (rc != E_OK) return E_NODATA;
 
                     //TODO: Move checksum validation to bthGetPacket
@@ -311,22 +302,25 @@ E_SBFSPOT ArchData::importMonthData(std::vector<InverterData>& inverters, tm *st
 					{
                         packetcount = m_buffer.data()[25];
                         unsigned short rcvpcktID = get_short(m_buffer.data().data()+27) & 0x7FFF;
-						if ((validPcktID == 1) || (pcktID == rcvpcktID))
+						if ((validPcktID == 1) || (packetId == rcvpcktID))
 						{
 							validPcktID = 1;
 
-							for(int x = 41; x < (packetposition - 3); x += recordsize)
+                            m_records.clear();
+                            if (m_buffer.data().size() > 41)
+                                sma::decodeArchiveRecords(m_buffer.data().data() + 41, m_buffer.data().size() - 41, m_records);
+							for (size_t i = 0; i < m_records.size(); i++)
 							{
-                                datetime = (time_t)get_long(m_buffer.data().data() + x);
+                                datetime = m_records.datetime[i];
 								//datetime -= (datetime % 86400) + 43200; // 3.0 - Round to UTC 12:00 - Removed 3.0.1 see issue C54
                                 datetime += inverter.monthDataOffset; // Issues 115/130
-                                totalWh = get_longlong(m_buffer.data().data() + x + 4);
-								if (totalWh != MAXULONGLONG)
+                                totalWh = m_records.totalWh[i];
+								if (m_records.valid[i])
 								{
 									if (totalWh_prev != 0)
 									{
 										struct tm utc_tm;
-										memcpy(&utc_tm, gmtime(&datetime), sizeof(utc_tm));
+										utc_tm = gmtime_tm(datetime);
 										if (utc_tm.tm_mon == start_tm->tm_mon)
 										{
                                             if (idx < sizeof(inverter.monthData)/sizeof(MonthData))
@@ -345,7 +339,7 @@ E_SBFSPOT ArchData::importMonthData(std::vector<InverterData>& inverters, tm *st
 						}
 						else
 						{
-							if (DEBUG_HIGHEST) printf("Packet ID mismatch. Expected %d, received %d\n", pcktID, rcvpcktID);
+							if (DEBUG_HIGHEST) printf("Packet ID mismatch. Expected %d, received %d\n", packetId, rcvpcktID);
 							validPcktID = 0;
 							packetcount = 0;
 						}
@@ -365,7 +359,7 @@ E_SBFSPOT ArchData::importMonthData(std::vector<InverterData>& inverters, tm *st
 		 *	Add totalWh and power of each device to multigate daydata
 		 */
 
-		if (VERBOSE_HIGHEST) std::cout << "Consolidating monthdata of micro-inverters into multigate..." << std::endl;
+		if (VERBOSE_HIGHEST && !m_quiet) std::cout << "Consolidating monthdata of micro-inverters into multigate..." << std::endl;
 
         for (uint32_t mg=0; mg < inverters.size(); mg++)
 		{
@@ -405,26 +399,19 @@ E_SBFSPOT ArchData::ArchiveEventData(std::vector<InverterData>& inverters, boost
 
     for (auto& inverter : inverters)
     {
-        do
-        {
-            pcktID++;
-            m_buffer.writePacketHeader(0x01, inverter.BTAddress);
-            m_buffer.writePacket(0x09, 0xE0, 0, inverter.SUSyID, inverter.serial);
-            m_buffer.writeLong(UserGroup == UG_USER ? 0x70100200 : 0x70120200);
-            m_buffer.writeLong(startTime);
-            m_buffer.writeLong(endTime);
-            m_buffer.writePacketTrailer();
-            m_buffer.writePacketLength();
-        }
-        while (!m_buffer.isCrcValid());
-        m_socket.send(m_buffer.data(), inverter.IPAddress);
+        if (inverter.unreachable)
+            continue;
+
+        auto buffer = m_sbfSpot.encodeEventDataRequest(inverter.SUSyID, inverter.serial, startTime, endTime, (SmaUserGroup)UserGroup, inverter.BTAddress);
+        m_socket.send(buffer, inverter.IPAddress);
+        const uint16_t packetId = m_sbfSpot.packetId();
 
 		bool FIRST_EVENT_FOUND = false;
         do
         {
             do
             {
-                rc = m_socket.getPacket(m_buffer, inverter.BTAddress, 1);
+                rc = m_socket.getPacket(m_buffer, inverter.BTAddress, 1, inverter.serial, packetId);
                 if (rc != E_OK) return rc;
 
                 //TODO: Move checksum validation to bthGetPacket
@@ -434,27 +421,19 @@ E_SBFSPOT ArchData::ArchiveEventData(std::vector<InverterData>& inverters, boost
                 {
                     pcktcount = get_short(m_buffer.data().data()+25);
                     unsigned short rcvpcktID = get_short(m_buffer.data().data()+27) & 0x7FFF;
-                    if ((validPcktID == 1) || (pcktID == rcvpcktID))
+                    if ((validPcktID == 1) || (packetId == rcvpcktID))
                     {
                         validPcktID = 1;
-                        for (int x = 41; x < (packetposition - 3); x += sizeof(SMA_EVENTDATA))
+                        if (decodeEventData(m_buffer.data().data(), m_buffer.data().size(), UserGroup, inverter.eventData))
                         {
-                            SMA_EVENTDATA *pEventData = (SMA_EVENTDATA *)(m_buffer.data().data() + x);
-							if (pEventData->DateTime > 0)	// Fix Issue 89
-							{
-                                inverter.eventData.push_back(EventData(UserGroup, pEventData));
-								if (pEventData->EntryID == 1)
-								{
-									FIRST_EVENT_FOUND = true;
-									rc = E_EOF;
-								}
-							}
-						}
+                            FIRST_EVENT_FOUND = true;
+                            rc = E_EOF;
+                        }
 
                     }
                     else
                     {
-                        if (DEBUG_HIGHEST) printf("Packet ID mismatch. Expected %d, received %d\n", pcktID, rcvpcktID);
+                        if (DEBUG_HIGHEST) printf("Packet ID mismatch. Expected %d, received %d\n", packetId, rcvpcktID);
                         validPcktID = 0;
                         pcktcount = 0;
                     }
@@ -475,13 +454,12 @@ E_SBFSPOT ArchData::getMonthDataOffset(std::vector<InverterData>& inverters)
 
 	time_t now = time(NULL);
 	struct tm now_tm;
-	memcpy(&now_tm, gmtime(&now), sizeof(now_tm));
+	now_tm = gmtime_tm(now);
 
-	// Temporarily disable verbose logging
-	int currentVerboseLevel = verbose;
-	verbose = 0;
+	// Temporarily disable verbose logging of this instance, the global level is shared by the workers of InverterPool
+	m_quiet = true;
     rc = importMonthData(inverters, &now_tm);
-    verbose = currentVerboseLevel;
+    m_quiet = false;
     if (rc != E_OK) return rc;
 
     for (auto& inverter : inverters)
@@ -495,10 +473,10 @@ E_SBFSPOT ArchData::getMonthDataOffset(std::vector<InverterData>& inverters)
                 if (inverter.monthData[i].datetime != 0)
                 {
                     now = time(NULL);
-                    memcpy(&now_tm, gmtime(&now), sizeof(now_tm));
+                    now_tm = gmtime_tm(now);
 
                     struct tm inv_tm;
-                    memcpy(&inv_tm, gmtime(&inverter.monthData[i].datetime), sizeof(inv_tm));
+                    inv_tm = gmtime_tm(inverter.monthData[i].datetime);
 
                     if (now_tm.tm_yday == inv_tm.tm_yday)
                         inverter.monthDataOffset = -86400;
@@ -38,6 +38,7 @@ DISCLAIMER:
 
 #include "SBFNet.h"
 #include "Types.h"
+#include "sma/SmaArchive.h"
 
 class SbfSpot;
 class Socket;
@@ -56,4 +57,6 @@ private:
     Socket& m_socket;
     SbfSpot& m_sbfSpot;
     Buffer  m_buffer;
+    sma::ArchiveRecords m_records;
+    bool m_quiet = false;   // No verbose output of importMonthData()
 };
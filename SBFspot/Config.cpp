@@ -277,6 +277,40 @@ int Config::parseCmdline(int argc, char **argv)
             }
         }
 
+        else if (strnicmp(argv[i], "-record:", 8) == 0)
+        {
+            if (strlen(argv[i]) == 8)
+            {
+                invalidArg(argv[i]);
+                return -1;
+            }
+            else
+                this->recordFile = argv[i] + 8;
+        }
+
+        else if (strnicmp(argv[i], "-replay:", 8) == 0)
+        {
+            if (strlen(argv[i]) == 8)
+            {
+                invalidArg(argv[i]);
+                return -1;
+            }
+            else
+                this->replayFile = argv[i] + 8;
+        }
+
+        else if (strnicmp(argv[i], "-replayspeed:", 13) == 0)
+        {
+            double dValue = strtod(argv[i] + 13, &pEnd);
+            if ((strlen(argv[i]) == 13) || (dValue < 0) || (*pEnd != 0))
+            {
+                invalidArg(argv[i]);
+                return -1;
+            }
+            else
+                this->replaySpeed = dValue;
+        }
+
         //look for alternative config file
         else if (strnicmp(argv[i], "-cfg", 4) == 0)
         {
@@ -466,6 +500,69 @@ int Config::readConfig()
                 else if (stricmp(variable, "Longitude") == 0) this->longitude = (float)atof(value);
                 else if (stricmp(variable, "LiveInterval") == 0) this->liveInterval = (uint16_t)atoi(value);
                 else if (stricmp(variable, "ArchiveInterval") == 0) this->archiveInterval = (uint16_t)atoi(value);
+                else if (stricmp(variable, "PollTimeout") == 0)
+                {
+                    lValue = strtol(value, &pEnd, 10);
+                    if ((lValue >= 100) && (lValue <= 10000) && (*pEnd == 0))
+                        this->pollTimeout = (uint16_t)lValue;
+                    else
+                    {
+                        fprintf(stderr, CFG_InvalidValue, variable, "(100-10000)");
+                        rc = -2;
+                    }
+                }
+                else if (stricmp(variable, "FastInterval") == 0)
+                {
+                    lValue = strtol(value, &pEnd, 10);
+                    if (((lValue == 0) || ((lValue >= 100) && (lValue <= 10000))) && (*pEnd == 0))
+                        this->fastInterval = (uint16_t)lValue;
+                    else
+                    {
+                        fprintf(stderr, CFG_InvalidValue, variable, "(0 or 100-10000)");
+                        rc = -2;
+                    }
+                }
+                else if ((stricmp(variable, "ACInterval") == 0) ||
+                         (stricmp(variable, "DCInterval") == 0) ||
+                         (stricmp(variable, "StatusInterval") == 0) ||
+                         (stricmp(variable, "NameplateInterval") == 0))
+                {
+                    lValue = strtol(value, &pEnd, 10);
+                    if ((lValue >= 0) && (lValue <= 604800) && (*pEnd == 0))
+                    {
+                        if (stricmp(variable, "ACInterval") == 0) this->acInterval = (uint32_t)lValue;
+                        else if (stricmp(variable, "DCInterval") == 0) this->dcInterval = (uint32_t)lValue;
+                        else if (stricmp(variable, "StatusInterval") == 0) this->statusInterval = (uint32_t)lValue;
+                        else this->nameplateInterval = (uint32_t)lValue;
+                    }
+                    else
+                    {
+                        fprintf(stderr, CFG_InvalidValue, variable, "(0-604800)");
+                        rc = -2;
+                    }
+                }
+                else if (stricmp(variable, "KeepSession") == 0)
+                {
+                    lValue = strtol(value, &pEnd, 10);
+                    if (((lValue == 0) || (lValue == 1)) && (*pEnd == 0))
+                        this->keepSession = (int)lValue;
+                    else
+                    {
+                        fprintf(stderr, CFG_InvalidValue, variable, CFG_Boolean);
+                        rc = -2;
+                    }
+                }
+                else if (stricmp(variable, "Workers") == 0)
+                {
+                    lValue = strtol(value, &pEnd, 10);
+                    if ((lValue >= 1) && (lValue <= (long)MAX_INVERTERS) && (*pEnd == 0))
+                        this->workers = (int)lValue;
+                    else
+                    {
+                        fprintf(stderr, CFG_InvalidValue, variable, "(1-20)");
+                        rc = -2;
+                    }
+                }
                 else if (stricmp(variable, "Plantname") == 0) this->plantname = value;
                 else if (stricmp(variable, "CalculateMissingSpotValues") == 0)
                 {
@@ -837,6 +934,14 @@ void Config::showConfig()
         "\nLongitude=" << this->longitude << \
         "\nTimezone=" << this->timezone << \
         "\nCalculateMissingSpotValues=" << this->calcMissingSpot << \
+        "\nKeepSession=" << this->keepSession << \
+        "\nWorkers=" << this->workers << \
+        "\nPollTimeout=" << this->pollTimeout << \
+        "\nFastInterval=" << this->fastInterval << \
+        "\nACInterval=" << this->acInterval << \
+        "\nDCInterval=" << this->dcInterval << \
+        "\nStatusInterval=" << this->statusInterval << \
+        "\nNameplateInterval=" << this->nameplateInterval << \
         "\nDateTimeFormat=" << this->DateTimeFormat << \
         "\nDateFormat=" << this->DateFormat << \
         "\nTimeFormat=" << this->TimeFormat << \
@@ -916,6 +1021,9 @@ void Config::sayHello(int ShowHelp)
         std::cout << " -password:xxxx      Installer password\n";
         std::cout << " -loadlive           Use predefined settings for manual upload to pvoutput.org\n";
         std::cout << " -startdate:YYYYMMDD Set start date for historic data retrieval\n";
+        std::cout << " -record:file        Record the Speedwire traffic to file\n";
+        std::cout << " -replay:file        Replay a recorded file instead of talking to the devices\n";
+        std::cout << " -replayspeed:X      Replay speed: 1=original (default), 10=10x faster, 0=as fast as possible\n";
         std::cout << " settime             Sync inverter time with host time\n";
         std::cout << " importhistoricaldata Get historical day and month data from inverters\n";
         std::cout << " importdatabase       Import data from old database\n";
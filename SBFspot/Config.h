@@ -89,6 +89,14 @@ struct Config
     std::vector<StringConfig> pvArrays;    // Module array configurations
     uint16_t liveInterval = 60;
     uint16_t archiveInterval = 300;
+    uint16_t pollTimeout = 1000;        // [ms] Longest time a poll of the daemon waits for the inverters
+    uint16_t fastInterval = 0;          // [ms] Sub-second polling of the AC power, 0=off
+    uint32_t acInterval = 0;            // [sec] Polling period of the AC values, 0=every poll
+    uint32_t dcInterval = 0;            // [sec] Polling period of the DC values, 0=every poll
+    uint32_t statusInterval = 0;        // [sec] Polling period of status, energy and operation time, 0=every poll
+    uint32_t nameplateInterval = 86400; // [sec] Polling period of type label, software version and max AC power, 0=every poll
+    int     keepSession = 0;    // 1=Stay logged on between the polls of the daemon
+    int     workers = 1;        // Number of threads polling the inverters (Speedwire only)
     char	delimiter = ';';    // CSV field delimiter
     int		precision = 3;      // CSV value precision
     char	decimalpoint = ','; // CSV decimal point
@@ -140,6 +148,9 @@ struct Config
     int		loadlive = 0;       // -loadlive	Force settings to prepare for live loading to http://pvoutput.org/loadlive.jsp
     time_t	startdate = 0;      // -startdate	Start reading of historic data at the given date (YYYYMMDD)
     S123_COMMAND    s123 = S123_NOP;    // -123s		123Solar Web Solar logger support(http://www.123solar.org/)
+    std::string recordFile;     // -record:		Record the Speedwire traffic to a trace file
+    std::string replayFile;     // -replay:		Replay a recorded trace instead of talking to the devices
+    double  replaySpeed = 1.0;  // -replayspeed:	Replay speed (1=original, 0=as fast as possible)
 
     enum class Command {
         Invalid,
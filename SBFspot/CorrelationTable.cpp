@@ -0,0 +1,124 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#include "CorrelationTable.h"
+
+#include <algorithm>
+#include <cstring>
+
+CorrelationTable::CorrelationTable(size_t stashSlots, size_t maxPacketSize) :
+    m_stash(stashSlots),
+    m_maxPacketSize(maxPacketSize)
+{
+    for (auto& slot : m_stash)
+        slot.data.reset(new uint8_t[maxPacketSize]);
+}
+
+void CorrelationTable::clear()
+{
+    m_entries.clear();
+    m_pending = 0;
+}
+
+void CorrelationTable::expect(uint32_t serial, uint16_t packetId, uint32_t address, size_t index)
+{
+    Entry entry = { packetId, serial, address, index, false };
+
+    // Requests are mostly registered in packet ID order, so this is an append
+    auto it = std::upper_bound(m_entries.begin(), m_entries.end(), entry,
+                               [](const Entry& a, const Entry& b) { return a.packetId < b.packetId; });
+    m_entries.insert(it, entry);
+    ++m_pending;
+}
+
+int CorrelationTable::complete(uint32_t serial, uint16_t packetId, uint32_t address)
+{
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), packetId,
+                               [](const Entry& a, uint16_t id) { return a.packetId < id; });
+
+    for (; (it != m_entries.end()) && (it->packetId == packetId); ++it)
+    {
+        if (!it->done && matches(it->serial, it->address, serial, address))
+        {
+            it->done = true;
+            --m_pending;
+            return (int)it->index;
+        }
+    }
+
+    return -1;
+}
+
+void CorrelationTable::stash(uint32_t serial, uint16_t packetId, uint32_t address, const uint8_t* data, size_t size)
+{
+    if (m_stash.empty() || (size == 0) || (size > m_maxPacketSize))
+        return;
+
+    // Take a free slot or replace the oldest one
+    auto slot = std::min_element(m_stash.begin(), m_stash.end(),
+                                 [](const StashSlot& a, const StashSlot& b) { return a.age < b.age; });
+
+    slot->serial = serial;
+    slot->packetId = packetId;
+    slot->address = address;
+    slot->size = size;
+    slot->age = ++m_stashAge;
+    memcpy(slot->data.get(), data, size);
+}
+
+size_t CorrelationTable::takeStashed(uint32_t serial, uint16_t packetId, uint32_t address, uint8_t* data, size_t size)
+{
+    StashSlot* oldest = nullptr;
+    for (auto& slot : m_stash)
+    {
+        if ((slot.size != 0) && (slot.packetId == packetId) && matches(serial, address, slot.serial, slot.address) &&
+                ((oldest == nullptr) || (slot.age < oldest->age)))
+            oldest = &slot;
+    }
+
+    if ((oldest == nullptr) || (oldest->size > size))
+        return 0;
+
+    size_t result = oldest->size;
+    memcpy(data, oldest->data.get(), result);
+    oldest->size = 0;
+    oldest->age = 0;
+
+    return result;
+}
+
+size_t CorrelationTable::stashed() const
+{
+    return std::count_if(m_stash.begin(), m_stash.end(), [](const StashSlot& slot) { return slot.size != 0; });
+}
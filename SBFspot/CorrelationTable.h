@@ -0,0 +1,112 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+ * Tracks the outstanding Speedwire requests by (serial, packet ID) of the
+ * inverter they are sent to. Responses that do not belong to an outstanding
+ * request (late, early or out of order) are kept in a small ring, so they can
+ * still complete a request that is registered later.
+ *
+ * Nothing is allocated once the table has seen its largest poll cycle.
+ */
+class CorrelationTable
+{
+public:
+    static const uint32_t AnySerial = 0xFFFFFFFF;
+
+    CorrelationTable(size_t stashSlots, size_t maxPacketSize);
+
+    // Forget all outstanding requests (stashed responses are kept)
+    void clear();
+
+    // Register request 'index'. A serial of AnySerial matches any responder
+    // at the given IPv4 address (network byte order).
+    void expect(uint32_t serial, uint16_t packetId, uint32_t address, size_t index);
+
+    // Index of the outstanding request matching the response, or -1.
+    // The request is no longer outstanding afterwards.
+    int complete(uint32_t serial, uint16_t packetId, uint32_t address);
+
+    // Number of outstanding requests
+    size_t pending() const { return m_pending; }
+
+    // Keep a copy of a response nobody is waiting for (yet)
+    void stash(uint32_t serial, uint16_t packetId, uint32_t address, const uint8_t* data, size_t size);
+
+    // Copy the oldest stashed response that would complete a request for
+    // (serial, packet ID, address) to data and remove it from the stash.
+    // Returns its size or 0 if there is none.
+    size_t takeStashed(uint32_t serial, uint16_t packetId, uint32_t address, uint8_t* data, size_t size);
+
+    size_t stashed() const;
+
+private:
+    struct Entry
+    {
+        uint16_t packetId;
+        uint32_t serial;
+        uint32_t address;
+        size_t index;
+        bool done;
+    };
+
+    struct StashSlot
+    {
+        uint32_t serial = 0;
+        uint16_t packetId = 0;
+        uint32_t address = 0;
+        size_t size = 0;                // 0: slot is free
+        uint64_t age = 0;
+        std::unique_ptr<uint8_t[]> data;
+    };
+
+    static bool matches(uint32_t serial, uint32_t address, uint32_t rcvSerial, uint32_t rcvAddress)
+    {
+        // Requests to any serial (e.g. init) are told apart by the address of the inverter
+        return (serial == rcvSerial) || ((serial == AnySerial) && (address == rcvAddress));
+    }
+
+    std::vector<Entry> m_entries;       // Sorted by packet ID
+    size_t m_pending = 0;
+    std::vector<StashSlot> m_stash;
+    size_t m_maxPacketSize;
+    uint64_t m_stashAge = 0;
+};
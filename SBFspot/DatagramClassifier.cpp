@@ -0,0 +1,63 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#include "DatagramClassifier.h"
+
+#include <cstring>
+
+static const uint8_t DISCOVERY_RESPONSE[] = { 0x53, 0x4D, 0x41, 0x00, 0x00, 0x04, 0x02, 0xA0, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01 };
+static const uint32_t LOCALHOST = 0x7F000001;
+
+void DatagramClassifier::setLocalAddresses(const std::vector<uint32_t>& addresses)
+{
+    m_localAddresses.clear();
+    m_localAddresses.insert(addresses.begin(), addresses.end());
+}
+
+DatagramClassifier::Type DatagramClassifier::classify(uint32_t sender, const uint8_t* data, size_t size) const
+{
+    if (m_localAddresses.count(sender))
+        return Type::Own;
+
+    if ((size == 600) || (size == 608))
+        return Type::EnergyMeter;
+
+    if ((size >= sizeof(DISCOVERY_RESPONSE)) && (memcmp(data, DISCOVERY_RESPONSE, sizeof(DISCOVERY_RESPONSE)) == 0))
+        return Type::DiscoveryResponse;
+
+    if (sender == LOCALHOST)
+        return Type::Localhost;
+
+    return Type::Device;
+}
@@ -0,0 +1,68 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * Tells apart the datagrams arriving on the Speedwire port. Our own
+ * addresses are kept in a hash set, which is refreshed by the owner when the
+ * interface addresses change, so a datagram is classified without asking
+ * the system for its interfaces.
+ */
+class DatagramClassifier
+{
+public:
+    enum class Type
+    {
+        Own,                // Sent by ourselves (e.g. our multicast discovery request)
+        Localhost,          // Sent from 127.0.0.1
+        EnergyMeter,        // Energy Meter (600 bytes) or Sunny Home Manager (608 bytes)
+        DiscoveryResponse,
+        Device              // Anything else, e.g. inverter responses
+    };
+
+    // IPv4 addresses in host byte order
+    void setLocalAddresses(const std::vector<uint32_t>& addresses);
+    size_t localAddressCount() const { return m_localAddresses.size(); }
+
+    Type classify(uint32_t sender, const uint8_t* data, size_t size) const;
+
+private:
+    std::unordered_set<uint32_t> m_localAddresses;
+};
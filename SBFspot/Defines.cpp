@@ -42,7 +42,7 @@ int quiet = 0;
 
 char DateTimeFormat[32];
 char DateFormat[32];
-bool hasBatteryDevice = false;
+std::atomic<bool> hasBatteryDevice(false);
 CONNECTIONTYPE ConnType = CT_NONE;
 
 int MAX_CommBuf = 0;
@@ -38,6 +38,8 @@ DISCLAIMER:
 
 #include "Types.h"
 
+#include <atomic>
+
 // Constants
 #define COMMBUFSIZE 2048 // Size of Communications Buffer (Bluetooth/Ethernet)
 #define ETH_L2SIGNATURE 0x65601000
@@ -54,6 +56,7 @@ static const uint16_t anySUSyID = 0xFFFF;
 static const uint32_t anySerial = 0xFFFFFFFF;
 static const uint16_t AppSUSyID = 125;
 static const char IP_Broadcast[] = "239.12.255.254";
+static const int SESSION_RENEWAL = 600;     // Kept sessions are renewed before the logon timeout of 900 seconds
 
 // Global vars
 extern int debug;
@@ -62,7 +65,7 @@ extern int quiet;
 
 extern char DateTimeFormat[32];
 extern char DateFormat[32];
-extern bool hasBatteryDevice;
+extern std::atomic<bool> hasBatteryDevice;   // Set by the workers of InverterPool
 
 // TODO: remove global ConnType
 extern CONNECTIONTYPE ConnType;
@@ -64,9 +64,16 @@ DISCLAIMER:
 #include <string.h>
 #endif	// #if defined (linux) || defined (__APPLE__)
 
+#if defined (linux)
+#include <sys/epoll.h>
+#endif
+
 #include <stdio.h>
 #include <ctype.h>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <thread>
 
 #include "Config.h"
 #include "Defines.h"
@@ -74,9 +81,20 @@ DISCLAIMER:
 #include "endianness.h"
 #include "misc.h"
 
-struct sockaddr_in addr_in, addr_out;
+Ethernet::Ethernet() :
+    m_correlation(16, COMMBUFSIZE)
+#ifdef USE_IO_URING
+    , m_uring(m_stats)
+#endif
+{
+}
+
+Ethernet::~Ethernet()
+{
+    ethClose();
+}
 
-int Ethernet::ethConnect(short port)
+int Ethernet::ethConnect(short port, bool sharedPort)
 {
     int ret = 0;
 
@@ -90,88 +108,212 @@ int Ethernet::ethConnect(short port)
         return -1;
     }
 #endif
-    // create socket for UDP
-    if ((sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP))==-1)
+    // Replaying a trace, nothing to connect to
+    if (m_replay.isOpen())
+        return 0;
+
+    // Two sockets on the same port: the unicast socket carries the requests and
+    // responses of the inverters, the multicast socket joins the Speedwire group,
+    // where energy meters and Home Managers broadcast every second. Keeping them
+    // apart saves the inverter reads from wading through meter datagrams.
+    // Windows can't bind to a group address, there the unicast socket joins the group.
+    // Without sharedPort the unicast socket is bound to a port of its own and no
+    // group is joined, so several instances can talk to their inverters at once.
+    if ((m_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) == -1)
     {
         printf ("Socket error : %s\n", strerror(errno));
         return -1;
     }
 
+    // Allow other sockets on the same port, e.g. a simulator bound to a loopback address
+    int reuse = 1;
+    setsockopt(m_sock, SOL_SOCKET, SO_REUSEADDR, (const char *)&reuse, sizeof(reuse));
+
+#if defined (linux)
+    // Only deliver multicast datagrams of groups joined by the socket itself.
+    // By default Linux hands them to every socket bound to the port.
+    int mcastAll = 0;
+    setsockopt(m_sock, IPPROTO_IP, IP_MULTICAST_ALL, (const char *)&mcastAll, sizeof(mcastAll));
+#endif
+
     // set up parameters for UDP
-    memset((char *)&addr_out, 0, sizeof(addr_out));
-    addr_out.sin_family = AF_INET;
-    addr_out.sin_port = htons(port);
-    addr_out.sin_addr.s_addr = htonl(INADDR_ANY);
-    ret = bind(sock, (struct sockaddr*) &addr_out, sizeof(addr_out));
+    memset((char *)&m_addrOut, 0, sizeof(m_addrOut));
+    m_addrOut.sin_family = AF_INET;
+    m_addrOut.sin_port = sharedPort ? htons(port) : 0;
+    m_addrOut.sin_addr.s_addr = htonl(INADDR_ANY);
+    ret = bind(m_sock, (struct sockaddr*) &m_addrOut, sizeof(m_addrOut));
+    if (ret < 0)
+    {
+        printf ("bind() error : %s\n", strerror(errno));
+        return -1;
+    }
+
     // here is the destination IP
-    addr_out.sin_addr.s_addr = inet_addr(IP_Broadcast);
+    m_addrOut.sin_addr.s_addr = inet_addr(IP_Broadcast);
+    m_addrOut.sin_port = htons(port);
 
-    // set options to receive broadcasted packets
-    // leave this block and you have normal UDP communication (after the inverter scan)
-    struct ip_mreq mreq;
+    if (sharedPort)
+    {
+#if defined (linux) || defined (__APPLE__)
+        if ((m_mcastSock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) == -1)
+        {
+            printf ("Socket error : %s\n", strerror(errno));
+            return -1;
+        }
 
-    mreq.imr_multiaddr.s_addr = inet_addr(IP_Broadcast);
-    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
-    ret = setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, (const char*)&mreq, sizeof(mreq));
-    unsigned char loop = 0;
-    ret = setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, (const char *)&loop, sizeof(loop));
+        setsockopt(m_mcastSock, SOL_SOCKET, SO_REUSEADDR, (const char *)&reuse, sizeof(reuse));
 
-    if (ret < 0)
+        // Bound to the group address, the socket receives nothing but the group's traffic
+        ret = bind(m_mcastSock, (struct sockaddr*) &m_addrOut, sizeof(m_addrOut));
+        if (ret < 0)
+        {
+            printf ("bind() error : %s\n", strerror(errno));
+            return -1;
+        }
+#else
+        m_mcastSock = m_sock;
+#endif
+
+        // set options to receive broadcasted packets
+        struct ip_mreq mreq;
+
+        mreq.imr_multiaddr.s_addr = inet_addr(IP_Broadcast);
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        ret = setsockopt(m_mcastSock, IPPROTO_IP, IP_ADD_MEMBERSHIP, (const char*)&mreq, sizeof(mreq));
+        if (ret < 0)
+        {
+            printf ("setsockopt IP_ADD_MEMBERSHIP failed\n");
+            return -1;
+        }
+
+        // Don't receive our own discovery request
+        unsigned char loop = 0;
+        setsockopt(m_sock, IPPROTO_IP, IP_MULTICAST_LOOP, (const char *)&loop, sizeof(loop));
+        // end of setting broadcast options
+    }
+
+#if defined (linux)
+    // Register the unicast socket with epoll, so we can wait for responses of many inverters at once
+    if ((m_epollFd = epoll_create1(EPOLL_CLOEXEC)) == -1)
     {
-        printf ("setsockopt IP_ADD_MEMBERSHIP failed\n");
+        printf ("epoll_create1() error : %s\n", strerror(errno));
         return -1;
     }
-    // end of setting broadcast options
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = m_sock;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_sock, &ev) == -1)
+    {
+        printf ("epoll_ctl() error : %s\n", strerror(errno));
+        return -1;
+    }
+#endif
+
+#ifdef USE_IO_URING
+    // Keep receive buffers posted on the unicast socket. Without io_uring
+    // (old kernel, disabled by sysctl) the epoll path is used.
+    if (!m_uring.open(m_sock, COMMBUFSIZE))
+        printf ("io_uring setup failed : %s, using epoll\n", strerror(errno));
+#endif
 
     return 0; //OK
 }
 
 ByteBuffer Ethernet::ethRead()
 {
-    ByteBuffer buf(2048);
+    ByteBuffer buf(COMMBUFSIZE);
 
+    // Discovery responses may arrive on both sockets
+    int bytes_read = readDatagram(buf.data(), buf.size(), 5000, true);
+
+    buf.resize(bytes_read > 0 ? bytes_read : 0);
+    return buf;
+}
+
+int Ethernet::readDatagram(uint8_t* buf, size_t size, int timeoutMs, bool multicast)
+{
     int bytes_read;
-    short timeout = 5;
     int8_t emCount = 5;
-    socklen_t addr_in_len = sizeof(addr_in);
+    socklen_t addr_in_len = sizeof(m_addrIn);
 
     fd_set readfds;
 
     do
     {
-        struct timeval tv;
-        tv.tv_sec = timeout;     //set timeout of reading
-        tv.tv_usec = 0;
-
-        FD_ZERO(&readfds);
-        FD_SET(sock, &readfds);
+        if (m_replay.isOpen())
+        {
+            if (!waitReadable(timeoutMs))
+            {
+                if (DEBUG_HIGHEST) puts("Timeout reading trace");
+                return 0;
+            }
 
-        int rc = select(sock+1, &readfds, NULL, NULL, &tv);
-        if (DEBUG_HIGHEST) printf("select() returned %d\n", rc);
-        if (rc == -1)
+            m_stats.recvCalls++;
+            bytes_read = replayDatagram(buf, size, m_addrIn.sin_addr.s_addr);
+            m_stats.datagramsReceived++;
+        }
+#ifdef USE_IO_URING
+        else if (m_uring.isOpen())
         {
-            printf ("select() error : %s\n", strerror(errno));
+            bytes_read = uringDatagram(buf, size, timeoutMs, multicast);
+            if (bytes_read == 0)
+            {
+                if (DEBUG_HIGHEST) puts("Timeout reading socket");
+                return 0;
+            }
         }
-
-        if (FD_ISSET(sock, &readfds))
-            bytes_read = recvfrom(sock, buf.data(), buf.size(), 0, (struct sockaddr *)&addr_in, &addr_in_len);
+#endif
         else
         {
-            if (DEBUG_HIGHEST) puts("Timeout reading socket");
-            return {};
+            struct timeval tv;
+            tv.tv_sec = timeoutMs / 1000;     //set timeout of reading
+            tv.tv_usec = (timeoutMs % 1000) * 1000;
+
+            // Inverter responses only come in on the unicast socket
+            const SOCKET mcastSock = (multicast && (m_mcastSock != m_sock)) ? m_mcastSock : 0;
+
+            FD_ZERO(&readfds);
+            FD_SET(m_sock, &readfds);
+            if (mcastSock != 0)
+                FD_SET(mcastSock, &readfds);
+
+            m_stats.waitCalls++;
+            int rc = select(std::max(m_sock, mcastSock)+1, &readfds, NULL, NULL, &tv);
+            if (DEBUG_HIGHEST) printf("select() returned %d\n", rc);
+            if (rc == -1)
+            {
+                printf ("select() error : %s\n", strerror(errno));
+            }
+
+            const SOCKET readSock = FD_ISSET(m_sock, &readfds) ? m_sock : ((mcastSock != 0) && FD_ISSET(mcastSock, &readfds)) ? mcastSock : 0;
+            if (readSock != 0)
+            {
+                m_stats.recvCalls++;
+                bytes_read = recvfrom(readSock, (char *)buf, size, 0, (struct sockaddr *)&m_addrIn, &addr_in_len);
+                m_stats.datagramsReceived++;
+                if (bytes_read > 0)
+                    m_recorder.write(TraceRecord::Received, m_addrIn.sin_addr.s_addr, ntohs(m_addrIn.sin_port), buf, bytes_read);
+            }
+            else
+            {
+                if (DEBUG_HIGHEST) puts("Timeout reading socket");
+                return 0;
+            }
         }
 
         if ( bytes_read > 0)
         {
-            if (bytes_read > MAX_CommBuf)
+            if (bytes_read > m_maxDatagram)
             {
-                MAX_CommBuf = bytes_read;
+                m_maxDatagram = bytes_read;
                 if (DEBUG_NORMAL)
-                    printf("MAX_CommBuf is now %d bytes\n", MAX_CommBuf);
+                    printf("MAX_CommBuf is now %d bytes\n", m_maxDatagram);
             }
             if (DEBUG_NORMAL)
             {
-                printf("Received %d bytes from IP [%s]\n", bytes_read, inet_ntoa(addr_in.sin_addr));
+                printf("Received %d bytes from IP [%s]\n", bytes_read, inet_ntoa(m_addrIn.sin_addr));
                 if (bytes_read == 600 || bytes_read == 608 || bytes_read == 0)
                     printf(" ==> packet ignored\n");
             }
@@ -184,18 +326,23 @@ ByteBuffer Ethernet::ethRead()
     if (bytes_read == 600 || bytes_read == 608)
         bytes_read = 0;
 
-    buf.resize(bytes_read);
-    return buf;
+    return bytes_read;
 }
 
 int Ethernet::ethSend(const ByteBuffer& buffer, const std::string& toIP)
 {
     if (DEBUG_NORMAL) HexDump(buffer, 10);
 
-    addr_out.sin_addr.s_addr = inet_addr(toIP.c_str());
-    size_t bytes_sent = sendto(sock, (const char*)buffer.data(), buffer.size(), 0, (struct sockaddr *)&addr_out, sizeof(addr_out));
+    m_addrOut.sin_addr.s_addr = inet_addr(toIP.c_str());
+    m_stats.sendCalls++;
+    m_stats.datagramsSent++;
+    m_recorder.write(TraceRecord::Sent, m_addrOut.sin_addr.s_addr, ntohs(m_addrOut.sin_port), buffer.data(), buffer.size());
+    if (m_replay.isOpen())
+        return buffer.size();
 
-    if (DEBUG_NORMAL) std::cout << bytes_sent << " Bytes sent to IP [" << inet_ntoa(addr_out.sin_addr) << "]" << std::endl;
+    size_t bytes_sent = sendto(m_sock, (const char*)buffer.data(), buffer.size(), 0, (struct sockaddr *)&m_addrOut, sizeof(m_addrOut));
+
+    if (DEBUG_NORMAL) std::cout << bytes_sent << " Bytes sent to IP [" << inet_ntoa(m_addrOut.sin_addr) << "]" << std::endl;
 
     return bytes_sent;
 }
@@ -203,10 +350,11 @@ int Ethernet::ethSend(const ByteBuffer& buffer, const std::string& toIP)
 #ifdef WIN32
 int Ethernet::ethClose()
 {
-    if (sock != 0)
+    m_mcastSock = 0;    // Same as m_sock
+    if (m_sock != 0)
     {
-        closesocket(sock);
-        sock = 0;
+        closesocket(m_sock);
+        m_sock = 0;
     }
 
     return 0;
@@ -217,69 +365,662 @@ int Ethernet::ethClose()
 #if defined (linux) || defined (__APPLE__)
 int Ethernet::ethClose()
 {
-    if (sock != 0)
+#ifdef USE_IO_URING
+    // Cancel the posted receives before the socket goes away
+    m_uring.close();
+#endif
+    if (m_epollFd != -1)
     {
-        close(sock);
-        sock = 0;
+        close(m_epollFd);
+        m_epollFd = -1;
+    }
+    if (m_mcastSock != 0)
+    {
+        close(m_mcastSock);
+        m_mcastSock = 0;
+    }
+    if (m_sock != 0)
+    {
+        close(m_sock);
+        m_sock = 0;
     }
     return 0;
 }
 #endif
 
+// Serial of the sender and packet ID of a raw Speedwire datagram
+static bool getPacketKey(const uint8_t* data, int size, uint32_t& serial, uint16_t& packetId)
+{
+    // Header of the response: dummy byte + L2 header
+    if (size < (int)(sizeof(ethPacketHeaderL1) + sizeof(ethPacket) - 1))
+        return false;
+
+    const ethPacket *pckt = (const ethPacket *)(data + sizeof(ethPacketHeaderL1) - 1);
+    if (btohl(pckt->pcktHdrL2.MagicNumber) != ETH_L2SIGNATURE)
+        return false;
+
+    serial = btohl(pckt->Source.serial);
+    packetId = btohs(pckt->PacketID) & 0x7FFF;
+    return true;
+}
+
 E_SBFSPOT Ethernet::ethGetPacket(Buffer& out)
+{
+    PacketView packet;
+    E_SBFSPOT rc = ethGetPacket(packet);
+
+    if (rc == E_OK)
+    {
+        out.clear();
+        out.data().assign(packet.data(), packet.data() + packet.size());
+    }
+
+    return rc;
+}
+
+E_SBFSPOT Ethernet::ethGetPacket(PacketView& out)
 {
     if (DEBUG_NORMAL) printf("ethGetPacket()\n");
     E_SBFSPOT rc = E_OK;
 
+    // Previously received packets are released
+    m_rxPinned = 0;
+    uint8_t *slot = rxSlot(0);
+
     do
     {
-        auto buffer = ethRead();
-        ethPacketHeaderL1L2 *pkHdr = (ethPacketHeaderL1L2 *)buffer.data();
+        int bytes_read = readDatagram(slot, COMMBUFSIZE, 5000);
+        rc = decodePacket(slot, bytes_read > 0 ? bytes_read : 0, out);
+    } while (rc == E_RETRY);
+
+    if (rc == E_OK)
+        m_rxPinned = 1;
+
+    return rc;
+}
+
+E_SBFSPOT Ethernet::ethGetPacket(PacketView& out, uint32_t serial, uint16_t packetId)
+{
+    if (DEBUG_NORMAL) printf("ethGetPacket(%u, %d)\n", serial, packetId);
+
+    // Previously received packets are released
+    m_rxPinned = 0;
+    uint8_t *slot = rxSlot(0);
+
+    // The response may have arrived while we were waiting for another one
+    size_t size = m_correlation.takeStashed(serial, packetId, 0, slot, COMMBUFSIZE);
 
-        if (buffer.size() <= 0)
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (size == 0)
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0)
+            break;
+
+        int bytes_read = readDatagram(slot, COMMBUFSIZE, (int)remaining);
+        if (bytes_read <= 0)
+            return E_NODATA;
+
+        uint32_t rcvSerial;
+        uint16_t rcvPcktID;
+        if (!getPacketKey(slot, bytes_read, rcvSerial, rcvPcktID))
+            continue;
+
+        if ((rcvSerial == serial) && (rcvPcktID == packetId))
+            size = bytes_read;
+        else
         {
-            if (DEBUG_NORMAL) printf("No data!\n");
-            rc = E_NODATA;
+            if (DEBUG_HIGHEST) printf("Keeping packet ID %d from SN %u for later\n", rcvPcktID, rcvSerial);
+            m_correlation.stash(rcvSerial, rcvPcktID, m_addrIn.sin_addr.s_addr, slot, bytes_read);
+        }
+    }
+
+    if (size == 0)
+        return E_NODATA;
+
+    E_SBFSPOT rc = decodePacket(slot, size, out);
+    if (rc == E_OK)
+        m_rxPinned = 1;
+
+    return rc;
+}
+
+E_SBFSPOT Ethernet::ethExchange(std::vector<EthRequest>& requests, int timeoutMs)
+{
+    if (DEBUG_NORMAL) printf("ethExchange(%u requests)\n", (unsigned int)requests.size());
+
+    // Previously received packets are released
+    m_rxPinned = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::milliseconds(timeoutMs);
+
+    // Register the requests. A response may already be waiting in the stash,
+    // those requests are not sent again.
+    m_correlation.clear();
+    m_txIndex.clear();
+    m_txState.resize(requests.size());
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        auto& request = requests[i];
+        auto& state = m_txState[i];
+        const uint32_t address = inet_addr(request.ip.c_str());
+        uint8_t *slot = rxSlot(m_rxPinned);
+        size_t size = m_correlation.takeStashed(request.serial, request.packetId, address, slot, COMMBUFSIZE);
+
+        state.active = false;
+        if ((size > 0) && (decodePacket(slot, size, request.response) == E_OK))
+        {
+            if (DEBUG_NORMAL) printf("Response to packet ID %d taken from stash\n", request.packetId);
+            request.rc = E_OK;
+            ++m_rxPinned;
         }
         else
         {
-            unsigned short pkLen = (pkHdr->pcktHdrL1.hiPacketLen << 8) + pkHdr->pcktHdrL1.loPacketLen;
+            request.rc = E_NODATA;
+            m_correlation.expect(request.serial, request.packetId, address, i);
+
+            // An inverter that did not answer last time (e.g. asleep) gets no retransmissions
+            state.rtt = &m_rtt[address];
+            state.attempts = 1;
+            state.maxAttempts = (state.rtt->failures() > 0) ? 1 : 1 + m_maxRetransmits;
+            state.sentAt = start;
+            state.deadline = start + state.rtt->rto();
+            state.active = true;
+            m_txIndex.push_back(i);
+        }
+    }
+
+    // Fire all requests back to back
+    size_t pending = sendRequests(requests);
+
+    // Route each incoming datagram to its request by serial and packet ID.
+    // Requests that are not answered within the RTO of their inverter are sent again.
+    while (pending > 0)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+            break;
+
+        auto wakeup = deadline;
+        for (size_t i = 0; i < requests.size(); i++)
+        {
+            if (m_txState[i].active && (m_txState[i].deadline < wakeup))
+                wakeup = m_txState[i].deadline;
+        }
 
-            //More data after header?
-            if (pkLen > 0)
+        // Round up, a timeout of 0 ms would spin
+        auto waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(wakeup - now + std::chrono::microseconds(999)).count();
+        if ((waitMs > 0) && waitReadable((int)waitMs))
+        {
+            // Drain everything that is queued on the socket
+            int count;
+            while ((pending > 0) && ((count = receiveBatch()) > 0))
             {
-                if (DEBUG_HIGH) HexDump(buffer, 10);
-                if (btohl(pkHdr->pcktHdrL2.MagicNumber) == ETH_L2SIGNATURE)
+                now = std::chrono::steady_clock::now();
+                const size_t base = m_rxPinned;
+                for (int i = 0; i < count; i++)
                 {
-                    out.clear();
-                    // Copy CommBuf to packetbuffer
-                    // Dummy byte to align with BTH (7E)
-                    out.data().push_back(0);
-                    // We need last 6 bytes of ethPacketHeader too
-                    out.data().insert(out.data().end(), buffer.begin() + sizeof(ethPacketHeaderL1), buffer.end());
-                    // Point packetposition at last byte in our buffer
-                    // This is different from BTH
-                    packetposition = buffer.size() - sizeof(ethPacketHeaderL1);
-
-                    if (DEBUG_HIGH)
+                    int index = dispatch(m_rxSlots[base + i].get(), m_rxSize[i], m_rxFrom[i], requests);
+                    if (index < 0)
+                        continue;
+
+                    // Keep the slot, the response points into it
+                    std::swap(m_rxSlots[m_rxPinned], m_rxSlots[base + i]);
+                    ++m_rxPinned;
+
+                    auto& state = m_txState[index];
+                    if (state.active)
                     {
-                        printf("<<<====== Content of pcktBuf =======>>>\n");
-                        HexDump(out.data(), 10);
-                        printf("<<<=================================>>>\n");
+                        // Karn: the round trip time of a retransmitted request is ambiguous
+                        if (state.attempts == 1)
+                            state.rtt->addSample(std::chrono::duration_cast<RttEstimator::Duration>(now - state.sentAt));
+                        else
+                            state.rtt->addResponse();
+                        state.active = false;
+                        --pending;
                     }
-
-                    rc = E_OK;
-                }
-                else
-                {
-                    if (DEBUG_NORMAL) printf("L2 header not found.\n");
-                    rc = E_RETRY;
                 }
             }
+        }
+
+        // Retransmit the expired requests or give up on them
+        now = std::chrono::steady_clock::now();
+        m_txIndex.clear();
+        for (size_t i = 0; i < requests.size(); i++)
+        {
+            auto& state = m_txState[i];
+            if (!state.active || (state.deadline > now))
+                continue;
+
+            if (state.attempts < state.maxAttempts)
+            {
+                state.deadline = now + state.rtt->backoff(state.attempts);
+                state.attempts++;
+                m_txIndex.push_back(i);
+            }
             else
-                rc = E_NODATA;
+            {
+                if (DEBUG_NORMAL) printf("No response from IP [%s] to packet ID %d\n", requests[i].ip.c_str(), requests[i].packetId);
+                state.rtt->addTimeout();
+                state.active = false;
+                --pending;
+                m_stats.timeouts++;
+            }
         }
-    } while (rc == E_RETRY);
 
-    return rc;
+        if (!m_txIndex.empty())
+        {
+            if (DEBUG_NORMAL) printf("Retransmitting %u request(s)\n", (unsigned int)m_txIndex.size());
+            m_stats.retransmits += m_txIndex.size();
+            pending -= m_txIndex.size() - sendRequests(requests);
+        }
+    }
+
+    if (DEBUG_NORMAL && (pending > 0)) printf("ethExchange(): %u request(s) timed out\n", (unsigned int)pending);
+
+    for (size_t i = 0; (pending > 0) && (i < requests.size()); i++)
+    {
+        if (m_txState[i].active)
+        {
+            m_txState[i].rtt->addTimeout();
+            m_txState[i].active = false;
+            m_stats.timeouts++;
+        }
+    }
+
+    for (const auto& request : requests)
+    {
+        if (request.rc != E_OK)
+            return E_NODATA;
+    }
+
+    return E_OK;
+}
+
+size_t Ethernet::sendRequests(std::vector<EthRequest>& requests)
+{
+    size_t sent = 0;
+
+    if (m_replay.isOpen())
+    {
+        // The responses come from the trace
+        m_stats.datagramsSent += m_txIndex.size();
+        return m_txIndex.size();
+    }
+
+#if defined (linux)
+    if (m_batchIO)
+    {
+        m_txTo.resize(m_txIndex.size());
+        m_txIov.resize(m_txIndex.size());
+        m_txMsgs.resize(m_txIndex.size());
+
+        for (size_t i = 0; i < m_txIndex.size(); i++)
+        {
+            const auto& request = requests[m_txIndex[i]];
+            if (DEBUG_NORMAL) HexDump(request.request, 10);
+
+            m_txTo[i] = m_addrOut;
+            m_txTo[i].sin_addr.s_addr = inet_addr(request.ip.c_str());
+            m_txIov[i].iov_base = (void *)request.request.data();
+            m_txIov[i].iov_len = request.request.size();
+            memset(&m_txMsgs[i], 0, sizeof(m_txMsgs[i]));
+            m_txMsgs[i].msg_hdr.msg_name = &m_txTo[i];
+            m_txMsgs[i].msg_hdr.msg_namelen = sizeof(m_txTo[i]);
+            m_txMsgs[i].msg_hdr.msg_iov = &m_txIov[i];
+            m_txMsgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+#ifdef USE_IO_URING
+        if (m_uring.isOpen())
+            sent = m_uring.send(m_txMsgs.data(), m_txMsgs.size());
+        else
+#endif
+        // sendmmsg() may send less than requested, continue with the remainder
+        while (sent < m_txMsgs.size())
+        {
+            m_stats.sendCalls++;
+            int rc = sendmmsg(m_sock, &m_txMsgs[sent], m_txMsgs.size() - sent, 0);
+            if (rc <= 0)
+            {
+                printf ("sendmmsg() error : %s\n", strerror(errno));
+                break;
+            }
+            sent += rc;
+        }
+
+        // The datagrams that were not sent have a msg_len of 0
+        m_stats.datagramsSent += sent;
+        for (size_t i = 0; i < m_txIndex.size(); i++)
+        {
+            if (m_txMsgs[i].msg_len == 0)
+            {
+                requests[m_txIndex[i]].rc = E_COMM;
+                m_txState[m_txIndex[i]].active = false;
+            }
+            else if (m_recorder.isOpen())
+                m_recorder.write(TraceRecord::Sent, m_txTo[i].sin_addr.s_addr, ntohs(m_txTo[i].sin_port), (const uint8_t*)m_txIov[i].iov_base, m_txIov[i].iov_len);
+        }
+
+        if (DEBUG_NORMAL) printf("%u of %u datagrams sent\n", (unsigned int)sent, (unsigned int)m_txIndex.size());
+
+        return sent;
+    }
+#endif
+
+    for (size_t index : m_txIndex)
+    {
+        auto& request = requests[index];
+        if (DEBUG_NORMAL) HexDump(request.request, 10);
+
+        m_stats.sendCalls++;
+        m_addrOut.sin_addr.s_addr = inet_addr(request.ip.c_str());
+        int bytes_sent = sendto(m_sock, (const char*)request.request.data(), request.request.size(), 0, (struct sockaddr *)&m_addrOut, sizeof(m_addrOut));
+        if (bytes_sent > 0)
+        {
+            m_stats.datagramsSent++;
+            m_recorder.write(TraceRecord::Sent, m_addrOut.sin_addr.s_addr, ntohs(m_addrOut.sin_port), request.request.data(), request.request.size());
+            ++sent;
+        }
+        else
+        {
+            request.rc = E_COMM;
+            m_txState[index].active = false;
+        }
+    }
+
+    return sent;
+}
+
+uint8_t* Ethernet::rxSlot(size_t index)
+{
+    while (m_rxSlots.size() <= index)
+        m_rxSlots.emplace_back(new uint8_t[COMMBUFSIZE]);
+
+    return m_rxSlots[index].get();
+}
+
+int Ethernet::receiveBatch()
+{
+    // Received datagrams go to the slots behind the pinned ones
+    rxSlot(m_rxPinned + RX_BATCH - 1);
+
+    int count = 0;
+
+    if (m_replay.isOpen())
+    {
+        // Everything of the trace that is due by now
+        m_stats.recvCalls++;
+        int bytes_read;
+        while ((count < RX_BATCH) && ((bytes_read = replayDatagram(m_rxSlots[m_rxPinned + count].get(), COMMBUFSIZE, m_rxFrom[count])) > 0))
+            m_rxSize[count++] = bytes_read;
+
+        m_stats.datagramsReceived += count;
+        return count;
+    }
+
+#ifdef USE_IO_URING
+    if (m_uring.isOpen())
+    {
+        // The datagrams are in the buffers of the ring already, no system call needed
+        struct sockaddr_in from;
+        int bytes_read;
+        while ((count < RX_BATCH) && ((bytes_read = m_uring.take(m_rxSlots[m_rxPinned + count], from)) > 0))
+        {
+            m_rxSize[count] = bytes_read;
+            m_rxFrom[count] = from.sin_addr.s_addr;
+            m_recorder.write(TraceRecord::Received, m_rxFrom[count], ntohs(from.sin_port), m_rxSlots[m_rxPinned + count].get(), bytes_read);
+            ++count;
+        }
+
+        m_stats.datagramsReceived += count;
+        return count;
+    }
+#endif
+
+#if defined (linux)
+    if (m_batchIO)
+    {
+        struct sockaddr_in from[RX_BATCH];
+        struct iovec iov[RX_BATCH];
+        struct mmsghdr msgs[RX_BATCH];
+
+        memset(msgs, 0, sizeof(msgs));
+        for (int i = 0; i < RX_BATCH; i++)
+        {
+            iov[i].iov_base = m_rxSlots[m_rxPinned + i].get();
+            iov[i].iov_len = COMMBUFSIZE;
+            msgs[i].msg_hdr.msg_name = &from[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        m_stats.recvCalls++;
+        count = recvmmsg(m_sock, msgs, RX_BATCH, MSG_DONTWAIT, NULL);
+        if (count <= 0)
+            return 0;
+
+        for (int i = 0; i < count; i++)
+        {
+            m_rxSize[i] = msgs[i].msg_len;
+            m_rxFrom[i] = from[i].sin_addr.s_addr;
+            m_recorder.write(TraceRecord::Received, m_rxFrom[i], ntohs(from[i].sin_port), m_rxSlots[m_rxPinned + i].get(), m_rxSize[i]);
+        }
+    }
+    else
+#endif
+    {
+        struct sockaddr_in from;
+        socklen_t fromLen = sizeof(from);
+
+        m_stats.recvCalls++;
+        int bytes_read = recvfrom(m_sock, (char *)m_rxSlots[m_rxPinned].get(), COMMBUFSIZE, MSG_DONTWAIT, (struct sockaddr *)&from, &fromLen);
+        if (bytes_read <= 0)
+            return 0;
+
+        m_rxSize[0] = bytes_read;
+        m_rxFrom[0] = from.sin_addr.s_addr;
+        m_recorder.write(TraceRecord::Received, m_rxFrom[0], ntohs(from.sin_port), m_rxSlots[m_rxPinned].get(), bytes_read);
+        count = 1;
+    }
+
+    m_stats.datagramsReceived += count;
+    return count;
+}
+
+int Ethernet::dispatch(uint8_t* data, int size, uint32_t fromAddr, std::vector<EthRequest>& requests)
+{
+    struct in_addr from;
+    from.s_addr = fromAddr;
+
+    if (DEBUG_NORMAL) printf("Received %d bytes from IP [%s]\n", size, inet_ntoa(from));
+
+    // Energy Meter (600 bytes) or Sunny Home Manager (608 bytes)
+    if (size == 600 || size == 608)
+        return -1;
+
+    uint32_t rcvSerial;
+    uint16_t rcvPcktID;
+    if (!getPacketKey(data, size, rcvSerial, rcvPcktID))
+        return -1;
+
+    int index = m_correlation.complete(rcvSerial, rcvPcktID, fromAddr);
+    if (index < 0)
+    {
+        // Late or early response, somebody may ask for it later
+        if (DEBUG_HIGHEST) printf("No pending request for packet ID %d from SN %u, keeping it\n", rcvPcktID, rcvSerial);
+        m_correlation.stash(rcvSerial, rcvPcktID, fromAddr, data, size);
+        return -1;
+    }
+
+    auto& request = requests[index];
+    request.rc = decodePacket(data, size, request.response);
+    if (request.rc != E_OK)
+        request.rc = E_COMM;
+
+    return index;
+}
+
+int Ethernet::replayDatagram(uint8_t* buf, size_t size, uint32_t& fromAddr)
+{
+    const TraceRecord* record = m_replay.peek(TraceRecord::Received);
+    if (!record || (m_replay.due(*record) > std::chrono::steady_clock::now()))
+        return 0;
+
+    size = std::min(size, record->data.size());
+    memcpy(buf, record->data.data(), size);
+    fromAddr = record->address;
+    m_replay.pop();
+
+    return (int)size;
+}
+
+#ifdef USE_IO_URING
+int Ethernet::uringDatagram(uint8_t* buf, size_t size, int timeoutMs, bool multicast)
+{
+    const SOCKET mcastSock = (multicast && (m_mcastSock != m_sock)) ? m_mcastSock : 0;
+
+    if (mcastSock == 0)
+    {
+        if (!m_uring.wait(timeoutMs))
+            return 0;
+    }
+    else if (!m_uring.wait(0))
+    {
+        // Wait for the multicast socket and the ring, which is readable once a completion is queued
+        m_uring.flush();
+
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        FD_SET(m_uring.ringFd(), &readfds);
+        FD_SET(mcastSock, &readfds);
+
+        struct timeval tv;
+        tv.tv_sec = timeoutMs / 1000;
+        tv.tv_usec = (timeoutMs % 1000) * 1000;
+
+        m_stats.waitCalls++;
+        int rc = select(std::max(m_uring.ringFd(), mcastSock)+1, &readfds, NULL, NULL, &tv);
+        if (rc == -1)
+            printf ("select() error : %s\n", strerror(errno));
+        if (rc <= 0)
+            return 0;
+
+        if (FD_ISSET(mcastSock, &readfds))
+        {
+            socklen_t addr_in_len = sizeof(m_addrIn);
+            m_stats.recvCalls++;
+            int bytes_read = recvfrom(mcastSock, (char *)buf, size, 0, (struct sockaddr *)&m_addrIn, &addr_in_len);
+            m_stats.datagramsReceived++;
+            if (bytes_read > 0)
+                m_recorder.write(TraceRecord::Received, m_addrIn.sin_addr.s_addr, ntohs(m_addrIn.sin_port), buf, bytes_read);
+            return bytes_read;
+        }
+    }
+
+    int bytes_read = m_uring.take(buf, size, m_addrIn);
+    if (bytes_read > 0)
+    {
+        m_stats.datagramsReceived++;
+        m_recorder.write(TraceRecord::Received, m_addrIn.sin_addr.s_addr, ntohs(m_addrIn.sin_port), buf, bytes_read);
+    }
+
+    return bytes_read;
+}
+#endif
+
+bool Ethernet::waitReadable(int timeoutMs)
+{
+    if (m_replay.isOpen())
+    {
+        // Sleep until the next datagram of the trace is due
+        m_stats.waitCalls++;
+        auto wakeup = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        const TraceRecord* record = m_replay.peek(TraceRecord::Received);
+        const bool due = record && (m_replay.due(*record) <= wakeup);
+        if (due)
+            wakeup = m_replay.due(*record);
+
+        std::this_thread::sleep_until(wakeup);
+        return due;
+    }
+
+#ifdef USE_IO_URING
+    if (m_uring.isOpen())
+        return m_uring.wait(timeoutMs);
+#endif
+
+#if defined (linux)
+    if (m_epollFd != -1)
+    {
+        struct epoll_event ev;
+        m_stats.waitCalls++;
+        int rc = epoll_wait(m_epollFd, &ev, 1, timeoutMs);
+        if (rc == -1)
+            printf ("epoll_wait() error : %s\n", strerror(errno));
+
+        return rc > 0;
+    }
+#endif
+
+    fd_set readfds;
+    FD_ZERO(&readfds);
+    FD_SET(m_sock, &readfds);
+
+    struct timeval tv;
+    tv.tv_sec = timeoutMs / 1000;
+    tv.tv_usec = (timeoutMs % 1000) * 1000;
+
+    m_stats.waitCalls++;
+    int rc = select(m_sock+1, &readfds, NULL, NULL, &tv);
+    if (rc == -1)
+        printf ("select() error : %s\n", strerror(errno));
+
+    return (rc > 0) && FD_ISSET(m_sock, &readfds);
+}
+
+const RttEstimator* Ethernet::rttEstimator(const std::string& ip) const
+{
+    auto it = m_rtt.find(inet_addr(ip.c_str()));
+    return (it != m_rtt.end()) ? &it->second : nullptr;
+}
+
+E_SBFSPOT Ethernet::decodePacket(uint8_t* data, size_t size, PacketView& out)
+{
+    const ethPacketHeaderL1L2 *pkHdr = (const ethPacketHeaderL1L2 *)data;
+
+    if (size < sizeof(ethPacketHeaderL1L2))
+    {
+        if (DEBUG_NORMAL) printf("No data!\n");
+        return E_NODATA;
+    }
+
+    unsigned short pkLen = (pkHdr->pcktHdrL1.hiPacketLen << 8) + pkHdr->pcktHdrL1.loPacketLen;
+
+    //More data after header?
+    if (pkLen == 0)
+        return E_NODATA;
+
+    if (DEBUG_HIGH) HexDump(ByteBuffer(data, data + size), 10);
+    if (btohl(pkHdr->pcktHdrL2.MagicNumber) != ETH_L2SIGNATURE)
+    {
+        if (DEBUG_NORMAL) printf("L2 header not found.\n");
+        return E_RETRY;
+    }
+
+    // The packet is decoded in place: the last byte of ethPacketHeaderL1 becomes
+    // the dummy byte to align with BTH (7E), followed by the last 6 bytes of ethPacketHeader
+    data[sizeof(ethPacketHeaderL1) - 1] = 0;
+    out = PacketView(data + sizeof(ethPacketHeaderL1) - 1, size - sizeof(ethPacketHeaderL1) + 1);
+
+    if (DEBUG_HIGH)
+    {
+        printf("<<<====== Content of pcktBuf =======>>>\n");
+        HexDump(ByteBuffer(out.data(), out.data() + out.size()), 10);
+        printf("<<<=================================>>>\n");
+    }
+
+    return E_OK;
 }
@@ -34,16 +34,191 @@ DISCLAIMER:
 
 #pragma once
 
+#include "osselect.h"
+
+#include "CorrelationTable.h"
+#include "RttEstimator.h"
+#include "SBFNet.h"
+#include "SpeedwireTrace.h"
 #include "Types.h"
 
-class Buffer;
+#ifdef USE_IO_URING
+#include "UringTransport.h"
+#endif
+
+#include <chrono>
+#include <map>
+#include <memory>
+
+#if defined (linux)
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+/*
+ * A single request/response exchange with an inverter. The response is
+ * matched by the serial of the responding inverter and the packet ID it
+ * echoes back. Requests to any serial (init) are matched by IP address.
+ */
+struct EthRequest
+{
+    std::string ip;         // IP address of the inverter
+    uint32_t serial = CorrelationTable::AnySerial;  // Serial of the inverter
+    uint16_t packetId = 0;  // Packet ID of the request (without the 0x8000 flag)
+    ByteBuffer request;     // Encoded request frame
+    PacketView response;    // Response packet (only valid if rc == E_OK, see ethExchange())
+    E_SBFSPOT rc = E_NODATA;
+};
+
+/*
+ * Socket level counters, used to measure the number of system calls
+ * needed per poll cycle.
+ */
+struct EthStats
+{
+    uint64_t sendCalls = 0;         // sendto() / sendmmsg() calls
+    uint64_t recvCalls = 0;         // recvfrom() / recvmmsg() calls
+    uint64_t waitCalls = 0;         // select() / epoll_wait() calls
+    uint64_t datagramsSent = 0;
+    uint64_t datagramsReceived = 0;
+    uint64_t retransmits = 0;       // Requests sent again after their RTO expired
+    uint64_t timeouts = 0;          // Requests given up on
+
+    uint64_t syscalls() const { return sendCalls + recvCalls + waitCalls; }
+};
 
 class Ethernet {
 public:
-    int ethConnect(short port);
+    Ethernet();
+    ~Ethernet();
+
+    /*
+     * Binds the sockets to the Speedwire port and joins the multicast group.
+     * Without sharedPort the unicast socket gets a port of its own and no group
+     * is joined (no discovery), so several instances can run side by side.
+     */
+    int ethConnect(short port, bool sharedPort = true);
     int ethClose(void);
     int ethSend(const ByteBuffer& buffer, const std::string& toIP);
     ByteBuffer ethRead();
 
     E_SBFSPOT ethGetPacket(Buffer& out);
+
+    /*
+     * Receives the next packet into a slot of the receive pool. The view stays
+     * valid until the next call of ethGetPacket() or ethExchange().
+     */
+    E_SBFSPOT ethGetPacket(PacketView& out);
+
+    /*
+     * Same as above, but waits for the response with the given serial and
+     * packet ID. Other responses are kept for a later ethExchange() or
+     * ethGetPacket() instead of being dropped.
+     */
+    E_SBFSPOT ethGetPacket(PacketView& out, uint32_t serial, uint16_t packetId);
+
+    /*
+     * Sends all requests at once and waits for the responses concurrently.
+     * Returns E_OK when every request got its response, E_NODATA when at least
+     * one of them timed out. The state of each request is kept in its rc member.
+     * The responses point into the receive pool and stay valid until the next
+     * call of ethGetPacket() or ethExchange().
+     *
+     * A request that is not answered within the RTO of its inverter is sent
+     * again with exponential backoff, up to setMaxRetransmits() times. Inverters
+     * that did not answer last time get no retransmissions. timeoutMs limits
+     * the whole exchange.
+     */
+    E_SBFSPOT ethExchange(std::vector<EthRequest>& requests, int timeoutMs = 5000);
+
+    /*
+     * When enabled (default), ethExchange() sends all requests with sendmmsg()
+     * and drains queued responses with recvmmsg(). Only available on Linux,
+     * other platforms always use one sendto()/recvfrom() per datagram.
+     */
+    void setBatchIO(bool enable) { m_batchIO = enable; }
+
+    void setMaxRetransmits(int count) { m_maxRetransmits = count; }
+
+    /*
+     * Round trip estimate of the inverter at the given IP address,
+     * nullptr if it was never asked anything by ethExchange().
+     */
+    const RttEstimator* rttEstimator(const std::string& ip) const;
+
+    /*
+     * Writes every datagram sent and received to a trace file.
+     */
+    bool startRecording(const std::string& path) { return m_recorder.open(path); }
+
+    /*
+     * Replaces the network by a recorded trace: sent datagrams go nowhere and
+     * the received ones are read from the trace at the given speed
+     * (see TraceReader::open()). Must be called before ethConnect().
+     */
+    bool startReplay(const std::string& path, double speed) { return m_replay.open(path, speed); }
+
+    const EthStats& stats() const { return m_stats; }
+    void resetStats() { m_stats = EthStats(); }
+
+private:
+    size_t sendRequests(std::vector<EthRequest>& requests);   // Sends the requests listed in m_txIndex
+    bool waitReadable(int timeoutMs);
+    int readDatagram(uint8_t* buf, size_t size, int timeoutMs, bool multicast = false);
+    int receiveBatch();
+    int replayDatagram(uint8_t* buf, size_t size, uint32_t& fromAddr);
+#ifdef USE_IO_URING
+    int uringDatagram(uint8_t* buf, size_t size, int timeoutMs, bool multicast);
+#endif
+    int dispatch(uint8_t* data, int size, uint32_t fromAddr, std::vector<EthRequest>& requests);
+    E_SBFSPOT decodePacket(uint8_t* data, size_t size, PacketView& out);
+    uint8_t* rxSlot(size_t index);
+
+    SOCKET m_sock = 0;          // Unicast socket, requests and responses of the inverters
+    SOCKET m_mcastSock = 0;     // Joins the Speedwire multicast group
+    struct sockaddr_in m_addrIn = {};   // Source of the last datagram read
+    struct sockaddr_in m_addrOut = {};  // Destination of ethSend()/ethExchange()
+    int m_maxDatagram = 0;
+    int m_epollFd = -1;
+    bool m_batchIO = true;
+    EthStats m_stats;
+    TraceWriter m_recorder;
+    TraceReader m_replay;
+    CorrelationTable m_correlation;
+#ifdef USE_IO_URING
+    UringTransport m_uring;     // Receives on the unicast socket instead of epoll/recvmmsg() once open
+#endif
+
+    // Round trip estimates by inverter address (network byte order)
+    std::map<uint32_t, RttEstimator> m_rtt;
+    int m_maxRetransmits = 2;
+
+    // Retransmission state of the requests of ethExchange()
+    struct TxState
+    {
+        std::chrono::steady_clock::time_point sentAt;
+        std::chrono::steady_clock::time_point deadline;
+        RttEstimator* rtt = nullptr;
+        int attempts = 0;
+        int maxAttempts = 0;
+        bool active = false;    // Waiting for the response
+    };
+    std::vector<TxState> m_txState;
+
+    // Receive pool. Slots [0, m_rxPinned) hold packets handed out as PacketView,
+    // the slots behind them are filled by the next recvmmsg() call. The pool only
+    // grows while warming up, so the steady state poll path does not allocate.
+    static const int RX_BATCH = 32;
+    std::vector<std::unique_ptr<uint8_t[]>> m_rxSlots;
+    size_t m_rxPinned = 0;
+    int m_rxSize[RX_BATCH];
+    uint32_t m_rxFrom[RX_BATCH];        // Source address (network byte order)
+
+#if defined (linux)
+    // Scratch space of sendmmsg(), reused by every ethExchange()
+    std::vector<struct sockaddr_in> m_txTo;
+    std::vector<struct iovec> m_txIov;
+    std::vector<struct mmsghdr> m_txMsgs;
+    std::vector<size_t> m_txIndex;
+#endif
 };
@@ -34,54 +34,188 @@ DISCLAIMER:
 
 #include "Ethernet_qt.h"
 
-#include <QNetworkDatagram>
 #include <QNetworkInterface>
+#include <QSocketNotifier>
+#include <QtEndian>
+
+#include <algorithm>
+
+#if defined(linux)
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
 
 // TODO: remove SMA specific types out of here
 #include <Logger.h>
+#include <misc.h>
 #include <sma/SmaManager.h>
 
 Ethernet_qt::Ethernet_qt(sma::SmaManager& processor)
-    : m_processor(processor)
+    : m_processor(processor),
+      m_receiveBuffer(65536)
 {
     m_udpSocket.bind(QHostAddress::AnyIPv4, 9522, QUdpSocket::ShareAddress);
     m_udpSocket.joinMulticastGroup(QHostAddress("239.12.255.254"));
 
     QObject::connect(&m_udpSocket, &QUdpSocket::readyRead, this, &Ethernet_qt::onReadyRead);
+
+    m_replayTimer.setSingleShot(true);
+    QObject::connect(&m_replayTimer, &QTimer::timeout, this, &Ethernet_qt::onReplayTimeout);
+
+    refreshLocalAddresses();
+    QObject::connect(&m_addressTimer, &QTimer::timeout, this, &Ethernet_qt::refreshLocalAddresses);
+    m_addressTimer.start(5*60*1000);
+
+#if defined(linux)
+    // Subscribe to IPv4 address changes
+    m_netlinkFd = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+    struct sockaddr_nl sa = {};
+    sa.nl_family = AF_NETLINK;
+    sa.nl_groups = RTMGRP_IPV4_IFADDR;
+    if ((m_netlinkFd >= 0) && (bind(m_netlinkFd, reinterpret_cast<struct sockaddr*>(&sa), sizeof(sa)) == 0)) {
+        m_netlinkNotifier = new QSocketNotifier(m_netlinkFd, QSocketNotifier::Read, this);
+        QObject::connect(m_netlinkNotifier, &QSocketNotifier::activated, this, &Ethernet_qt::onNetlinkActivated);
+    } else {
+        LOG_S(WARNING) << "Cannot monitor address changes, falling back to polling";
+    }
+#endif
+}
+
+Ethernet_qt::~Ethernet_qt()
+{
+    delete m_netlinkNotifier;
+#if defined(linux)
+    if (m_netlinkFd >= 0) {
+        close(m_netlinkFd);
+    }
+#endif
 }
 
 void Ethernet_qt::send(const ByteBuffer& data, uint32_t address, uint16_t port)
 {
     LOG_S(2) << "Send datagram: " << data;
+    m_recorder.write(TraceRecord::Sent, qToBigEndian(address), port, data.data(), data.size());
+    if (m_replay.isOpen()) return;
+
     m_udpSocket.writeDatagram(reinterpret_cast<const char*>(data.data()), data.size(), QHostAddress(address), port);
 }
 
 void Ethernet_qt::send(const QByteArray& datagram, const std::string& address, uint16_t port)
 {
-    m_udpSocket.writeDatagram(datagram, QHostAddress(QString::fromStdString(address)), port);
+    QHostAddress hostAddress(QString::fromStdString(address));
+    m_recorder.write(TraceRecord::Sent, qToBigEndian(hostAddress.toIPv4Address()), port,
+                     reinterpret_cast<const uint8_t*>(datagram.data()), datagram.size());
+    if (m_replay.isOpen()) return;
+
+    m_udpSocket.writeDatagram(datagram, hostAddress, port);
+}
+
+bool Ethernet_qt::startRecording(const std::string& path)
+{
+    return m_recorder.open(path);
 }
 
-void Ethernet_qt::onReadyRead()
+bool Ethernet_qt::startReplay(const std::string& path, double speed)
+{
+    if (!m_replay.open(path, speed)) {
+        return false;
+    }
+
+    // Only datagrams of the trace from now on
+    m_udpSocket.close();
+    scheduleReplay();
+    return true;
+}
+
+void Ethernet_qt::scheduleReplay()
 {
-    auto addresses = QNetworkInterface::allAddresses();
+    const TraceRecord* record = m_replay.peek(TraceRecord::Received);
+    if (!record) {
+        LOG_S(INFO) << "Replay finished";
+        return;
+    }
+
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(m_replay.due(*record) - std::chrono::steady_clock::now()).count();
+    m_replayTimer.start(std::max<int>(0, ms));
+}
 
+void Ethernet_qt::onReplayTimeout()
+{
+    const auto now = std::chrono::steady_clock::now();
+    const TraceRecord* record;
+    while ((record = m_replay.peek(TraceRecord::Received)) && (m_replay.due(*record) <= now)) {
+        // The record is only valid until pop()
+        onDatagram(qFromBigEndian(record->address), record->data.data(), record->data.size());
+        m_replay.pop();
+    }
+
+    scheduleReplay();
+}
+
+void Ethernet_qt::refreshLocalAddresses()
+{
+    std::vector<uint32_t> addresses;
+    for (const auto& address : QNetworkInterface::allAddresses()) {
+        bool isIPv4 = false;
+        auto ip = address.toIPv4Address(&isIPv4);
+        if (isIPv4) {
+            addresses.push_back(ip);
+        }
+    }
+
+    m_classifier.setLocalAddresses(addresses);
+    LOG_F(2, "Local addresses refreshed: %zu", m_classifier.localAddressCount());
+}
+
+void Ethernet_qt::onNetlinkActivated()
+{
+#if defined(linux)
+    // We only care that something changed, not what
+    char buffer[4096];
+    while (recv(m_netlinkFd, buffer, sizeof(buffer), 0) > 0) {
+    }
+#endif
+    refreshLocalAddresses();
+}
+
+void Ethernet_qt::onReadyRead()
+{
     while (m_udpSocket.hasPendingDatagrams()) {
-        QNetworkDatagram datagram = m_udpSocket.receiveDatagram();
-        if (addresses.contains(datagram.senderAddress())) {
-            LOG_F(2, "Discard datagram from localhost");
-        } else if (datagram.data().size() == 600 || datagram.data().size() == 608) {
-            //LOG_F(1, "Received energy meter datagram. size: %i", datagram.data().size());
-            m_processor.onEnergyMeterDatagram(datagram);
-        } else if (datagram.data().startsWith(QByteArray::fromHex("534d4100000402A000000001000200000001"))) {
-            LOG_F(2, "Received discovery response datagram. size: %i", datagram.data().size());
-            m_processor.onDiscoveryResponseDatagram(datagram);
-        } else if (datagram.senderAddress() == QHostAddress::LocalHost) {
-            LOG_F(2, "Discard datagram from localhost");
-        } else {
-            LOG_F(2, "Received datagram from: %s, size: %i bytes", datagram.senderAddress().toString().toStdString().c_str(), datagram.data().size());
-            //auto buffer = datagram.data();
-            //ethPacket *pckt = (ethPacket *)(datagram.data().data() + sizeof(ethPacketHeaderL1) - 1);
-            m_processor.onUnknownDatagram(datagram);
+        // Read into the same buffer every time, the datagram is parsed in place
+        const auto size = m_udpSocket.readDatagram(reinterpret_cast<char*>(m_receiveBuffer.data()), m_receiveBuffer.size(),
+                                                   &m_senderAddress, &m_senderPort);
+        if (size < 0) {
+            break;
         }
+
+        const uint32_t sender = m_senderAddress.toIPv4Address();
+        m_recorder.write(TraceRecord::Received, qToBigEndian(sender), m_senderPort, m_receiveBuffer.data(), size);
+        onDatagram(sender, m_receiveBuffer.data(), size);
+    }
+}
+
+void Ethernet_qt::onDatagram(uint32_t sender, const uint8_t* data, size_t size)
+{
+    const auto type = m_classifier.classify(sender, data, size);
+
+    switch (type) {
+    case DatagramClassifier::Type::Own:
+    case DatagramClassifier::Type::Localhost:
+        LOG_F(2, "Discard datagram from localhost");
+        break;
+    case DatagramClassifier::Type::EnergyMeter:
+        //LOG_F(1, "Received energy meter datagram. size: %zu", size);
+        m_processor.onEnergyMeterDatagram(data, size);
+        break;
+    case DatagramClassifier::Type::DiscoveryResponse:
+        LOG_F(2, "Received discovery response datagram. size: %zu", size);
+        m_processor.onDiscoveryResponseDatagram(sender);
+        break;
+    case DatagramClassifier::Type::Device:
+        LOG_F(2, "Received datagram from: %s, size: %zu bytes", asIp(sender).c_str(), size);
+        m_processor.onUnknownDatagram(sender, data, size);
+        break;
     }
 }
@@ -34,9 +34,16 @@ DISCLAIMER:
 
 #pragma once
 
+#include <vector>
+
+#include <QTimer>
 #include <QUdpSocket>
 
+#include "DatagramClassifier.h"
+#include "SpeedwireTrace.h"
+
 class ByteBuffer;
+class QSocketNotifier;
 namespace sma {
 class SmaManager;
 }
@@ -47,14 +54,40 @@ class Ethernet_qt : public QObject
 
 public:
     Ethernet_qt(sma::SmaManager& processor);
+    ~Ethernet_qt();
 
     void send(const ByteBuffer& data, uint32_t address, uint16_t port);
     void send(const QByteArray& datagram, const std::string& address, uint16_t port);
 
+    // Writes every datagram sent and received to a trace file
+    bool startRecording(const std::string& path);
+
+    // Replaces the network by a recorded trace, see TraceReader::open()
+    bool startReplay(const std::string& path, double speed);
+
 private:
     void onReadyRead();
+    void onDatagram(uint32_t sender, const uint8_t* data, size_t size);
+    void scheduleReplay();
+    void onReplayTimeout();
+    void refreshLocalAddresses();
+    void onNetlinkActivated();
 
     sma::SmaManager& m_processor;
 
     QUdpSocket m_udpSocket;
+    std::vector<uint8_t> m_receiveBuffer;
+    QHostAddress m_senderAddress;
+    quint16 m_senderPort = 0;
+    DatagramClassifier m_classifier;
+
+    // The local addresses are refreshed when the kernel reports an address
+    // change (Linux) and by a slow timer as a fallback
+    QTimer m_addressTimer;
+    int m_netlinkFd = -1;
+    QSocketNotifier* m_netlinkNotifier = nullptr;
+
+    TraceWriter m_recorder;
+    TraceReader m_replay;
+    QTimer m_replayTimer;
 };
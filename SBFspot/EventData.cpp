@@ -81,5 +81,21 @@ string EventData::EventCategory() const
     }
 }
 
+bool decodeEventData(const uint8_t *data, size_t size, uint32_t UserGroup, vector<EventData>& events)
+{
+	bool firstEventFound = false;
 
+	// Records are followed by the 4 byte end marker
+	for (size_t x = 41; x + sizeof(SMA_EVENTDATA) + 4 <= size; x += sizeof(SMA_EVENTDATA))
+	{
+		const SMA_EVENTDATA *pEventData = (const SMA_EVENTDATA *)(data + x);
+		if (pEventData->DateTime > 0)	// Fix Issue 89
+		{
+			events.push_back(EventData(UserGroup, pEventData));
+			if (pEventData->EntryID == 1)
+				firstEventFound = true;
+		}
+	}
 
+	return firstEventFound;
+}
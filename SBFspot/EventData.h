@@ -38,6 +38,7 @@ DISCLAIMER:
 #include "endianness.h"
 
 #include <string>
+#include <vector>
 
 //SMA Structs must be aligned on byte boundaries
 #pragma pack(push, 1)
@@ -123,3 +124,7 @@ private:
 
 bool SortEntryID_Asc(const EventData& ed1, const EventData& ed2);
 bool SortEntryID_Desc(const EventData& ed1, const EventData& ed2);
+
+// Appends the SMA_EVENTDATA records of an event data response (starting at offset 41)
+// Returns true if the first event (EntryID 1) is part of the response
+bool decodeEventData(const uint8_t *data, size_t size, uint32_t UserGroup, std::vector<EventData>& events);
@@ -146,10 +146,10 @@ void ExporterManager::exportConfig(const InverterData& inverterData) {
 void ExporterManager::exportLiveData(const LiveData& liveData) {
     for (auto& exporter : m_exporters) {
         // Live exporters always export.
-        // Non-live exporter only export when timestamp matches archive interval.
+        // Non-live exporter only export regular polls whose timestamp matches archive interval.
         if (exporter->isLive()) {
             exporter->exportLiveData(liveData);
-        } else if ((m_config.archiveInterval > 0 &&
+        } else if (!liveData.fast && (m_config.archiveInterval > 0 &&
                     (liveData.timestamp % m_config.archiveInterval == 0))) {
             exporter->exportLiveData(liveData);
         }
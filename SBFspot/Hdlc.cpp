@@ -0,0 +1,206 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#include "Hdlc.h"
+
+#include <array>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace hdlc {
+
+namespace {
+
+typedef std::array<std::array<uint16_t, 256>, 8> SlicingTables;
+
+// tables[k][v]: FCS contribution of byte v followed by k zero bytes
+constexpr SlicingTables makeTables()
+{
+    SlicingTables tables {};
+    for (int v = 0; v < 256; v++)
+    {
+        uint16_t fcs = v;
+        for (int bit = 0; bit < 8; bit++)
+            fcs = (fcs & 1) ? (fcs >> 1) ^ 0x8408 : (fcs >> 1);
+        tables[0][v] = fcs;
+    }
+    for (int k = 1; k < 8; k++)
+    {
+        for (int v = 0; v < 256; v++)
+            tables[k][v] = (tables[k-1][v] >> 8) ^ tables[0][tables[k-1][v] & 0xFF];
+    }
+    return tables;
+}
+
+constexpr SlicingTables tables = makeTables();
+
+inline uint8_t* escapeByte(uint8_t v, uint8_t* out)
+{
+    if (needsEscape(v))
+    {
+        *out++ = 0x7D;
+        *out++ = v ^ 0x20;
+    }
+    else
+        *out++ = v;
+
+    return out;
+}
+
+}
+
+uint16_t fcs16(uint16_t fcs, const uint8_t* data, size_t size)
+{
+    while (size >= 8)
+    {
+        fcs ^= data[0] | (data[1] << 8);
+        fcs = tables[7][fcs & 0xFF] ^ tables[6][fcs >> 8] ^
+              tables[5][data[2]] ^ tables[4][data[3]] ^
+              tables[3][data[4]] ^ tables[2][data[5]] ^
+              tables[1][data[6]] ^ tables[0][data[7]];
+        data += 8;
+        size -= 8;
+    }
+
+    while (size-- > 0)
+        fcs = (fcs >> 8) ^ tables[0][(fcs ^ *data++) & 0xFF];
+
+    return fcs;
+}
+
+size_t escape(const uint8_t* in, size_t size, uint8_t* out)
+{
+    uint8_t* const start = out;
+    size_t i = 0;
+
+    // Most blocks of 16 bytes have nothing to escape and are copied as a whole
+#if defined(__SSE2__)
+    const __m128i esc7D = _mm_set1_epi8(0x7D);
+    const __m128i esc7E = _mm_set1_epi8(0x7E);
+    const __m128i esc11 = _mm_set1_epi8(0x11);
+    const __m128i esc12 = _mm_set1_epi8(0x12);
+    const __m128i esc13 = _mm_set1_epi8(0x13);
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        const __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, esc7D), _mm_cmpeq_epi8(v, esc7E)),
+                                             _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, esc11), _mm_cmpeq_epi8(v, esc12)), _mm_cmpeq_epi8(v, esc13)));
+        if (_mm_movemask_epi8(special) == 0)
+        {
+            _mm_storeu_si128((__m128i*)out, v);
+            out += 16;
+        }
+        else
+        {
+            for (size_t j = 0; j < 16; j++)
+                out = escapeByte(in[i + j], out);
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 16 <= size; i += 16)
+    {
+        const uint8x16_t v = vld1q_u8(in + i);
+        const uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8(0x7D)), vceqq_u8(v, vdupq_n_u8(0x7E))),
+                                            vcleq_u8(vsubq_u8(v, vdupq_n_u8(0x11)), vdupq_n_u8(0x02)));
+        if (vmaxvq_u8(special) == 0)
+        {
+            vst1q_u8(out, v);
+            out += 16;
+        }
+        else
+        {
+            for (size_t j = 0; j < 16; j++)
+                out = escapeByte(in[i + j], out);
+        }
+    }
+#endif
+
+    for (; i < size; i++)
+        out = escapeByte(in[i], out);
+
+    return out - start;
+}
+
+size_t unescape(const uint8_t* in, size_t size, uint8_t* out)
+{
+    uint8_t* const start = out;
+    size_t i = 0;
+
+    while (i < size)
+    {
+        // Copy up to the next escape byte in blocks of 16
+#if defined(__SSE2__)
+        if (i + 16 <= size)
+        {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+            const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(0x7D)));
+            const size_t run = (mask == 0) ? 16 : __builtin_ctz(mask);
+            memmove(out, in + i, run);
+            out += run;
+            i += run;
+            if (run == 16)
+                continue;
+        }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        if (i + 16 <= size)
+        {
+            const uint8x16_t v = vld1q_u8(in + i);
+            if (vmaxvq_u8(vceqq_u8(v, vdupq_n_u8(0x7D))) == 0)
+            {
+                memmove(out, in + i, 16);
+                out += 16;
+                i += 16;
+                continue;
+            }
+        }
+#endif
+
+        if ((in[i] == 0x7D) && (i + 1 < size))
+        {
+            *out++ = in[i + 1] ^ 0x20;
+            i += 2;
+        }
+        else
+            *out++ = in[i++];
+    }
+
+    return out - start;
+}
+
+}
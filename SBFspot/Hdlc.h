@@ -0,0 +1,67 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * HDLC-like framing of the SMA Bluetooth protocol. A frame is delimited by
+ * 0x7E. Inside it, the bytes 0x7D, 0x7E, 0x11, 0x12 and 0x13 are sent as 0x7D
+ * followed by the byte XOR 0x20. The payload is protected by the FCS16 of
+ * RFC 1662 (reflected CRC-16, polynomial 0x8408), sent low byte first.
+ */
+namespace hdlc {
+
+const uint16_t FCS_INIT = 0xFFFF;
+
+// Continues an FCS16 calculation over data. Processes 8 bytes per step
+// (slicing-by-8). The final FCS is the result XOR 0xFFFF.
+uint16_t fcs16(uint16_t fcs, const uint8_t* data, size_t size);
+
+inline bool needsEscape(uint8_t v)
+{
+    return (v == 0x7D) || (v == 0x7E) || ((v >= 0x11) && (v <= 0x13));
+}
+
+// Escapes size bytes of in to out, which must hold 2 * size bytes.
+// Returns the number of bytes written.
+size_t escape(const uint8_t* in, size_t size, uint8_t* out);
+
+// Reverses escape(). out must hold size bytes, in and out may be the same.
+// Returns the number of bytes written.
+size_t unescape(const uint8_t* in, size_t size, uint8_t* out);
+
+}
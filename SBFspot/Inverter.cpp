@@ -34,6 +34,7 @@ DISCLAIMER:
 
 #include "Inverter.h"
 
+#include <chrono>
 #include <ctime>
 #include <boost/format.hpp>
 
@@ -42,6 +43,7 @@ DISCLAIMER:
 #include "CSVexport.h"
 #include "Defines.h"
 #include "Ethernet.h"
+#include "InverterDecoder.h"
 #include "Socket.h"
 #include "SBFNet.h"
 #include "SBFspot.h"
@@ -52,13 +54,13 @@ DISCLAIMER:
 
 using namespace boost;
 
-Inverter::Inverter(const Config& config, Ethernet& ethernet, Socket& import, SbfSpot& sbfSpot)
+Inverter::Inverter(const Config& config, Ethernet& ethernet, Socket& import, SbfSpot& sbfSpot, Exporter& exporter)
     : m_config(config),
       m_ethernet(ethernet),
       m_import(import),
       m_sbfSpot(sbfSpot),
       m_archData(m_import, m_sbfSpot),
-      m_exporterManager(config, m_cache)
+      m_exporter(exporter)
 {
 }
 
@@ -66,36 +68,59 @@ Inverter::~Inverter()
 {
 }
 
+void Inverter::setWorker(const std::vector<std::string>& addresses)
+{
+    m_worker = true;
+    m_addresses = addresses;
+}
+
 E_SBFSPOT Inverter::ethInitConnection()
 {
     if (VERBOSE_NORMAL) puts("Initializing...");
 
-    for (const auto& ip : m_config.ip_addresslist)
+    for (const auto& ip : m_worker ? m_addresses : m_config.ip_addresslist)
     {
         InverterData data;
         data.IPAddress = ip;
         m_inverters.push_back(data);
     }
 
-    //Generate a serial Number for application
-    srand(time(NULL));
-    AppSerial = 900000000 + ((rand() << 16) + rand()) % 100000000;
-    // Fix Issue 103: Eleminate confusion: apply name: session-id iso SN
-    if (VERBOSE_NORMAL) printf("SUSyID: %d - SessionID: %lu (0x%08lX)\n", AppSUSyID, AppSerial, AppSerial);
+    // The workers of InverterPool share the session of the pool
+    if (!m_worker)
+    {
+        //Generate a serial Number for application
+        srand(time(NULL));
+        AppSerial = 900000000 + ((rand() << 16) + rand()) % 100000000;
+        // Fix Issue 103: Eleminate confusion: apply name: session-id iso SN
+        if (VERBOSE_NORMAL) printf("SUSyID: %d - SessionID: %lu (0x%08lX)\n", AppSUSyID, AppSerial, AppSerial);
+    }
 
     E_SBFSPOT rc = E_OK;
     // len less than 0.0.0.0 or len of no string ==> use broadcast to detect inverters
     if (m_inverters.size() == 1 && m_inverters.front().IPAddress.size() < 8)
         m_inverters.front().IPAddress = discover();
 
-    for (auto& inverter : m_inverters)
+    // Initialize all inverters at once
+    std::vector<EthRequest> requests(m_inverters.size());
+    for (size_t i = 0; i < m_inverters.size(); ++i)
     {
-        auto buffer = m_sbfSpot.encodeInitRequest();
-        m_ethernet.ethSend(buffer, inverter.IPAddress);
-        Buffer response;
-        if ((rc = m_ethernet.ethGetPacket(response)) == E_OK)
+        requests[i].ip = m_inverters[i].IPAddress;
+        requests[i].request = m_sbfSpot.encodeInitRequest();
+        requests[i].packetId = m_sbfSpot.packetId();
+    }
+
+    rc = m_ethernet.ethExchange(requests);
+
+    // The inverters that answered are polled, the others are skipped
+    bool answered = false;
+    for (size_t i = 0; i < m_inverters.size(); ++i)
+    {
+        auto& inverter = m_inverters[i];
+        inverter.unreachable = (requests[i].rc != E_OK);
+        if (!inverter.unreachable)
         {
-            const ethPacket* pckt = (ethPacket*)response.data().data();
+            answered = true;
+            const ethPacket* pckt = (const ethPacket*)requests[i].response.data();
             inverter.SUSyID = btohs(pckt->Source.SUSyID);	// Fix Issue 98
             inverter.serial = btohl(pckt->Source.serial);	// Fix Issue 98
 
@@ -109,32 +134,31 @@ E_SBFSPOT Inverter::ethInitConnection()
         }
     }
 
-    return rc;
+    return answered ? E_OK : rc;
 }
 
 E_SBFSPOT Inverter::logonSMAInverter(std::vector<InverterData>& inverters, long userGroup, const char *password)
 {
-#define MAX_PWLENGTH 12
-    unsigned char pw[MAX_PWLENGTH] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-
     if (DEBUG_NORMAL) puts("logonSMAInverter()");
 
-    char encChar = (userGroup == UG_USER)? 0x88:0xBB;
-    //Encode password
-    unsigned int idx;
-    for (idx = 0; (password[idx] != 0) && (idx < sizeof(pw)); idx++)
-        pw[idx] = password[idx] + encChar;
-    for (; idx < MAX_PWLENGTH; idx++)
-        pw[idx] = encChar;
-
     E_SBFSPOT rc = E_OK;
-    int validPcktID = 0;
-
-    time_t now;
 
     if (m_config.ConnectionType == CT_BLUETOOTH)
     {
 #ifdef BLUETOOTH_FOUND
+#define MAX_PWLENGTH 12
+        unsigned char pw[MAX_PWLENGTH] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+        char encChar = (userGroup == UG_USER)? 0x88:0xBB;
+        //Encode password
+        unsigned int idx;
+        for (idx = 0; (password[idx] != 0) && (idx < sizeof(pw)); idx++)
+            pw[idx] = password[idx] + encChar;
+        for (; idx < MAX_PWLENGTH; idx++)
+            pw[idx] = encChar;
+
+        time_t now;
+        int validPcktID = 0;
         do
         {
             pcktID++;
@@ -201,54 +225,53 @@ E_SBFSPOT Inverter::logonSMAInverter(std::vector<InverterData>& inverters, long
     }
     else    // CT_ETHERNET
     {
-        for (const auto& inverter : inverters)
+        // Log on to all reachable inverters at once
+        std::vector<EthRequest> requests;
+        std::vector<size_t> indices;
+        for (size_t i = 0; i < inverters.size(); ++i)
+        {
+            const auto& inverter = inverters[i];
+            if (inverter.unreachable)
+                continue;
+
+            EthRequest request;
+            request.ip = inverter.IPAddress;
+            request.serial = inverter.serial;
+            request.request = m_sbfSpot.encodeLoginRequest(inverter.SUSyID, inverter.serial, (SmaUserGroup)userGroup, password);
+            request.packetId = m_sbfSpot.packetId();
+            requests.push_back(request);
+            indices.push_back(i);
+        }
+
+        if (requests.empty())
+            return E_NODATA;
+
+        // Fix Issue 167: an inverter that does not answer is skipped, unless none answers
+        const E_SBFSPOT exchangeRc = m_ethernet.ethExchange(requests);
+        bool answered = false;
+        for (size_t i = 0; i < requests.size(); ++i)
         {
-            do
+            const auto& request = requests[i];
+            if (request.rc != E_OK)
             {
-                pcktID++;
-                now = time(NULL);
-                m_buffer.writePacketHeader(0x01, addr_unknown);
-                if (inverter.SUSyID != SID_SB240)
-                    m_buffer.writePacket(0x0E, 0xA0, 0x0100, inverter.SUSyID, inverter.serial);
-                else
-                    m_buffer.writePacket(0x0E, 0xE0, 0x0100, inverter.SUSyID, inverter.serial);
-
-                m_buffer.writeLong(0xFFFD040C);
-                m_buffer.writeLong(userGroup);	// User / Installer
-                m_buffer.writeLong(0x00000384); // Timeout = 900sec ?
-                m_buffer.writeLong(now);
-                m_buffer.writeLong(0);
-                m_buffer.writeArray(pw, sizeof(pw));
-                m_buffer.writePacketTrailer();
-                m_buffer.writePacketLength();
+                std::cerr << "ERROR: No logon response from " << request.ip << ", skipping it\n";
+                inverters[indices[i]].unreachable = true;
+                continue;
             }
-            while (!m_buffer.isCrcValid());
-
-            m_ethernet.ethSend(m_buffer.data(), inverter.IPAddress);
 
-            validPcktID = 0;
-            do
+            answered = true;
+            const ethPacket* pckt = (const ethPacket *)request.response.data();
+            unsigned short retcode = btohs(pckt->ErrorCode);
+            switch (retcode)
             {
-                Buffer response;
-                if ((rc = m_ethernet.ethGetPacket(response)) == E_OK)
-                {
-                    const ethPacket* pckt = (ethPacket *)response.data().data();
-                    if (pcktID == (btohs(pckt->PacketID) & 0x7FFF))   // Valid Packet ID
-                    {
-                        validPcktID = 1;
-                        unsigned short retcode = btohs(pckt->ErrorCode);
-                        switch (retcode)
-                        {
-                            case 0: rc = E_OK; break;
-                            case 0x0100: rc = E_INVPASSW; break;
-                            default: rc = E_LOGONFAILED; break;
-                        }
-                    }
-                    else
-                        if (DEBUG_HIGHEST) printf("Packet ID mismatch. Expected %d, received %d\n", pcktID, (btohs(pckt->PacketID) & 0x7FFF));
-                }
-            } while ((validPcktID == 0) && (rc == E_OK)); // Fix Issue 167
+                case 0: break;
+                case 0x0100: rc = E_INVPASSW; break;
+                default: rc = E_LOGONFAILED; break;
+            }
         }
+
+        if (!answered)
+            rc = exchangeRc;
     }
 
     return rc;
@@ -257,18 +280,7 @@ E_SBFSPOT Inverter::logonSMAInverter(std::vector<InverterData>& inverters, long
 E_SBFSPOT Inverter::logoffSMAInverter(const InverterData& inverter)
 {
     if (DEBUG_NORMAL) puts("logoffSMAInverter()");
-    do
-    {
-        pcktID++;
-        m_buffer.writePacketHeader(0x01, addr_unknown);
-        m_buffer.writePacket(0x08, 0xA0, 0x0300, anySUSyID, anySerial);
-        m_buffer.writeLong(0xFFFD010E);
-        m_buffer.writeLong(0xFFFFFFFF);
-        m_buffer.writePacketTrailer();
-        m_buffer.writePacketLength();
-    }
-    while (!m_buffer.isCrcValid());
-    m_import.send(m_buffer.data(), inverter.IPAddress);
+    m_import.send(m_sbfSpot.encodeLogoutRequest(), inverter.IPAddress);
 
     return E_OK;
 }
@@ -287,19 +299,7 @@ E_SBFSPOT Inverter::logoffMultigateDevices(const std::vector<InverterData>& inve
                 const InverterData& psb = inverters[sb240];
                 if ((psb.SUSyID == SID_SB240) && (psb.multigateIndex == mg))
                 {
-                    do
-                    {
-                        pcktID++;
-                        m_buffer.writePacketHeader(0, BluetoothAddress());
-                        m_buffer.writePacket(0x08, 0xE0, 0x0300, psb.SUSyID, psb.serial);
-                        m_buffer.writeLong(0xFFFD010E);
-                        m_buffer.writeLong(0xFFFFFFFF);
-                        m_buffer.writePacketTrailer();
-                        m_buffer.writePacketLength();
-                    }
-                    while (!m_buffer.isCrcValid());
-
-                    m_ethernet.ethSend(m_buffer.data(), psb.IPAddress);
+                    m_ethernet.ethSend(m_sbfSpot.encodeLogoutRequest(psb.SUSyID, psb.serial), psb.IPAddress);
                     if (VERBOSE_NORMAL)
                         std::cout << "Logoff " << psb.SUSyID << ":" << psb.serial << std::endl;
                 }
@@ -316,53 +316,42 @@ E_SBFSPOT Inverter::getDeviceList(std::vector<InverterData>& inverters, int mult
 
     const int recordsize = 32;
 
-    do
-    {
-        pcktID++;
-        m_buffer.writePacketHeader(0x01, BluetoothAddress());
-        m_buffer.writePacket(0x09, 0xE0, 0, inverters[multigateIndex].SUSyID, inverters[multigateIndex].serial);
-        m_buffer.writeShort(0x0200);
-        m_buffer.writeShort(0xFFF5);
-        m_buffer.writeLong(0);
-        m_buffer.writeLong(0xFFFFFFFF);
-        m_buffer.writePacketTrailer();
-        m_buffer.writePacketLength();
-    }
-    while (!m_buffer.isCrcValid());
-    if (m_ethernet.ethSend(m_buffer.data(), inverters[multigateIndex].IPAddress) == -1)	// SOCKET_ERROR
+    const auto& buffer = m_sbfSpot.encodeDeviceListRequest(inverters[multigateIndex].SUSyID, inverters[multigateIndex].serial);
+    if (m_ethernet.ethSend(buffer, inverters[multigateIndex].IPAddress) == -1)	// SOCKET_ERROR
         return E_NODATA;
+    const uint16_t packetId = m_sbfSpot.packetId();
 
     int validPcktID = 0;
     do
     {
-        Buffer response;
-        rc = m_ethernet.ethGetPacket(response);
+        PacketView response;
+        rc = m_ethernet.ethGetPacket(response, inverters[multigateIndex].serial, packetId);
         if (rc != E_OK)
             return rc;
 
-        int16_t errorcode = get_short(response.data().data() + 23);
+        int16_t errorcode = get_short(response.data() + 23);
         if (errorcode != 0)
         {
             std::cerr << "Received errorcode=" << errorcode << std::endl;
             return (E_SBFSPOT)errorcode;
         }
 
-        unsigned short rcvpcktID = get_short(response.data().data()+27) & 0x7FFF;
-        if (pcktID == rcvpcktID)
+        unsigned short rcvpcktID = get_short(response.data()+27) & 0x7FFF;
+        if (packetId == rcvpcktID)
         {
-            uint32_t serial = get_long(response.data().data() + 17);
+            uint32_t serial = get_long(response.data() + 17);
             if (serial == inverters[multigateIndex].serial)
             {
                 rc = E_NODATA;
                 validPcktID = 1;
-                for (int i = 41; i < packetposition - 3; i += recordsize)
+                for (int i = 41; i < (int)response.size() - 4; i += recordsize)
                 {
-                    uint16_t devclass = get_short(response.data().data() + i + 4);
+                    uint16_t devclass = get_short(response.data() + i + 4);
                     if (devclass == 3)
                     {
                         InverterData inverter;
-                        inverter.SUSyID = get_short(response.data().data() + i + 6);
-                        inverter.serial = get_long(response.data().data() + i + 8);
+                        inverter.SUSyID = get_short(response.data() + i + 6);
+                        inverter.serial = get_long(response.data() + i + 8);
                         inverter.IPAddress = inverters[multigateIndex].IPAddress;
                         inverter.multigateIndex = multigateIndex;
                         inverters.push_back(inverter);
@@ -372,7 +361,7 @@ E_SBFSPOT Inverter::getDeviceList(std::vector<InverterData>& inverters, int mult
             }
             else if (DEBUG_HIGHEST) printf("serial Nr mismatch. Expected %lu, received %d\n", inverters[multigateIndex].serial, serial);
         }
-        else if (DEBUG_HIGHEST) printf("Packet ID mismatch. Expected %d, received %d\n", pcktID, rcvpcktID);
+        else if (DEBUG_HIGHEST) printf("Packet ID mismatch. Expected %d, received %d\n", packetId, rcvpcktID);
     }
     while (validPcktID == 0);
 
@@ -382,21 +371,59 @@ E_SBFSPOT Inverter::getDeviceList(std::vector<InverterData>& inverters, int mult
 int Inverter::getInverterData(std::vector<InverterData>& inverters, SmaInverterDataSet type)
 {
     if (DEBUG_NORMAL) printf("getInverterData(%d)\n", type);
-    const char *strWatt = "%-12s: %ld (W) %s";
-    const char *strVolt = "%-12s: %.2f (V) %s";
-    const char *strAmp = "%-12s: %.3f (A) %s";
-    const char *strkWh = "%-12s: %.3f (kWh) %s";
-    const char *strHour = "%-12s: %.3f (h) %s";
 
     int rc = E_OK;
 
-    int recordsize = 0;
+    if (m_config.ConnectionType == CT_ETHERNET)
+    {
+        // Plan the requests of all inverters, send them at once and collect the responses concurrently.
+        // The plans are kept across calls, so polling does not allocate once warmed up.
+        m_failedDataSets = 0;
+        m_acceptedDataSets.assign(inverters.size(), 0);
+        m_plan.clear();
+        m_planner.expire(sma::SmaRequestPlanner::Clock::now());
+        for (size_t i = 0; i < inverters.size(); ++i)
+        {
+            if (inverters[i].unreachable)
+                continue;
+
+            m_planned.clear();
+            m_planner.plan(inverters[i].SUSyID, type, m_planned);
+            for (const auto& request : m_planned)
+                m_plan.push_back({ i, request });
+        }
+
+        // Merged ranges that were rejected are requested again, split up.
+        // Timed out requests are not retried, their data sets failed.
+        while (!m_plan.empty())
+        {
+            const E_SBFSPOT passRc = exchangeDataPlan(inverters);
+            if (passRc != E_OK)
+                rc = passRc;
+            m_plan.swap(m_retryPlan);
+        }
+
+        return rc;
+    }
+
+    // One dataset per request over Bluetooth
+    if (sma::SmaRequestPlanner::isMerged(type))
+    {
+        for (uint32_t flag = 1; flag != 0; flag <<= 1)
+        {
+            if ((type & flag) && ((rc = getInverterData(inverters, (SmaInverterDataSet)flag)) != E_OK))
+                return rc;
+        }
+        return E_OK;
+    }
+
     int validPcktID = 0;
 
     for (auto& inverter : inverters)
     {
         auto buffer = m_sbfSpot.encodeDataRequest(inverter.SUSyID, inverter.serial, type);
         m_import.send(buffer, inverter.IPAddress);
+        const uint16_t packetId = m_sbfSpot.packetId();
 
         validPcktID = 0;
         do
@@ -409,399 +436,14 @@ int Inverter::getInverterData(std::vector<InverterData>& inverters, SmaInverterD
                 return E_CHKSUM;
 
             unsigned short rcvpcktID = get_short(m_buffer.data().data()+27) & 0x7FFF;
-            if (pcktID == rcvpcktID)
+            if (packetId == rcvpcktID)
             {
-                int inv = m_sbfSpot.getInverterIndexBySerial(inverters, get_short(m_buffer.data().data() + 15), get_long(m_buffer.data().data() + 17));
-                if (inv >= 0)
-                {
+                if (decodeInverterData(PacketView(m_buffer.data().data(), m_buffer.data().size()), inverters, type))
                     validPcktID = 1;
-                    int32_t value = 0;
-                    int64_t value64 = 0;
-                    unsigned char Vtype = 0;
-                    unsigned char Vbuild = 0;
-                    unsigned char Vminor = 0;
-                    unsigned char Vmajor = 0;
-                    for (int ii = 41; ii < packetposition - 3; ii += recordsize)
-                    {
-                        uint32_t code = ((uint32_t)get_long(m_buffer.data().data() + ii));
-                        LriDef lri = (LriDef)(code & 0x00FFFF00);
-                        uint32_t cls = code & 0xFF;
-                        unsigned char dataType = code >> 24;
-                        time_t datetime = (time_t)get_long(m_buffer.data().data() + ii + 4);
-
-                        // fix: We can't rely on dataType because it can be both 0x00 or 0x40 for DWORDs
-                        if ((lri == MeteringDyWhOut) || (lri == MeteringTotWhOut) || (lri == MeteringTotFeedTms) || (lri == MeteringTotOpTms))	//QWORD
-                            //if ((code == SPOT_ETODAY) || (code == SPOT_ETOTAL) || (code == SPOT_FEEDTM) || (code == SPOT_OPERTM))	//QWORD
-                        {
-                            value64 = get_longlong(m_buffer.data().data() + ii + 8);
-                            if ((value64 == (int64_t)NaN_S64) || (value64 == (int64_t)NaN_U64)) value64 = 0;
-                        }
-                        else if ((dataType != 0x10) && (dataType != 0x08))	//Not TEXT or STATUS, so it should be DWORD
-                        {
-                            value = (int32_t)get_long(m_buffer.data().data() + ii + 16);
-                            if ((value == (int32_t)NaN_S32) || (value == (int32_t)NaN_U32)) value = 0;
-                        }
-
-                        switch (lri)
-                        {
-                        case GridMsTotW: //SPOT_PACTOT
-                            if (recordsize == 0) recordsize = 28;
-                            //This function gives us the time when the inverter was switched off
-                            inverters[inv].SleepTime = datetime;
-                            inverters[inv].TotalPac = value;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strWatt, "SPOT_PACTOT", value, ctime(&datetime));
-                            break;
-
-                        case OperationHealthSttOk: //INV_PACMAX1
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].Pmax1 = value;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strWatt, "INV_PACMAX1", value, ctime(&datetime));
-                            break;
-
-                        case OperationHealthSttWrn: //INV_PACMAX2
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].Pmax2 = value;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strWatt, "INV_PACMAX2", value, ctime(&datetime));
-                            break;
-
-                        case OperationHealthSttAlm: //INV_PACMAX3
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].Pmax3 = value;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strWatt, "INV_PACMAX3", value, ctime(&datetime));
-                            break;
-
-                        case GridMsWphsA: //SPOT_PAC1
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].Pac1 = value;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strWatt, "SPOT_PAC1", value, ctime(&datetime));
-                            break;
-
-                        case GridMsWphsB: //SPOT_PAC2
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].Pac2 = value;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strWatt, "SPOT_PAC2", value, ctime(&datetime));
-                            break;
-
-                        case GridMsWphsC: //SPOT_PAC3
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].Pac3 = value;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strWatt, "SPOT_PAC3", value, ctime(&datetime));
-                            break;
-
-                        case GridMsPhVphsA: //SPOT_UAC1
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].Uac1 = value;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strVolt, "SPOT_UAC1", toVolt(value), ctime(&datetime));
-                            break;
-
-                        case GridMsPhVphsB: //SPOT_UAC2
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].Uac2 = value;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strVolt, "SPOT_UAC2", toVolt(value), ctime(&datetime));
-                            break;
-
-                        case GridMsPhVphsC: //SPOT_UAC3
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].Uac3 = value;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strVolt, "SPOT_UAC3", toVolt(value), ctime(&datetime));
-                            break;
-
-                        case GridMsAphsA_1: //SPOT_IAC1
-                        case GridMsAphsA:
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].Iac1 = value;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strAmp, "SPOT_IAC1", toAmp(value), ctime(&datetime));
-                            break;
-
-                        case GridMsAphsB_1: //SPOT_IAC2
-                        case GridMsAphsB:
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].Iac2 = value;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strAmp, "SPOT_IAC2", toAmp(value), ctime(&datetime));
-                            break;
-
-                        case GridMsAphsC_1: //SPOT_IAC3
-                        case GridMsAphsC:
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].Iac3 = value;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strAmp, "SPOT_IAC3", toAmp(value), ctime(&datetime));
-                            break;
-
-                        case GridMsHz: //SPOT_FREQ
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].GridFreq = value;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf("%-12s: %.2f (Hz) %s", "SPOT_FREQ", toHz(value), ctime(&datetime));
-                            break;
-
-                        case DcMsWatt: //SPOT_PDC1 / SPOT_PDC2
-                            if (recordsize == 0) recordsize = 28;
-                            if (cls == 1)   // MPP1
-                            {
-                                inverters[inv].Pdc1 = value;
-                                if (DEBUG_NORMAL) printf(strWatt, "SPOT_PDC1", value, ctime(&datetime));
-                            }
-                            if (cls == 2)   // MPP2
-                            {
-                                inverters[inv].Pdc2 = value;
-                                if (DEBUG_NORMAL) printf(strWatt, "SPOT_PDC2", value, ctime(&datetime));
-                            }
-                            inverters[inv].flags |= type;
-                            break;
-
-                        case DcMsVol: //SPOT_UDC1 / SPOT_UDC2
-                            if (recordsize == 0) recordsize = 28;
-                            if (cls == 1)
-                            {
-                                inverters[inv].Udc1 = value;
-                                if (DEBUG_NORMAL) printf(strVolt, "SPOT_UDC1", toVolt(value), ctime(&datetime));
-                            }
-                            if (cls == 2)
-                            {
-                                inverters[inv].Udc2 = value;
-                                if (DEBUG_NORMAL) printf(strVolt, "SPOT_UDC2", toVolt(value), ctime(&datetime));
-                            }
-                            inverters[inv].flags |= type;
-                            break;
-
-                        case DcMsAmp: //SPOT_IDC1 / SPOT_IDC2
-                            if (recordsize == 0) recordsize = 28;
-                            if (cls == 1)
-                            {
-                                inverters[inv].Idc1 = value;
-                                if (DEBUG_NORMAL) printf(strAmp, "SPOT_IDC1", toAmp(value), ctime(&datetime));
-                            }
-                            if (cls == 2)
-                            {
-                                inverters[inv].Idc2 = value;
-                                if (DEBUG_NORMAL) printf(strAmp, "SPOT_IDC2", toAmp(value), ctime(&datetime));
-                            }
-                            inverters[inv].flags |= type;
-                            break;
-
-                        case MeteringTotWhOut: //SPOT_ETOTAL
-                            if (recordsize == 0) recordsize = 16;
-                            //In case SPOT_ETODAY missing, this function gives us inverter time (eg: SUNNY TRIPOWER 6.0)
-                            inverters[inv].InverterDatetime = datetime;
-                            inverters[inv].ETotal = value64;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strkWh, "SPOT_ETOTAL", tokWh(value64), ctime(&datetime));
-                            break;
-
-                        case MeteringDyWhOut: //SPOT_ETODAY
-                            if (recordsize == 0) recordsize = 16;
-                            //This function gives us the current inverter time
-                            inverters[inv].InverterDatetime = datetime;
-                            inverters[inv].EToday = value64;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strkWh, "SPOT_ETODAY", tokWh(value64), ctime(&datetime));
-                            break;
-
-                        case MeteringTotOpTms: //SPOT_OPERTM
-                            if (recordsize == 0) recordsize = 16;
-                            inverters[inv].OperationTime = value64;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strHour, "SPOT_OPERTM", toHour(value64), ctime(&datetime));
-                            break;
-
-                        case MeteringTotFeedTms: //SPOT_FEEDTM
-                            if (recordsize == 0) recordsize = 16;
-                            inverters[inv].FeedInTime = value64;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf(strHour, "SPOT_FEEDTM", toHour(value64), ctime(&datetime));
-                            break;
-
-                        case NameplateLocation: //INV_NAME
-                            if (recordsize == 0) recordsize = 40;
-                            //This function gives us the time when the inverter was switched on
-                            inverters[inv].WakeupTime = datetime;
-                            char deviceName[33];
-                            strncpy(deviceName, (char *)m_buffer.data().data() + ii + 8, sizeof(deviceName)-1);
-                            inverters[inv].DeviceName = deviceName;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf("%-12s: '%s' %s", "INV_NAME", inverters[inv].DeviceName.c_str(), ctime(&datetime));
-                            break;
-
-                        case NameplatePkgRev: //INV_SWVER
-                            if (recordsize == 0) recordsize = 40;
-                            Vtype = m_buffer.data().data()[ii + 24];
-                            char ReleaseType[4];
-                            if (Vtype > 5)
-                                sprintf(ReleaseType, "%d", Vtype);
-                            else
-                                sprintf(ReleaseType, "%c", "NEABRS"[Vtype]); //NOREV-EXPERIMENTAL-ALPHA-BETA-RELEASE-SPECIAL
-                            Vbuild = m_buffer.data().data()[ii + 25];
-                            Vminor = m_buffer.data().data()[ii + 26];
-                            Vmajor = m_buffer.data().data()[ii + 27];
-                            //Vmajor and Vminor = 0x12 should be printed as '12' and not '18' (BCD)
-                            char swVersion[16];
-                            snprintf(swVersion, sizeof(swVersion), "%c%c.%c%c.%02d.%s", '0'+(Vmajor >> 4), '0'+(Vmajor & 0x0F), '0'+(Vminor >> 4), '0'+(Vminor & 0x0F), Vbuild, ReleaseType);
-                            inverters[inv].SWVersion = swVersion;
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf("%-12s: '%s' %s", "INV_SWVER", inverters[inv].SWVersion.c_str(), ctime(&datetime));
-                            break;
-
-                        case NameplateModel: //INV_TYPE
-                            if (recordsize == 0) recordsize = 40;
-                            for (int idx = 8; idx < recordsize; idx += 4)
-                            {
-                                unsigned long attribute = ((unsigned long)get_long(m_buffer.data().data() + ii + idx)) & 0x00FFFFFF;
-                                unsigned char status = m_buffer.data().data()[ii + idx + 3];
-                                if (attribute == 0xFFFFFE) break;	//End of attributes
-                                if (status == 1)
-                                {
-                                    std::string devtype = tagdefs.getDesc(attribute);
-                                    if (!devtype.empty())
-                                    {
-                                        inverters[inv].DeviceType = devtype;
-                                    }
-                                    else
-                                    {
-                                        inverters[inv].DeviceType = "UNKNOWN TYPE";
-                                        printf("Unknown Inverter Type. Report this issue at https://github.com/SBFspot/SBFspot/issues with following info:\n");
-                                        printf("0x%08lX and Inverter Type=<Fill in the exact type> (e.g. SB1300TL-10)\n", attribute);
-                                    }
-                                }
-                            }
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf("%-12s: '%s' %s", "INV_TYPE", inverters[inv].DeviceType.c_str(), ctime(&datetime));
-                            break;
-
-                        case NameplateMainModel: //INV_CLASS
-                            if (recordsize == 0) recordsize = 40;
-                            for (int idx = 8; idx < recordsize; idx += 4)
-                            {
-                                unsigned long attribute = ((unsigned long)get_long(m_buffer.data().data() + ii + idx)) & 0x00FFFFFF;
-                                unsigned char attValue = m_buffer.data().data()[ii + idx + 3];
-                                if (attribute == 0xFFFFFE) break;	//End of attributes
-                                if (attValue == 1)
-                                {
-                                    inverters[inv].DevClass = (DEVICECLASS)attribute;
-                                    std::string devclass = tagdefs.getDesc(attribute);
-                                    if (!devclass.empty())
-                                    {
-                                        inverters[inv].DeviceClass = devclass;
-                                    }
-                                    else
-                                    {
-                                        inverters[inv].DeviceClass = "UNKNOWN CLASS";
-                                        printf("Unknown Device Class. Report this issue at https://github.com/SBFspot/SBFspot/issues with following info:\n");
-                                        printf("0x%08lX and Device Class=...\n", attribute);
-                                    }
-                                }
-                            }
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf("%-12s: '%s' %s", "INV_CLASS", inverters[inv].DeviceClass.c_str(), ctime(&datetime));
-                            break;
-
-                        case OperationHealth: //INV_STATUS:
-                            if (recordsize == 0) recordsize = 40;
-                            for (int idx = 8; idx < recordsize; idx += 4)
-                            {
-                                unsigned long attribute = ((unsigned long)get_long(m_buffer.data().data() + ii + idx)) & 0x00FFFFFF;
-                                unsigned char attValue = m_buffer.data().data()[ii + idx + 3];
-                                if (attribute == 0xFFFFFE) break;	//End of attributes
-                                if (attValue == 1)
-                                    inverters[inv].DeviceStatus = attribute;
-                            }
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf("%-12s: '%s' %s", "INV_STATUS", tagdefs.getDesc(inverters[inv].DeviceStatus, "?").c_str(), ctime(&datetime));
-                            break;
-
-                        case OperationGriSwStt: //INV_GRIDRELAY
-                            if (recordsize == 0) recordsize = 40;
-                            for (int idx = 8; idx < recordsize; idx += 4)
-                            {
-                                unsigned long attribute = ((unsigned long)get_long(m_buffer.data().data() + ii + idx)) & 0x00FFFFFF;
-                                unsigned char attValue = m_buffer.data().data()[ii + idx + 3];
-                                if (attribute == 0xFFFFFE) break;	//End of attributes
-                                if (attValue == 1)
-                                    inverters[inv].GridRelayStatus = attribute;
-                            }
-                            inverters[inv].flags |= type;
-                            if (DEBUG_NORMAL) printf("%-12s: '%s' %s", "INV_GRIDRELAY", tagdefs.getDesc(inverters[inv].GridRelayStatus, "?").c_str(), ctime(&datetime));
-                            break;
-
-                        case BatChaStt:
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].BatChaStt = value;
-                            inverters[inv].flags |= type;
-                            break;
-
-                        case BatDiagCapacThrpCnt:
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].BatDiagCapacThrpCnt = value;
-                            inverters[inv].flags |= type;
-                            break;
-
-                        case BatDiagTotAhIn:
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].BatDiagTotAhIn = value;
-                            inverters[inv].flags |= type;
-                            break;
-
-                        case BatDiagTotAhOut:
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].BatDiagTotAhOut = value;
-                            inverters[inv].flags |= type;
-                            break;
-
-                        case BatTmpVal:
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].BatTmpVal = value;
-                            inverters[inv].flags |= type;
-                            break;
-
-                        case BatVol:
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].BatVol = value;
-                            inverters[inv].flags |= type;
-                            break;
-
-                        case BatAmp:
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].BatAmp = value;
-                            inverters[inv].flags |= type;
-                            break;
-
-                        case CoolsysTmpNom:
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].Temperature = value;
-                            inverters[inv].flags |= type;
-                            break;
-
-                        case MeteringGridMsTotWhOut:
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].MeteringGridMsTotWOut = value;
-                            break;
-
-                        case MeteringGridMsTotWhIn:
-                            if (recordsize == 0) recordsize = 28;
-                            inverters[inv].MeteringGridMsTotWIn = value;
-                            break;
-
-                        default:
-                            if (recordsize == 0) recordsize = 12;
-                        }
-                    }
-                }
             }
             else
             {
-                if (DEBUG_HIGHEST) printf("Packet ID mismatch. Expected %d, received %d\n", pcktID, rcvpcktID);
+                if (DEBUG_HIGHEST) printf("Packet ID mismatch. Expected %d, received %d\n", packetId, rcvpcktID);
             }
         }
         while (validPcktID == 0);
@@ -810,16 +452,98 @@ int Inverter::getInverterData(std::vector<InverterData>& inverters, SmaInverterD
     return E_OK;
 }
 
+// Sends m_plan and decodes the responses. Merged requests answered with an error code are planned again into m_retryPlan.
+E_SBFSPOT Inverter::exchangeDataPlan(std::vector<InverterData>& inverters)
+{
+    m_requests.resize(m_plan.size());
+    for (size_t i = 0; i < m_plan.size(); ++i)
+    {
+        const InverterData& inverter = inverters[m_plan[i].inverter];
+        m_requests[i].ip = inverter.IPAddress;
+        m_requests[i].serial = inverter.serial;
+        m_requests[i].request = m_sbfSpot.encodeDataRequest(inverter.SUSyID, inverter.serial, m_plan[i].request);
+        m_requests[i].packetId = m_sbfSpot.packetId();
+    }
+
+    m_ethernet.ethExchange(m_requests);
+
+    E_SBFSPOT rc = E_OK;
+    m_retryPlan.clear();
+    for (size_t i = 0; i < m_plan.size(); ++i)
+    {
+        const PlannedRequest& planned = m_plan[i];
+        const EthRequest& request = m_requests[i];
+        const bool answered = (request.rc == E_OK) && (request.response.size() > 24);
+        const bool rejected = answered && (get_short(request.response.data() + 23) != 0);
+
+        if (rejected && sma::SmaRequestPlanner::isMerged(planned.request.dataSet))
+        {
+            const uint16_t susyId = inverters[planned.inverter].SUSyID;
+            if (DEBUG_NORMAL) printf("SUSyID %d rejected merged request 0x%08X-0x%08X\n", susyId, planned.request.first, planned.request.last);
+            m_planner.reject(susyId, planned.request, sma::SmaRequestPlanner::Clock::now());
+            m_rejectedMerges.push_back({ inverters[planned.inverter].serial, susyId, planned.request });
+
+            m_planned.clear();
+            m_planner.plan(susyId, planned.request.dataSet, m_planned);
+            for (const auto& split : m_planned)
+                m_retryPlan.push_back({ planned.inverter, split });
+        }
+        else if (request.rc == E_OK)
+        {
+            if (answered && !rejected)
+                m_acceptedDataSets[planned.inverter] |= planned.request.dataSet;
+            decodeInverterData(request.response, inverters, planned.request.dataSet);
+        }
+        else
+        {
+            rc = request.rc;
+            m_failedDataSets |= planned.request.dataSet;
+        }
+    }
+
+    return rc;
+}
+
+// Requests all datasets at once, getSpotData() then takes their result without another round trip.
+// The exchange ends when every response is in or the last request ran out of retransmits.
+void Inverter::prefetchInverterData(uint32_t dataSets)
+{
+    m_prefetched = 0;
+    if (m_config.ConnectionType != CT_ETHERNET)
+        return;
+
+    getInverterData(m_inverters, (SmaInverterDataSet)dataSets);
+    m_prefetched = dataSets;
+    m_prefetchFailed = m_failedDataSets;
+}
+
+int Inverter::getSpotData(SmaInverterDataSet type)
+{
+    if ((m_prefetched & type) == type)
+        return (m_prefetchFailed & type) ? E_NODATA : E_OK;
+
+    return getInverterData(m_inverters, type);
+}
+
 int Inverter::process(std::time_t timestamp)
 {
-    int rc = logOn();
+    using Clock = std::chrono::steady_clock;
+    auto seconds = [](Clock::time_point from) { return std::chrono::duration<double>(Clock::now() - from).count(); };
+
+    m_timing = Timing();
+    auto phaseStart = Clock::now();
+    m_sessionResumed = resumeSession();
+    int rc = m_sessionResumed ? 0 : logOn();
+    m_timing.logon = seconds(phaseStart);
     if (rc != 0)
     {
         logOff();
         return rc;
     }
 
-    if (VERBOSE_NORMAL) puts("Logon OK");
+    if (VERBOSE_NORMAL) puts(m_sessionResumed ? "Session resumed" : "Logon OK");
+    if (keepSession() && !m_sessionResumed)
+        m_sessionStart = std::time(nullptr);
 
 #ifdef BLUETOOTH_FOUND
     // If SBFspot is executed with settime command
@@ -842,18 +566,37 @@ int Inverter::process(std::time_t timestamp)
 #endif
 
     // Import Spot Data
+    phaseStart = Clock::now();
     rc = importSpotData(timestamp);
+    if ((rc == E_LOGONFAILED) && m_sessionResumed)
+    {
+        // The inverters have dropped the session, their rejections of merged requests in this poll are meaningless
+        if (VERBOSE_NORMAL) puts("Session lost, logging on again");
+        for (const auto& rejected : m_rejectedMerges)
+            m_planner.forget(rejected.susyId, rejected.request);
+        logOff();
+        m_sessionResumed = false;
+        m_sessionStart = 0;
+        if ((rc = logOn()) != 0)
+        {
+            logOff();
+            return rc;
+        }
+        m_sessionStart = std::time(nullptr);
+        rc = importSpotData(timestamp);
+    }
+    m_timing.spotData = seconds(phaseStart);
     if (rc != 0) {
         std::cerr << "Importing live data failed." << std::endl;
     }
 
     // Export Config
     for (const auto& inverter : m_inverters) {
-        m_exporterManager.exportConfig(inverter);
+        m_exporter.exportConfig(inverter);
     }
 
     // Export Spot Data
-    m_exporterManager.exportSpotData(timestamp, m_inverters);
+    m_exporter.exportSpotData(timestamp, m_inverters);
     m_cache.clear();
 
     // Only export archive data, when not running in daemon mode OR
@@ -862,18 +605,120 @@ int Inverter::process(std::time_t timestamp)
             (m_config.archiveInterval > 0 &&
             (timestamp % m_config.archiveInterval == 0)))
     {
+        phaseStart = Clock::now();
         importDayData();
         importMonthData();
         importEventData();
+        m_timing.archiveData = seconds(phaseStart);
     }
 
+    if (keepSession())
+    {
+        m_exporter.close();
+        return rc;
+    }
+
+    m_sessionStart = 0;
     logOff();
     m_import.close();
-    m_exporterManager.close();
+    m_exporter.close();
 
     return rc;
 }
 
+bool Inverter::keepSession() const
+{
+    if ((m_config.keepSession == 0) || (m_config.command != Config::Command::RunDaemon) || (m_config.ConnectionType != CT_ETHERNET))
+        return false;
+
+    // The devices of a Multigate are looked up again in every poll
+    for (const auto& inverter : m_inverters)
+    {
+        if (inverter.SUSyID == SID_MULTIGATE)
+            return false;
+    }
+
+    return !m_inverters.empty();
+}
+
+// Continues the session of the previous poll, after renewing it when it gets near the logon timeout
+bool Inverter::resumeSession()
+{
+    if ((m_sessionStart == 0) || m_inverters.empty())
+        return false;
+
+    const std::time_t now = std::time(nullptr);
+    if (now - m_sessionStart >= SESSION_RENEWAL)
+    {
+        // Skipped inverters get another chance in a new session
+        for (const auto& inverter : m_inverters)
+        {
+            if (inverter.unreachable)
+            {
+                m_sessionStart = 0;
+                logOff();
+                return false;
+            }
+        }
+
+        if (VERBOSE_NORMAL) puts("Renewing session...");
+        for (const auto& inverter : m_inverters)
+            logoffSMAInverter(inverter);
+        if (logonSMAInverter(m_inverters, m_config.smaUserGroup, m_config.smaPassword) != E_OK)
+        {
+            m_sessionStart = 0;
+            logOff();
+            m_import.close();
+            return false;
+        }
+        m_sessionStart = now;
+    }
+
+    // Values of the previous poll must not be exported again
+    for (auto& inverter : m_inverters)
+    {
+        InverterData data;
+        data.IPAddress = inverter.IPAddress;
+        data.unreachable = inverter.unreachable;
+        data.SUSyID = inverter.SUSyID;
+        data.serial = inverter.serial;
+        inverter = data;
+    }
+
+    return true;
+}
+
+// Logs on again to the given inverters of a resumed session and requests the datasets they missed
+void Inverter::logOnAgain(const std::vector<size_t>& inverters)
+{
+    std::vector<InverterData> silent;
+    for (size_t i : inverters)
+    {
+        if (VERBOSE_NORMAL) printf("No response from %s, logging on again\n", m_inverters[i].IPAddress.c_str());
+        silent.push_back(m_inverters[i]);
+
+        // Its rejections of merged requests in this poll are meaningless
+        for (const auto& rejected : m_rejectedMerges)
+        {
+            if (rejected.serial == m_inverters[i].serial)
+                m_planner.forget(rejected.susyId, rejected.request);
+        }
+    }
+
+    // The ones that do not answer the logon either are skipped in this session
+    if (logonSMAInverter(silent, m_config.smaUserGroup, m_config.smaPassword) != E_OK)
+    {
+        if (VERBOSE_NORMAL) puts("Logon failed");
+        for (size_t i = 0; i < inverters.size(); ++i)
+            m_inverters[inverters[i]].unreachable = silent[i].unreachable;
+        return;
+    }
+
+    getInverterData(silent, (SmaInverterDataSet)m_prefetched);
+    for (size_t i = 0; i < inverters.size(); ++i)
+        m_inverters[inverters[i]] = silent[i];
+}
+
 void Inverter::reset()
 {
     m_dayStats.clear();
@@ -882,7 +727,7 @@ void Inverter::reset()
     for (size_t i = 0; i < m_inverters.size(); ++i) {
         m_dayStats[i].serial = m_inverters[i].serial;
         m_dayStats[i].timestamp = now;
-        m_exporterManager.exportDayStats(m_dayStats[i]);
+        m_exporter.exportDayStats(m_dayStats[i]);
     }
 }
 
@@ -967,7 +812,7 @@ int Inverter::logOn()
     else // CT_ETHERNET
     {
         if (VERBOSE_NORMAL) printf("Connecting to Local Network...\n");
-        rc = m_ethernet.ethConnect(m_config.IP_Port);
+        rc = m_ethernet.ethConnect(m_config.IP_Port, !m_worker);
         if (rc != 0)
         {
             print_error(stdout, PROC_CRITICAL, "Failed to set up socket connection.");
@@ -1016,13 +861,40 @@ void Inverter::logOff()
 int Inverter::importSpotData(std::time_t timestamp)
 {
     int rc = 0;
-    if ((rc = getInverterData(m_inverters, sbftest)) != 0)
+    m_rejectedMerges.clear();
+
+    // The device class and type decide on the datasets of the next stage
+    prefetchInverterData(sbftest | SoftwareVersion | TypeLabel);
+
+    // An inverter that answers nothing or error codes only in a resumed session has dropped it, or is asleep.
+    // The session of the plant is lost when all of them did, otherwise only those log on again.
+    if (m_sessionResumed && (m_prefetched != 0))
+    {
+        std::vector<size_t> silent;
+        size_t requested = 0;
+        for (size_t i = 0; i < m_acceptedDataSets.size(); ++i)
+        {
+            if (m_inverters[i].unreachable)
+                continue;
+
+            ++requested;
+            if ((m_acceptedDataSets[i] & m_prefetched) == 0)
+                silent.push_back(i);
+        }
+
+        if (!silent.empty() && (silent.size() == requested))
+            return E_LOGONFAILED;
+        if (!silent.empty())
+            logOnAgain(silent);
+    }
+
+    if ((rc = getSpotData(sbftest)) != 0)
         std::cerr << "getInverterData(sbftest) returned an error: " << rc << std::endl;
 
-    if ((rc = getInverterData(m_inverters, SoftwareVersion)) != 0)
+    if ((rc = getSpotData(SoftwareVersion)) != 0)
         std::cerr << "getSoftwareVersion returned an error: " << rc << std::endl;
 
-    if ((rc = getInverterData(m_inverters, TypeLabel)) != 0)
+    if ((rc = getSpotData(TypeLabel)) != 0)
         std::cerr << "getTypeLabel returned an error: " << rc << std::endl;
     else
     {
@@ -1106,9 +978,18 @@ int Inverter::importSpotData(std::time_t timestamp)
         ++multigateIndex;
     }
 
+    // Everything else at once, multigate devices are known by now
+    uint32_t dataSets = DeviceStatus | InverterTemperature | MaxACPower | EnergyProduction | OperationTime |
+            SpotDCPower | SpotDCVoltage | SpotACPower | SpotACVoltage | SpotGridFrequency | SpotACTotalPower;
+    if (hasBatteryDevice)
+        dataSets |= BatteryChargeStatus | BatteryInfo | MeteringGridMsTotW;
+    if (m_inverters[0].DevClass == SolarInverter)
+        dataSets |= GridRelayStatus;
+    prefetchInverterData(dataSets);
+
     if (hasBatteryDevice)
     {
-        if ((rc = getInverterData(m_inverters, BatteryChargeStatus)) != 0)
+        if ((rc = getSpotData(BatteryChargeStatus)) != 0)
             std::cerr << "getBatteryChargeStatus returned an error: " << rc << std::endl;
         else
         {
@@ -1125,7 +1006,7 @@ int Inverter::importSpotData(std::time_t timestamp)
             }
         }
 
-        if ((rc = getInverterData(m_inverters, BatteryInfo)) != 0)
+        if ((rc = getSpotData(BatteryInfo)) != 0)
             std::cerr << "getBatteryInfo returned an error: " << rc << std::endl;
         else
         {
@@ -1144,7 +1025,7 @@ int Inverter::importSpotData(std::time_t timestamp)
             }
         }
 
-        if ((rc = getInverterData(m_inverters, MeteringGridMsTotW)) != 0)
+        if ((rc = getSpotData(MeteringGridMsTotW)) != 0)
             std::cerr << "getMeteringGridInfo returned an error: " << rc << std::endl;
         else
         {
@@ -1163,7 +1044,7 @@ int Inverter::importSpotData(std::time_t timestamp)
         }
     }
 
-    if ((rc = getInverterData(m_inverters, DeviceStatus)) != 0)
+    if ((rc = getSpotData(DeviceStatus)) != 0)
         std::cerr << "getDeviceStatus returned an error: " << rc << std::endl;
     else
     {
@@ -1177,7 +1058,7 @@ int Inverter::importSpotData(std::time_t timestamp)
         }
     }
 
-    if ((rc = getInverterData(m_inverters, InverterTemperature)) != 0)
+    if ((rc = getSpotData(InverterTemperature)) != 0)
         std::cerr << "getInverterTemperature returned an error: " << rc << std::endl;
     else
     {
@@ -1193,7 +1074,7 @@ int Inverter::importSpotData(std::time_t timestamp)
 
     if (m_inverters[0].DevClass == SolarInverter)
     {
-        if ((rc = getInverterData(m_inverters, GridRelayStatus)) != 0)
+        if ((rc = getSpotData(GridRelayStatus)) != 0)
             std::cerr << "getGridRelayStatus returned an error: " << rc << std::endl;
         else
         {
@@ -1211,7 +1092,7 @@ int Inverter::importSpotData(std::time_t timestamp)
         }
     }
 
-    if ((rc = getInverterData(m_inverters, MaxACPower)) != 0)
+    if ((rc = getSpotData(MaxACPower)) != 0)
         std::cerr << "getMaxACPower returned an error: " << rc << std::endl;
     else
     {
@@ -1233,10 +1114,10 @@ int Inverter::importSpotData(std::time_t timestamp)
         }
     }
 
-    if ((rc = getInverterData(m_inverters, EnergyProduction)) != 0)
+    if ((rc = getSpotData(EnergyProduction)) != 0)
         std::cerr << "getEnergyProduction returned an error: " << rc << std::endl;
 
-    if ((rc = getInverterData(m_inverters, OperationTime)) != 0)
+    if ((rc = getSpotData(OperationTime)) != 0)
         std::cerr << "getOperationTime returned an error: " << rc << std::endl;
     else
     {
@@ -1254,10 +1135,10 @@ int Inverter::importSpotData(std::time_t timestamp)
         }
     }
 
-    if ((rc = getInverterData(m_inverters, SpotDCPower)) != 0)
+    if ((rc = getSpotData(SpotDCPower)) != 0)
         std::cerr << "getSpotDCPower returned an error: " << rc << std::endl;
 
-    if ((rc = getInverterData(m_inverters, SpotDCVoltage)) != 0)
+    if ((rc = getSpotData(SpotDCVoltage)) != 0)
         std::cerr << "getSpotDCVoltage returned an error: " << rc << std::endl;
 
     //Calculate missing DC Spot Values
@@ -1277,13 +1158,11 @@ int Inverter::importSpotData(std::time_t timestamp)
         }
     }
 
-    if ((rc = getInverterData(m_inverters, SpotACPower)) != 0)
-        std::cerr << "getSpotACPower returned an error: " << rc << std::endl;
-
-    if ((rc = getInverterData(m_inverters, SpotACVoltage)) != 0)
-        std::cerr << "getSpotACVoltage returned an error: " << rc << std::endl;
+    const int rcSpotAC = getSpotData((SmaInverterDataSet)(SpotACPower | SpotACVoltage | SpotGridFrequency));
+    if (rcSpotAC != 0)
+        std::cerr << "getSpotACPower/Voltage/GridFrequency returned an error: " << rcSpotAC << std::endl;
 
-    if ((rc = getInverterData(m_inverters, SpotACTotalPower)) != 0)
+    if ((rc = getSpotData(SpotACTotalPower)) != 0)
         std::cerr << "getSpotACTotalPower returned an error: " << rc << std::endl;
 
     //Calculate missing AC Spot Values
@@ -1307,9 +1186,7 @@ int Inverter::importSpotData(std::time_t timestamp)
         }
     }
 
-    if ((rc = getInverterData(m_inverters, SpotGridFrequency)) != 0)
-        std::cerr << "getSpotGridFrequency returned an error: " << rc << std::endl;
-    else
+    if (rcSpotAC == 0)
     {
         for (const auto& inverter : m_inverters)
         {
@@ -1340,6 +1217,18 @@ int Inverter::importSpotData(std::time_t timestamp)
         }
     }
 
+    if (VERBOSE_HIGH && (m_config.ConnectionType == CT_ETHERNET))
+    {
+        for (const auto& inverter : m_inverters)
+        {
+            const RttEstimator* rtt = m_ethernet.rttEstimator(inverter.IPAddress);
+            if (rtt != nullptr)
+                printf("IP [%s]: SRTT %.1fms - RTTVAR %.1fms - RTO %.1fms - Failures %d\n", inverter.IPAddress.c_str(),
+                       rtt->srtt().count() / 1000.0, rtt->rttvar().count() / 1000.0, rtt->rto().count() / 1000.0, rtt->failures());
+        }
+    }
+
+    m_prefetched = 0;
     m_cache.addInverterData(timestamp, m_inverters);
 
     return 0;
@@ -1380,7 +1269,7 @@ void Inverter::importDayData()
                 }
             }
 
-            m_exporterManager.exportDayData(m_inverters);
+            m_exporter.exportDayData(m_inverters);
         }
 
         //Goto previous day
@@ -1398,7 +1287,7 @@ void Inverter::importMonthData()
         m_archData.getMonthDataOffset(m_inverters); //Issues 115/130
         time_t arch_time = (0 == m_config.startdate) ? time(NULL) : m_config.startdate;
         struct tm arch_tm;
-        memcpy(&arch_tm, gmtime(&arch_time), sizeof(arch_tm));
+        arch_tm = gmtime_tm(arch_time);
 
         for (int count=0; count<m_config.archMonths; count++)
         {
@@ -1416,7 +1305,7 @@ void Inverter::importMonthData()
                 }
             }
 
-            m_exporterManager.exportMonthData(m_inverters);
+            m_exporter.exportMonthData(m_inverters);
 
             //Go to previous month
             if (--arch_tm.tm_mon < 0)
@@ -1476,7 +1365,7 @@ void Inverter::importEventData()
     if ((rc == E_OK) || (rc == E_EOF))
     {
         dt_range_csv = str(format("%d%02d-%s") % dt_utc.year() % static_cast<short>(dt_utc.month()) % dt_range_csv);
-        m_exporterManager.exportEventData(m_inverters, dt_range_csv);
+        m_exporter.exportEventData(m_inverters, dt_range_csv);
     }
 }
 
@@ -38,12 +38,13 @@ DISCLAIMER:
 
 #include "ArchData.h"
 #include "Cache.h"
-#include "ExporterManager.h"
+#include "Ethernet.h"
+#include "Exporter.h"
 #include "LiveData.h"
 #include "SBFNet.h"
+#include "sma/SmaRequestPlanner.h"
 
 struct Config;
-class Ethernet;
 class Socket;
 struct InverterData;
 class SbfSpot;
@@ -51,14 +52,31 @@ class SbfSpot;
 class Inverter
 {
 public:
-    Inverter(const Config& config, Ethernet& ethernet, Socket& import, SbfSpot& sbfSpot);
+    Inverter(const Config& config, Ethernet& ethernet, Socket& import, SbfSpot& sbfSpot, Exporter& exporter);
     ~Inverter();
 
+    /*
+     * Makes this instance a worker of InverterPool: it only polls the inverters
+     * at the given addresses, on a port of its own and in the session (AppSerial)
+     * set up by the pool.
+     */
+    void setWorker(const std::vector<std::string>& addresses);
+
+    // Durations of the phases of the last process(), in seconds
+    struct Timing
+    {
+        double logon = 0;
+        double spotData = 0;
+        double archiveData = 0;     // Day, month and event data
+    };
+    const Timing& timing() const { return m_timing; }
+
     E_SBFSPOT ethInitConnection();
     E_SBFSPOT logonSMAInverter(std::vector<InverterData>& inverters, long userGroup, const char *password);
     E_SBFSPOT logoffSMAInverter(const InverterData& inverter);
     E_SBFSPOT logoffMultigateDevices(const std::vector<InverterData>& inverters);
     E_SBFSPOT getDeviceList(std::vector<InverterData>& inverters, int multigateID);
+    // type can hold several dataset flags, these are requested in as few ranges as possible
     int getInverterData(std::vector<InverterData>& inverters, SmaInverterDataSet type);
 
     void exportConfig();
@@ -68,9 +86,34 @@ public:
 private:
     std::string discover();
 
+    // Request of the data plan, with the index of its inverter
+    struct PlannedRequest
+    {
+        size_t inverter = 0;
+        sma::SmaInverterRequest request;
+    };
+    E_SBFSPOT exchangeDataPlan(std::vector<InverterData>& inverters);
+
+    // Merged request rejected in this poll, by the serial of the inverter
+    struct RejectedMerge
+    {
+        unsigned long serial = 0;
+        uint16_t susyId = 0;
+        sma::SmaInverterRequest request;
+    };
+
+    // Pipelined spot data: all datasets of a stage are requested at once
+    void prefetchInverterData(uint32_t dataSets);
+    int getSpotData(SmaInverterDataSet type);
+
     int logOn();
     void logOff();
 
+    // KeepSession: stay logged on between the polls of the daemon
+    bool keepSession() const;
+    bool resumeSession();
+    void logOnAgain(const std::vector<size_t>& inverters);
+
     int importSpotData(std::time_t timestamp);
     void importDayData();
     void importMonthData();
@@ -83,12 +126,27 @@ private:
     Socket& m_import;
     SbfSpot& m_sbfSpot;
     Buffer  m_buffer;
+    std::vector<EthRequest> m_requests;
+    sma::SmaRequestPlanner m_planner;
+    std::vector<PlannedRequest> m_plan;
+    std::vector<PlannedRequest> m_retryPlan;
+    std::vector<sma::SmaInverterRequest> m_planned;
+    uint32_t m_failedDataSets = 0;  // of the last getInverterData() over Ethernet
+    std::vector<uint32_t> m_acceptedDataSets;   // per inverter, answered without error code
+    std::vector<RejectedMerge> m_rejectedMerges;
+    uint32_t m_prefetched = 0;
+    uint32_t m_prefetchFailed = 0;
+    std::time_t m_sessionStart = 0;     // Logon of the kept session, 0 if there is none
+    bool m_sessionResumed = false;
+    bool m_worker = false;
+    std::vector<std::string> m_addresses;   // of a worker, otherwise IP_Address of the config
+    Timing m_timing;
 
     std::vector<InverterData> m_inverters;
     ArchData m_archData;
     Cache m_cache;
     std::vector<DayStats>   m_dayStats;
 
-    ExporterManager m_exporterManager;
+    Exporter& m_exporter;
 };
 
@@ -0,0 +1,295 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#include "InverterDecoder.h"
+
+#include "Defines.h"
+#include "SBFspot.h"
+#include "TagDefs.h"
+#include "Types.h"
+#include "misc.h"
+#include "sma/SmaLri.h"
+
+#include <cstdio>
+#include <ctime>
+
+bool decodeInverterData(const PacketView& response, std::vector<InverterData>& inverters, SmaInverterDataSet type)
+{
+    const char *strWatt = "%-12s: %ld (W) %s";
+    const char *strVolt = "%-12s: %.2f (V) %s";
+    const char *strAmp = "%-12s: %.3f (A) %s";
+    const char *strkWh = "%-12s: %.3f (kWh) %s";
+    const char *strHour = "%-12s: %.3f (h) %s";
+
+    // Per phase (AC) or mode (Pmax) members, by descriptor index
+    static long InverterData::* const Pmax[] = { &InverterData::Pmax1, &InverterData::Pmax2, &InverterData::Pmax3 };
+    static long InverterData::* const Pac[] = { &InverterData::Pac1, &InverterData::Pac2, &InverterData::Pac3 };
+    static long InverterData::* const Uac[] = { &InverterData::Uac1, &InverterData::Uac2, &InverterData::Uac3 };
+    static long InverterData::* const Iac[] = { &InverterData::Iac1, &InverterData::Iac2, &InverterData::Iac3 };
+    static const char* const PmaxName[] = { "INV_PACMAX1", "INV_PACMAX2", "INV_PACMAX3" };
+    static const char* const PacName[] = { "SPOT_PAC1", "SPOT_PAC2", "SPOT_PAC3" };
+    static const char* const UacName[] = { "SPOT_UAC1", "SPOT_UAC2", "SPOT_UAC3" };
+    static const char* const IacName[] = { "SPOT_IAC1", "SPOT_IAC2", "SPOT_IAC3" };
+
+    // No room for the header
+    if (response.size() < 41)
+        return false;
+
+    const uint8_t* buf = response.data();
+
+    int inv = SbfSpot::getInverterIndexBySerial(inverters, get_short(buf + 15), get_long(buf + 17));
+    if (inv < 0)
+        return false;
+
+    InverterData& inverter = inverters[inv];
+    sma::LriDecoder decoder(buf + 41, response.size() - 41);
+    sma::LriRecord record;
+    while (decoder.next(record))
+    {
+        if (!record.descriptor)
+            continue;
+
+        const long value = (long)record.value;
+        const long long value64 = record.value;
+        time_t datetime = record.datetime;
+        const uint8_t index = record.descriptor->index;
+
+        switch (record.descriptor->field)
+        {
+        case sma::LriField::AcPowerTotal: //SPOT_PACTOT
+            //This function gives us the time when the inverter was switched off
+            inverter.SleepTime = datetime;
+            inverter.TotalPac = value;
+            if (DEBUG_NORMAL) printf(strWatt, "SPOT_PACTOT", value, ctime(&datetime));
+            break;
+
+        case sma::LriField::AcPowerMax: //INV_PACMAX1, INV_PACMAX2, INV_PACMAX3
+            inverter.*Pmax[index] = value;
+            if (DEBUG_NORMAL) printf(strWatt, PmaxName[index], value, ctime(&datetime));
+            break;
+
+        case sma::LriField::AcPower: //SPOT_PAC1, SPOT_PAC2, SPOT_PAC3
+            inverter.*Pac[index] = value;
+            if (DEBUG_NORMAL) printf(strWatt, PacName[index], value, ctime(&datetime));
+            break;
+
+        case sma::LriField::AcVoltage: //SPOT_UAC1, SPOT_UAC2, SPOT_UAC3
+            inverter.*Uac[index] = value;
+            if (DEBUG_NORMAL) printf(strVolt, UacName[index], record.scaled(), ctime(&datetime));
+            break;
+
+        case sma::LriField::AcCurrent: //SPOT_IAC1, SPOT_IAC2, SPOT_IAC3
+            inverter.*Iac[index] = value;
+            if (DEBUG_NORMAL) printf(strAmp, IacName[index], record.scaled(), ctime(&datetime));
+            break;
+
+        case sma::LriField::GridFrequency: //SPOT_FREQ
+            inverter.GridFreq = value;
+            if (DEBUG_NORMAL) printf("%-12s: %.2f (Hz) %s", "SPOT_FREQ", record.scaled(), ctime(&datetime));
+            break;
+
+        case sma::LriField::DcPower: //SPOT_PDC1 / SPOT_PDC2
+            if (record.cls == 1)   // MPP1
+            {
+                inverter.Pdc1 = value;
+                if (DEBUG_NORMAL) printf(strWatt, "SPOT_PDC1", value, ctime(&datetime));
+            }
+            if (record.cls == 2)   // MPP2
+            {
+                inverter.Pdc2 = value;
+                if (DEBUG_NORMAL) printf(strWatt, "SPOT_PDC2", value, ctime(&datetime));
+            }
+            break;
+
+        case sma::LriField::DcVoltage: //SPOT_UDC1 / SPOT_UDC2
+            if (record.cls == 1)
+            {
+                inverter.Udc1 = value;
+                if (DEBUG_NORMAL) printf(strVolt, "SPOT_UDC1", record.scaled(), ctime(&datetime));
+            }
+            if (record.cls == 2)
+            {
+                inverter.Udc2 = value;
+                if (DEBUG_NORMAL) printf(strVolt, "SPOT_UDC2", record.scaled(), ctime(&datetime));
+            }
+            break;
+
+        case sma::LriField::DcCurrent: //SPOT_IDC1 / SPOT_IDC2
+            if (record.cls == 1)
+            {
+                inverter.Idc1 = value;
+                if (DEBUG_NORMAL) printf(strAmp, "SPOT_IDC1", record.scaled(), ctime(&datetime));
+            }
+            if (record.cls == 2)
+            {
+                inverter.Idc2 = value;
+                if (DEBUG_NORMAL) printf(strAmp, "SPOT_IDC2", record.scaled(), ctime(&datetime));
+            }
+            break;
+
+        case sma::LriField::EnergyTotal: //SPOT_ETOTAL
+            //In case SPOT_ETODAY missing, this function gives us inverter time (eg: SUNNY TRIPOWER 6.0)
+            inverter.InverterDatetime = datetime;
+            inverter.ETotal = value64;
+            if (DEBUG_NORMAL) printf(strkWh, "SPOT_ETOTAL", tokWh(value64), ctime(&datetime));
+            break;
+
+        case sma::LriField::EnergyToday: //SPOT_ETODAY
+            //This function gives us the current inverter time
+            inverter.InverterDatetime = datetime;
+            inverter.EToday = value64;
+            if (DEBUG_NORMAL) printf(strkWh, "SPOT_ETODAY", tokWh(value64), ctime(&datetime));
+            break;
+
+        case sma::LriField::OperationTime: //SPOT_OPERTM
+            inverter.OperationTime = value64;
+            if (DEBUG_NORMAL) printf(strHour, "SPOT_OPERTM", toHour(value64), ctime(&datetime));
+            break;
+
+        case sma::LriField::FeedInTime: //SPOT_FEEDTM
+            inverter.FeedInTime = value64;
+            if (DEBUG_NORMAL) printf(strHour, "SPOT_FEEDTM", toHour(value64), ctime(&datetime));
+            break;
+
+        case sma::LriField::DeviceName: //INV_NAME
+            //This function gives us the time when the inverter was switched on
+            inverter.WakeupTime = datetime;
+            inverter.DeviceName = record.text();
+            if (DEBUG_NORMAL) printf("%-12s: '%s' %s", "INV_NAME", inverter.DeviceName.c_str(), ctime(&datetime));
+            break;
+
+        case sma::LriField::SoftwareVersion: //INV_SWVER
+            inverter.SWVersion = record.softwareVersion();
+            if (DEBUG_NORMAL) printf("%-12s: '%s' %s", "INV_SWVER", inverter.SWVersion.c_str(), ctime(&datetime));
+            break;
+
+        case sma::LriField::DeviceType: //INV_TYPE
+            if (const unsigned long attribute = record.selectedAttribute())
+            {
+                std::string devtype = tagdefs.getDesc(attribute);
+                if (!devtype.empty())
+                {
+                    inverter.DeviceType = devtype;
+                }
+                else
+                {
+                    inverter.DeviceType = "UNKNOWN TYPE";
+                    printf("Unknown Inverter Type. Report this issue at https://github.com/SBFspot/SBFspot/issues with following info:\n");
+                    printf("0x%08lX and Inverter Type=<Fill in the exact type> (e.g. SB1300TL-10)\n", attribute);
+                }
+            }
+            if (DEBUG_NORMAL) printf("%-12s: '%s' %s", "INV_TYPE", inverter.DeviceType.c_str(), ctime(&datetime));
+            break;
+
+        case sma::LriField::DeviceClass: //INV_CLASS
+            if (const unsigned long attribute = record.selectedAttribute())
+            {
+                inverter.DevClass = (DEVICECLASS)attribute;
+                std::string devclass = tagdefs.getDesc(attribute);
+                if (!devclass.empty())
+                {
+                    inverter.DeviceClass = devclass;
+                }
+                else
+                {
+                    inverter.DeviceClass = "UNKNOWN CLASS";
+                    printf("Unknown Device Class. Report this issue at https://github.com/SBFspot/SBFspot/issues with following info:\n");
+                    printf("0x%08lX and Device Class=...\n", attribute);
+                }
+            }
+            if (DEBUG_NORMAL) printf("%-12s: '%s' %s", "INV_CLASS", inverter.DeviceClass.c_str(), ctime(&datetime));
+            break;
+
+        case sma::LriField::DeviceStatus: //INV_STATUS
+            if (const uint32_t attribute = record.selectedAttribute())
+                inverter.DeviceStatus = attribute;
+            if (DEBUG_NORMAL) printf("%-12s: '%s' %s", "INV_STATUS", tagdefs.getDesc(inverter.DeviceStatus, "?").c_str(), ctime(&datetime));
+            break;
+
+        case sma::LriField::GridRelayStatus: //INV_GRIDRELAY
+            if (const uint32_t attribute = record.selectedAttribute())
+                inverter.GridRelayStatus = attribute;
+            if (DEBUG_NORMAL) printf("%-12s: '%s' %s", "INV_GRIDRELAY", tagdefs.getDesc(inverter.GridRelayStatus, "?").c_str(), ctime(&datetime));
+            break;
+
+        case sma::LriField::BatteryChargeStatus:
+            inverter.BatChaStt = value;
+            break;
+
+        case sma::LriField::BatteryCycles:
+            inverter.BatDiagCapacThrpCnt = value;
+            break;
+
+        case sma::LriField::BatteryAhIn:
+            inverter.BatDiagTotAhIn = value;
+            break;
+
+        case sma::LriField::BatteryAhOut:
+            inverter.BatDiagTotAhOut = value;
+            break;
+
+        case sma::LriField::BatteryTemperature:
+            inverter.BatTmpVal = value;
+            break;
+
+        case sma::LriField::BatteryVoltage:
+            inverter.BatVol = value;
+            break;
+
+        case sma::LriField::BatteryCurrent:
+            inverter.BatAmp = value;
+            break;
+
+        case sma::LriField::Temperature:
+            inverter.Temperature = value;
+            break;
+
+        case sma::LriField::MeteringPowerOut:
+            inverter.MeteringGridMsTotWOut = value;
+            continue;   // not flagged
+
+        case sma::LriField::MeteringPowerIn:
+            inverter.MeteringGridMsTotWIn = value;
+            continue;   // not flagged
+
+        case sma::LriField::None:
+            continue;
+        }
+
+        inverter.flags |= type;
+    }
+
+    return true;
+}
@@ -0,0 +1,214 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#include "InverterPool.h"
+
+#include "Config.h"
+#include "Defines.h"
+#include "misc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+static double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void DeferredExporter::exportConfig(const InverterData& inverterData)
+{
+    m_configs.push_back(inverterData);
+}
+
+void DeferredExporter::exportDayStats(const DayStats& dayStats)
+{
+    m_exports.push_back([dayStats](Exporter& exporter) { exporter.exportDayStats(dayStats); });
+}
+
+void DeferredExporter::exportSpotData(std::time_t /*timestamp*/, const std::vector<InverterData>& inverters)
+{
+    m_spotData.insert(m_spotData.end(), inverters.begin(), inverters.end());
+}
+
+void DeferredExporter::exportDayData(const std::vector<InverterData>& inverters)
+{
+    m_exports.push_back([inverters](Exporter& exporter) { exporter.exportDayData(inverters); });
+}
+
+void DeferredExporter::exportMonthData(const std::vector<InverterData>& inverters)
+{
+    m_exports.push_back([inverters](Exporter& exporter) { exporter.exportMonthData(inverters); });
+}
+
+void DeferredExporter::exportEventData(const std::vector<InverterData>& inverters, const std::string& dt_range_csv)
+{
+    m_exports.push_back([inverters, dt_range_csv](Exporter& exporter) { exporter.exportEventData(inverters, dt_range_csv); });
+}
+
+void DeferredExporter::replay(Exporter& exporter) const
+{
+    for (const auto& doExport : m_exports)
+        doExport(exporter);
+}
+
+void DeferredExporter::clear()
+{
+    m_configs.clear();
+    m_spotData.clear();
+    m_exports.clear();
+}
+
+InverterPool::Worker::Worker(const Config& config, const std::vector<std::string>& addresses)
+    : addresses(addresses),
+      import(config, ethernet),
+      inverter(config, ethernet, import, sbfSpot, exporter)
+{
+    inverter.setWorker(addresses);
+}
+
+InverterPool::InverterPool(const Config& config, Exporter& exporter)
+    : m_config(config),
+      m_exporter(exporter)
+{
+    // Consecutive addresses per worker, the first workers get one more if they don't divide evenly
+    const auto& addresses = config.ip_addresslist;
+    const size_t count = std::min(addresses.size(), (size_t)std::max(config.workers, 1));
+    for (size_t i = 0; i < count; ++i)
+    {
+        const std::vector<std::string> share(addresses.begin() + (i * addresses.size()) / count,
+                                             addresses.begin() + ((i + 1) * addresses.size()) / count);
+        m_workers.emplace_back(new Worker(config, share));
+    }
+
+    // One session ID for all workers, for as long as SBFspot runs. The workers
+    // only read it, a kept session would not survive a new one anyway.
+    srand(time(NULL));
+    AppSerial = 900000000 + ((rand() << 16) + rand()) % 100000000;
+    if (VERBOSE_NORMAL) printf("SUSyID: %d - SessionID: %lu (0x%08lX) - %u workers\n", AppSUSyID, AppSerial, AppSerial, (unsigned)m_workers.size());
+}
+
+InverterPool::~InverterPool()
+{
+}
+
+bool InverterPool::isEnabled(const Config& config)
+{
+    return (config.workers > 1) &&
+           (config.ConnectionType == CT_ETHERNET) &&
+           (config.ip_addresslist.size() > 1) &&
+           config.recordFile.empty() &&
+           config.replayFile.empty();
+}
+
+int InverterPool::process(std::time_t timestamp)
+{
+    const auto start = Clock::now();
+
+    std::vector<std::thread> threads;
+    threads.reserve(m_workers.size());
+    for (auto& worker : m_workers)
+    {
+        Worker* w = worker.get();
+        threads.emplace_back([w, timestamp]()
+        {
+            const auto workerStart = Clock::now();
+            w->rc = w->inverter.process(timestamp);
+            w->elapsed = secondsSince(workerStart);
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    // Merge the results into one export, like a single Inverter would do
+    const auto exportStart = Clock::now();
+    int rc = 0;
+    std::vector<InverterData> inverters;
+    for (const auto& worker : m_workers)
+    {
+        for (const auto& inverter : worker->exporter.configs())
+            m_exporter.exportConfig(inverter);
+        inverters.insert(inverters.end(), worker->exporter.spotData().begin(), worker->exporter.spotData().end());
+        if ((rc == 0) && (worker->rc != 0))
+            rc = worker->rc;
+    }
+
+    if (!inverters.empty())
+        m_exporter.exportSpotData(timestamp, inverters);
+
+    flush();
+    m_exporter.close();
+
+    if (VERBOSE_NORMAL) printTiming(secondsSince(exportStart), secondsSince(start));
+
+    return rc;
+}
+
+void InverterPool::reset()
+{
+    for (auto& worker : m_workers)
+        worker->inverter.reset();
+    flush();
+}
+
+// Archive data and day stats, worker by worker
+void InverterPool::flush()
+{
+    for (auto& worker : m_workers)
+    {
+        worker->exporter.replay(m_exporter);
+        worker->exporter.clear();
+    }
+}
+
+void InverterPool::printTiming(double exportTime, double totalTime) const
+{
+    for (size_t i = 0; i < m_workers.size(); ++i)
+    {
+        const Worker& worker = *m_workers[i];
+        const Inverter::Timing& timing = worker.inverter.timing();
+
+        std::string addresses;
+        for (const auto& ip : worker.addresses)
+            addresses += (addresses.empty() ? "" : ", ") + ip;
+
+        printf("Worker %u [%s]: logon %.3fs, spot data %.3fs, archive data %.3fs, total %.3fs%s\n",
+               (unsigned)(i + 1), addresses.c_str(), timing.logon, timing.spotData, timing.archiveData, worker.elapsed,
+               worker.rc != 0 ? " (failed)" : "");
+    }
+    printf("Export: %.3fs - Total: %.3fs\n", exportTime, totalTime);
+}
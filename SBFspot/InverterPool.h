@@ -0,0 +1,124 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#pragma once
+
+#include "osselect.h"
+
+#include "Ethernet.h"
+#include "Exporter.h"
+#include "Inverter.h"
+#include "SBFspot.h"
+#include "Socket.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct Config;
+
+/*
+ * Exporter of a worker: keeps the exports of its Inverter until the pool
+ * hands them to the real exporters on the main thread.
+ */
+class DeferredExporter : public Exporter
+{
+public:
+    using Exporter::exportDayData;
+    using Exporter::exportMonthData;
+
+    void exportConfig(const InverterData& inverterData) override;
+    void exportDayStats(const DayStats& dayStats) override;
+    void exportSpotData(std::time_t timestamp, const std::vector<InverterData>& inverters) override;
+    void exportDayData(const std::vector<InverterData>& inverters) override;
+    void exportMonthData(const std::vector<InverterData>& inverters) override;
+    void exportEventData(const std::vector<InverterData>& inverters, const std::string& dt_range_csv) override;
+
+    // Config and spot data, merged with those of the other workers by the pool
+    const std::vector<InverterData>& configs() const { return m_configs; }
+    const std::vector<InverterData>& spotData() const { return m_spotData; }
+
+    // Hands the other exports to exporter, in the order they were made
+    void replay(Exporter& exporter) const;
+    void clear();
+
+private:
+    std::vector<InverterData> m_configs;
+    std::vector<InverterData> m_spotData;
+    std::vector<std::function<void(Exporter&)>> m_exports;
+};
+
+/*
+ * Polls the inverters of IP_Address on several threads (Config::workers).
+ * Each worker has an Ethernet, SbfSpot and Inverter of its own and logs on
+ * to its share of the inverters from a port of its own. A Multigate and its
+ * devices share an address, so they stay with one worker. When all workers
+ * are done, their results are exported in one go on the calling thread.
+ */
+class InverterPool
+{
+public:
+    InverterPool(const Config& config, Exporter& exporter);
+    ~InverterPool();
+
+    // Workers > 1 on a Speedwire plant with several addresses, not recording or replaying
+    static bool isEnabled(const Config& config);
+
+    int process(std::time_t timestamp);
+    void reset();
+
+private:
+    struct Worker
+    {
+        Worker(const Config& config, const std::vector<std::string>& addresses);
+
+        std::vector<std::string> addresses;
+        Ethernet ethernet;
+        Socket import;
+        SbfSpot sbfSpot;
+        DeferredExporter exporter;
+        Inverter inverter;
+        int rc = 0;
+        double elapsed = 0;     // of the last process(), in seconds
+    };
+
+    void flush();
+    void printTiming(double exportTime, double totalTime) const;
+
+    const Config& m_config;
+    Exporter& m_exporter;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+};
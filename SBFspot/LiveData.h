@@ -55,6 +55,8 @@ struct LiveData {
 
     // Dynamic device specific members
     std::time_t timestamp = 0;  // [sec]
+    uint16_t milliseconds = 0;  // [ms] fraction of timestamp, sub-second polls only
+    bool fast = false;          // sample of a sub-second poll, see Config::fastInterval
 
     int32_t acPowerTotal = 0;   // [W]
     int32_t dcPowerTotal = 0;   // [W]
@@ -174,9 +174,17 @@ void MqttMsgPackExport::exportLiveData(const LiveData& liveData)
     packer.pack_uint8(0);
     // 2. Timestamp
     packer.pack_uint8(static_cast<uint8_t>(Property::Timestamp));
-    uint32_t t = htonl(liveData.timestamp);
-    packer.pack_ext(4, -1); // Timestamp type
-    packer.pack_ext_body((const char*)(&t), 4);
+    if (!liveData.fast) {
+        uint32_t t = htonl(liveData.timestamp);
+        packer.pack_ext(4, -1); // Timestamp type
+        packer.pack_ext_body((const char*)(&t), 4);
+    } else {
+        // Timestamp 64: nanoseconds in the upper 30 bits, seconds in the lower 34 bits
+        const uint64_t t64 = ((uint64_t)liveData.milliseconds * 1000000 << 34) | ((uint64_t)liveData.timestamp & 0x3FFFFFFFFULL);
+        const uint32_t t[2] = { htonl((uint32_t)(t64 >> 32)), htonl((uint32_t)t64) };
+        packer.pack_ext(8, -1); // Timestamp type
+        packer.pack_ext_body((const char*)t, 8);
+    }
     // 3. Power AC
     packer.pack_uint8(static_cast<uint8_t>(Property::Power));
     packer.pack(liveData.acPowerTotal);
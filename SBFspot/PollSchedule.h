@@ -0,0 +1,68 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#pragma once
+
+#include <chrono>
+
+/*
+ * Sub-second poll schedule on the monotonic clock. The ticks are at fixed
+ * offsets from the start, so the latency of the timer that wakes up the
+ * poller does not add up (drift correction), and wall clock adjustments do
+ * not shift them. Ticks that have passed unused are counted as overruns.
+ */
+class PollSchedule
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::chrono::milliseconds Duration;
+
+    explicit PollSchedule(Duration interval, Clock::time_point start = Clock::now());
+
+    // The first tick after now. Ticks missed since the previous one are overruns.
+    Clock::time_point next(Clock::time_point now = Clock::now());
+    // A tick was used up without polling, e.g. the previous poll was still running
+    void overrun() { ++m_overruns; }
+
+    Duration interval() const { return m_interval; }
+    unsigned long ticks() const { return m_tick; }
+    unsigned long overruns() const { return m_overruns; }
+
+private:
+    Duration m_interval;
+    Clock::time_point m_start;
+    unsigned long m_tick = 0;
+    unsigned long m_overruns = 0;
+};
@@ -0,0 +1,86 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#include "RttEstimator.h"
+
+#include <algorithm>
+
+RttEstimator::RttEstimator(Duration initialRto, Duration minRto, Duration maxRto) :
+    m_minRto(minRto),
+    m_maxRto(maxRto),
+    m_srtt(0),
+    m_rttvar(0),
+    m_rto(std::min(std::max(initialRto, minRto), maxRto))
+{
+}
+
+void RttEstimator::addSample(Duration rtt)
+{
+    if (m_samples == 0)
+    {
+        m_srtt = rtt;
+        m_rttvar = rtt / 2;
+    }
+    else
+    {
+        // RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT = 7/8 SRTT + 1/8 R
+        const Duration delta = (m_srtt > rtt) ? (m_srtt - rtt) : (rtt - m_srtt);
+        m_rttvar = (m_rttvar * 3 + delta) / 4;
+        m_srtt = (m_srtt * 7 + rtt) / 8;
+    }
+
+    // RTO = SRTT + 4 RTTVAR
+    m_rto = std::min(std::max(m_srtt + m_rttvar * 4, m_minRto), m_maxRto);
+    ++m_samples;
+    m_failures = 0;
+}
+
+void RttEstimator::addResponse()
+{
+    m_failures = 0;
+}
+
+void RttEstimator::addTimeout()
+{
+    ++m_failures;
+}
+
+RttEstimator::Duration RttEstimator::backoff(int retransmission) const
+{
+    Duration rto = m_rto;
+    for (int i = 0; (i < retransmission) && (rto < m_maxRto); i++)
+        rto *= 2;
+
+    return std::min(rto, m_maxRto);
+}
@@ -0,0 +1,80 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#pragma once
+
+#include <chrono>
+
+/*
+ * Smoothed round trip time and retransmission timeout of an inverter,
+ * estimated as in TCP (Jacobson/Karels, RFC 6298). Timed out requests do not
+ * change the estimate, they only count as failures until the next response.
+ */
+class RttEstimator
+{
+public:
+    typedef std::chrono::microseconds Duration;
+
+    explicit RttEstimator(Duration initialRto = std::chrono::seconds(1),
+                          Duration minRto = std::chrono::milliseconds(50),
+                          Duration maxRto = std::chrono::seconds(5));
+
+    // Round trip time of a request that was answered at the first attempt
+    void addSample(Duration rtt);
+    // A request was answered, but its round trip time is ambiguous (Karn)
+    void addResponse();
+    // A request was not answered, not even after retransmitting it
+    void addTimeout();
+
+    // Timeout for the n-th retransmission: RTO * 2^n, capped at maxRto
+    Duration backoff(int retransmission) const;
+
+    bool hasSamples() const { return m_samples > 0; }
+    unsigned long samples() const { return m_samples; }
+    int failures() const { return m_failures; }
+
+    Duration srtt() const { return m_srtt; }
+    Duration rttvar() const { return m_rttvar; }
+    Duration rto() const { return m_rto; }
+    Duration maxRto() const { return m_maxRto; }
+
+private:
+    Duration m_minRto;
+    Duration m_maxRto;
+    Duration m_srtt;
+    Duration m_rttvar;
+    Duration m_rto;
+    unsigned long m_samples = 0;
+    int m_failures = 0;
+};
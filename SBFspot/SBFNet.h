@@ -39,9 +39,34 @@ DISCLAIMER:
 
 #include "Types.h"
 
-extern uint16_t pcktID;
-extern int packetposition;
+/*
+ * Non-owning view on a received packet. Byte 0 is the dummy byte that aligns
+ * Ethernet packets with Bluetooth packets, so the offsets are the same as in
+ * Buffer::data(). The view is only valid as long as its storage is.
+ */
+class PacketView
+{
+public:
+    PacketView() = default;
+    PacketView(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    uint8_t operator[](size_t index) const { return m_data[index]; }
 
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+/*
+ * Encoder of SMAData2+ frames, also used to hold received packets. The write
+ * position and the packet ID counter are members, so any number of frames can
+ * be built at the same time, e.g. by one encoder per thread.
+ * Bluetooth frames are written unescaped. writePacketTrailer() checksums the
+ * L2 packet and escapes it including the checksum in one pass.
+ */
 class Buffer
 {
 public:
@@ -58,12 +83,27 @@ public:
     void writePacketHeader(const unsigned int control, const BluetoothAddress& bluetoothAddress);
     void writePacketLength();
     bool validateChecksum();
-    bool isCrcValid();
+
+    // Packet ID of the frame written last. writePacketHeader() starts each
+    // frame with the next one, counting from 1 to 0x7FFF.
+    uint16_t packetId() const { return m_packetId; }
+
+    // Advances the packet ID counter, for frames that are not written by writePacketHeader()
+    uint16_t nextPacketId();
 
     ByteBuffer& data();
+    const ByteBuffer& data() const;
 
 private:
+    // Escapes the Bluetooth bytes written since m_escapeStart
+    void escapePending();
+
     ByteBuffer m_data;
+    ByteBuffer m_raw;
+    int m_position = 0;
+    int m_escapeStart = -1;
+    int m_checksumStart = 0;
+    uint16_t m_packetId = 0;
 
     friend class Inverter;
 };
@@ -158,22 +158,17 @@ const ByteBuffer& SbfSpot::encodeLoginRequest(uint16_t susyId, uint32_t serial,
     if (ConnType == CT_BLUETOOTH)
     {
 #ifdef BLUETOOTH_FOUND
-        do
-        {
-            pcktID++;
-            now = time(NULL);
-            m_buffer.writePacketHeader(0x01, addr_unknown);
-            m_buffer.writePacket(0x0E, 0xA0, 0x0100, anySUSyID, anySerial);
-            m_buffer.writeLong(0xFFFD040C);
-            m_buffer.writeLong(userGroup);	// User / Installer
-            m_buffer.writeLong(0x00000384); // Timeout = 900sec ?
-            m_buffer.writeLong(now);
-            m_buffer.writeLong(0);
-            m_buffer.writeArray(pw, sizeof(pw));
-            m_buffer.writePacketTrailer();
-            m_buffer.writePacketLength();
-        }
-        while (!m_buffer.isCrcValid());
+        now = time(NULL);
+        m_buffer.writePacketHeader(0x01, addr_unknown);
+        m_buffer.writePacket(0x0E, 0xA0, 0x0100, anySUSyID, anySerial);
+        m_buffer.writeLong(0xFFFD040C);
+        m_buffer.writeLong(userGroup);	// User / Installer
+        m_buffer.writeLong(0x00000384); // Timeout = 900sec ?
+        m_buffer.writeLong(now);
+        m_buffer.writeLong(0);
+        m_buffer.writeArray(pw, sizeof(pw));
+        m_buffer.writePacketTrailer();
+        m_buffer.writePacketLength();
 #else
         if (DEBUG_NORMAL)
             std::cout << "Bluetooth not supported on this platform" << std::endl;
@@ -182,26 +177,21 @@ const ByteBuffer& SbfSpot::encodeLoginRequest(uint16_t susyId, uint32_t serial,
     }
     else    // CT_ETHERNET
     {
-        do
-        {
-            pcktID++;
-            now = time(NULL);
-            m_buffer.writePacketHeader(0x01, addr_unknown);
-            if (susyId != SID_SB240)
-                m_buffer.writePacket(0x0E, 0xA0, 0x0100, susyId, serial);
-            else
-                m_buffer.writePacket(0x0E, 0xE0, 0x0100, susyId, serial);
-
-            m_buffer.writeLong(0xFFFD040C);
-            m_buffer.writeLong(userGroup);	// User / Installer
-            m_buffer.writeLong(0x00000384); // Timeout = 900sec ?
-            m_buffer.writeLong(now);
-            m_buffer.writeLong(0);
-            m_buffer.writeArray(pw, sizeof(pw));
-            m_buffer.writePacketTrailer();
-            m_buffer.writePacketLength();
-        }
-        while (!m_buffer.isCrcValid());
+        now = time(NULL);
+        m_buffer.writePacketHeader(0x01, addr_unknown);
+        if (susyId != SID_SB240)
+            m_buffer.writePacket(0x0E, 0xA0, 0x0100, susyId, serial);
+        else
+            m_buffer.writePacket(0x0E, 0xE0, 0x0100, susyId, serial);
+
+        m_buffer.writeLong(0xFFFD040C);
+        m_buffer.writeLong(userGroup);	// User / Installer
+        m_buffer.writeLong(0x00000384); // Timeout = 900sec ?
+        m_buffer.writeLong(now);
+        m_buffer.writeLong(0);
+        m_buffer.writeArray(pw, sizeof(pw));
+        m_buffer.writePacketTrailer();
+        m_buffer.writePacketLength();
     }
 
     return m_buffer.data();
@@ -221,98 +211,140 @@ const ByteBuffer& SbfSpot::encodeLoginRequest(SmaUserGroup userGroup, const std:
         pw[idx] = encChar;
     auto now = time(NULL);
 
-    do
-    {
-        pcktID++;
-
-        m_buffer.writePacketHeader(0x01, addr_unknown);
-        m_buffer.writePacket(0x0E, 0xA0, 0x0100, 0xFFFF, 0xFFFFFFFF);
-        m_buffer.writeLong(0xFFFD040C);
-        m_buffer.writeLong(userGroup);	// User / Installer
-        m_buffer.writeLong(0x00000384); // Timeout = 900sec ?
-        m_buffer.writeLong(now);
-        m_buffer.writeLong(0);
-        m_buffer.writeArray(pw, sizeof(pw));
-        m_buffer.writePacketTrailer();
-        m_buffer.writePacketLength();
-    }
-    while (!m_buffer.isCrcValid());
+    m_buffer.writePacketHeader(0x01, addr_unknown);
+    m_buffer.writePacket(0x0E, 0xA0, 0x0100, 0xFFFF, 0xFFFFFFFF);
+    m_buffer.writeLong(0xFFFD040C);
+    m_buffer.writeLong(userGroup);	// User / Installer
+    m_buffer.writeLong(0x00000384); // Timeout = 900sec ?
+    m_buffer.writeLong(now);
+    m_buffer.writeLong(0);
+    m_buffer.writeArray(pw, sizeof(pw));
+    m_buffer.writePacketTrailer();
+    m_buffer.writePacketLength();
 
     return m_buffer.data();
 }
 
 const ByteBuffer& SbfSpot::encodeLogoutRequest()
 {
-    do
-    {
-        pcktID++;
-        m_buffer.writePacketHeader(0x01, addr_unknown);
-        m_buffer.writePacket(0x08, 0xA0, 0x0300, anySUSyID, anySerial);
-        m_buffer.writeLong(0xFFFD010E);
-        m_buffer.writeLong(0xFFFFFFFF);
-        m_buffer.writePacketTrailer();
-        m_buffer.writePacketLength();
-    }
-    while (!m_buffer.isCrcValid());
+    return encodeLogoutRequest(anySUSyID, anySerial);
+}
+
+const ByteBuffer& SbfSpot::encodeLogoutRequest(uint16_t susyId, uint32_t serial)
+{
+    m_buffer.writePacketHeader(0x01, addr_unknown);
+    if (susyId == SID_SB240)
+        m_buffer.writePacket(0x08, 0xE0, 0x0300, susyId, serial);
+    else
+        m_buffer.writePacket(0x08, 0xA0, 0x0300, susyId, serial);
+    m_buffer.writeLong(0xFFFD010E);
+    m_buffer.writeLong(0xFFFFFFFF);
+    m_buffer.writePacketTrailer();
+    m_buffer.writePacketLength();
 
     return m_buffer.data();
 }
 
 const ByteBuffer& SbfSpot::encodeDataRequest(uint16_t susyId, uint32_t serial, SmaInverterDataSet dataSet)
 {
-    auto request = sma::SmaInverterRequests::create(dataSet);
+    return encodeDataRequest(susyId, serial, sma::SmaInverterRequests::create(dataSet));
+}
+
+const ByteBuffer& SbfSpot::encodeDataRequest(uint16_t susyId, uint32_t serial, const sma::SmaInverterRequest& request)
+{
+    // Bluetooth frames are escaped and checksummed, so they can't be patched
+    if (!m_requestCache || (ConnType == CT_BLUETOOTH))
+        return buildDataRequest(susyId, serial, request);
 
-    do
+    // The session ID is the source serial of every frame
+    if (m_dataRequestsSession != AppSerial)
     {
-        pcktID++;
-        m_buffer.writePacketHeader(0x01, addr_unknown);
-        if (susyId == SID_SB240)
-            m_buffer.writePacket(0x09, 0xE0, 0, susyId, serial);
-        else
-            m_buffer.writePacket(0x09, 0xA0, 0, susyId, serial);
-        m_buffer.writeLong(request.command);
-        m_buffer.writeLong(request.first);
-        m_buffer.writeLong(request.last);
-        m_buffer.writePacketTrailer();
-        m_buffer.writePacketLength();
+        m_dataRequests.clear();
+        m_dataRequestsSession = AppSerial;
+    }
+
+    // The range follows from the dataset flags, merged or not
+    auto& frame = m_dataRequests[std::make_tuple(susyId, serial, request.dataSet)];
+    if (frame.empty())
+    {
+        frame = buildDataRequest(susyId, serial, request);
+        return frame;
     }
-    while (!m_buffer.isCrcValid());
+
+    // Nothing but the packet ID changes between two requests
+    const uint16_t packetId = m_buffer.nextPacketId() | 0x8000;
+    const size_t offset = sizeof(ethPacketHeaderL1) - 1 + offsetof(ethPacket, PacketID);
+    frame[offset] = packetId & 0xFF;
+    frame[offset + 1] = packetId >> 8;
+
+    return frame;
+}
+
+const ByteBuffer& SbfSpot::buildDataRequest(uint16_t susyId, uint32_t serial, const sma::SmaInverterRequest& request)
+{
+    m_buffer.writePacketHeader(0x01, addr_unknown);
+    if (susyId == SID_SB240)
+        m_buffer.writePacket(0x09, 0xE0, 0, susyId, serial);
+    else
+        m_buffer.writePacket(0x09, 0xA0, 0, susyId, serial);
+    m_buffer.writeLong(request.command);
+    m_buffer.writeLong(request.first);
+    m_buffer.writeLong(request.last);
+    m_buffer.writePacketTrailer();
+    m_buffer.writePacketLength();
 
     return m_buffer.data();
 }
 
 const ByteBuffer& SbfSpot::encodeHistoricDayDataRequest(uint16_t susyId, uint32_t serial, std::time_t from, std::time_t to, const BluetoothAddress& bluetoothAddress)
 {
-    do
-    {
-        pcktID++;
-        m_buffer.writePacketHeader(0x01, bluetoothAddress);
-        m_buffer.writePacket(0x09, 0xE0, 0, susyId, serial);
-        m_buffer.writeLong(0x70000200);
-        m_buffer.writeLong(from);
-        m_buffer.writeLong(to);
-        m_buffer.writePacketTrailer();
-        m_buffer.writePacketLength();
-    }
-    while (!m_buffer.isCrcValid());
+    m_buffer.writePacketHeader(0x01, bluetoothAddress);
+    m_buffer.writePacket(0x09, 0xE0, 0, susyId, serial);
+    m_buffer.writeLong(0x70000200);
+    m_buffer.writeLong(from);
+    m_buffer.writeLong(to);
+    m_buffer.writePacketTrailer();
+    m_buffer.writePacketLength();
 
     return m_buffer.data();
 }
 
 const ByteBuffer& SbfSpot::encodeHistoricMonthDataRequest(uint16_t susyId, uint32_t serial, std::time_t from, std::time_t to, const BluetoothAddress& bluetoothAddress)
 {
-    do
-    {
-        pcktID++;
-        m_buffer.writePacketHeader(0x01, bluetoothAddress);
-        m_buffer.writePacket(0x09, 0xE0, 0, susyId, serial);
-        m_buffer.writeLong(0x70200200);
-        m_buffer.writeLong(from);
-        m_buffer.writeLong(to);
-        m_buffer.writePacketTrailer();
-        m_buffer.writePacketLength();
-    }
-    while (!m_buffer.isCrcValid());
+    m_buffer.writePacketHeader(0x01, bluetoothAddress);
+    m_buffer.writePacket(0x09, 0xE0, 0, susyId, serial);
+    m_buffer.writeLong(0x70200200);
+    m_buffer.writeLong(from);
+    m_buffer.writeLong(to);
+    m_buffer.writePacketTrailer();
+    m_buffer.writePacketLength();
+
+    return m_buffer.data();
+}
+
+const ByteBuffer& SbfSpot::encodeEventDataRequest(uint16_t susyId, uint32_t serial, std::time_t from, std::time_t to, SmaUserGroup userGroup, const BluetoothAddress& bluetoothAddress)
+{
+    m_buffer.writePacketHeader(0x01, bluetoothAddress);
+    m_buffer.writePacket(0x09, 0xE0, 0, susyId, serial);
+    m_buffer.writeLong(userGroup == UG_USER ? 0x70100200 : 0x70120200);
+    m_buffer.writeLong(from);
+    m_buffer.writeLong(to);
+    m_buffer.writePacketTrailer();
+    m_buffer.writePacketLength();
+
+    return m_buffer.data();
+}
+
+const ByteBuffer& SbfSpot::encodeDeviceListRequest(uint16_t susyId, uint32_t serial)
+{
+    m_buffer.writePacketHeader(0x01, BluetoothAddress());
+    m_buffer.writePacket(0x09, 0xE0, 0, susyId, serial);
+    m_buffer.writeShort(0x0200);
+    m_buffer.writeShort(0xFFF5);
+    m_buffer.writeLong(0);
+    m_buffer.writeLong(0xFFFFFFFF);
+    m_buffer.writePacketTrailer();
+    m_buffer.writePacketLength();
 
     return m_buffer.data();
 }
@@ -34,11 +34,14 @@ DISCLAIMER:
 
 #pragma once
 
+#include <map>
 #include <set>
+#include <tuple>
 #include <vector>
 
 #include <SBFNet.h>
 #include <Types.h>
+#include <sma/SmaInverterRequests.h>
 #include <sma/SmaTypes.h>
 
 //Wellknown SUSyID's
@@ -73,13 +76,38 @@ public:
     const ByteBuffer& encodeLoginRequest(uint16_t susyId, uint32_t serial, SmaUserGroup userGroup, const std::string& password);
     const ByteBuffer& encodeLoginRequest(SmaUserGroup userGroup, const std::string& password);
     const ByteBuffer& encodeLogoutRequest();
+    const ByteBuffer& encodeLogoutRequest(uint16_t susyId, uint32_t serial);
     const ByteBuffer& encodeDataRequest(uint16_t susyId, uint32_t serial, SmaInverterDataSet dataSet);
+    const ByteBuffer& encodeDataRequest(uint16_t susyId, uint32_t serial, const sma::SmaInverterRequest& request);
     const ByteBuffer& encodeHistoricDayDataRequest(uint16_t susyId, uint32_t serial, std::time_t from, std::time_t to, const BluetoothAddress& bluetoothAddress);
     const ByteBuffer& encodeHistoricMonthDataRequest(uint16_t susyId, uint32_t serial, std::time_t from, std::time_t to, const BluetoothAddress& bluetoothAddress);
+    const ByteBuffer& encodeEventDataRequest(uint16_t susyId, uint32_t serial, std::time_t from, std::time_t to, SmaUserGroup userGroup, const BluetoothAddress& bluetoothAddress);
+    const ByteBuffer& encodeDeviceListRequest(uint16_t susyId, uint32_t serial);
+
+    /*
+     * Packet ID of the request encoded last, the response echoes it back.
+     * Each SbfSpot encodes with its own counter, so instances can be used
+     * on different threads. Requests to the same inverter should come from
+     * the same instance, or their packet IDs may collide.
+     */
+    uint16_t packetId() const { return m_buffer.packetId(); }
+
+    /*
+     * When enabled (default), encodeDataRequest() builds the Ethernet frame of
+     * each (inverter, dataset) once and afterwards only patches its packet ID.
+     */
+    void setRequestCache(bool enable) { m_requestCache = enable; m_dataRequests.clear(); }
 
 private:
+    const ByteBuffer& buildDataRequest(uint16_t susyId, uint32_t serial, const sma::SmaInverterRequest& request);
+
     Buffer  m_buffer;
     const ByteBuffer m_emptyBuffer;
+
+    // Data request frames by (SUSyID, serial, dataset flags), built for session AppSerial
+    bool m_requestCache = true;
+    std::map<std::tuple<uint16_t, uint32_t, SmaInverterDataSet>, ByteBuffer> m_dataRequests;
+    uint32_t m_dataRequestsSession = 0;
 };
 
 extern const char *IP_Inverter;
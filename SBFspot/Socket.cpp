@@ -77,6 +77,22 @@ E_SBFSPOT Socket::getPacket(Buffer& buffer, const BluetoothAddress& bluetoothAdd
     }
 }
 
+E_SBFSPOT Socket::getPacket(Buffer& buffer, const BluetoothAddress& bluetoothAddress, int wait4Command, uint32_t serial, uint16_t packetId)
+{
+    if (m_config.ConnectionType == CT_BLUETOOTH)
+        return getPacket(buffer, bluetoothAddress, wait4Command);
+
+    PacketView packet;
+    E_SBFSPOT rc = m_ethernet.ethGetPacket(packet, serial, packetId);
+    if (rc == E_OK)
+    {
+        buffer.clear();
+        buffer.data().assign(packet.data(), packet.data() + packet.size());
+    }
+
+    return rc;
+}
+
 int Socket::send(const ByteBuffer& buffer, const std::string& toIP)
 {
     if (m_config.ConnectionType == CT_BLUETOOTH)
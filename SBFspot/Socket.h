@@ -55,6 +55,8 @@ public:
 
     int close();
     E_SBFSPOT getPacket(Buffer& buffer, const BluetoothAddress& bluetoothAddress, int wait4Command);
+    // Ethernet only waits for the response of inverter 'serial' to request 'packetId'
+    E_SBFSPOT getPacket(Buffer& buffer, const BluetoothAddress& bluetoothAddress, int wait4Command, uint32_t serial, uint16_t packetId);
     int send(const ByteBuffer& buffer, const std::string& toIP);
 
 private:
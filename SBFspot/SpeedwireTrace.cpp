@@ -0,0 +1,187 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#include "SpeedwireTrace.h"
+
+#include <cstring>
+
+static const char TRACE_MAGIC[4] = { 'S', 'B', 'F', 'T' };
+static const uint16_t TRACE_VERSION = 1;
+static const size_t RECORD_HEADER_SIZE = 17;
+
+// Flush at least once a second, so a killed daemon leaves a usable trace
+static const uint64_t FLUSH_INTERVAL = 1000000;
+
+TraceWriter::~TraceWriter()
+{
+    close();
+}
+
+bool TraceWriter::open(const std::string& path)
+{
+    close();
+
+    m_file = fopen(path.c_str(), "wb");
+    if (!m_file)
+        return false;
+
+    uint8_t header[8];
+    memcpy(header, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    header[4] = TRACE_VERSION & 0xFF;
+    header[5] = TRACE_VERSION >> 8;
+    header[6] = 0;
+    header[7] = 0;
+    if (fwrite(header, sizeof(header), 1, m_file) != 1)
+    {
+        close();
+        return false;
+    }
+
+    m_start = std::chrono::steady_clock::now();
+    m_lastFlush = 0;
+    return true;
+}
+
+void TraceWriter::close()
+{
+    if (m_file)
+    {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+void TraceWriter::write(TraceRecord::Direction direction, uint32_t address, uint16_t port, const uint8_t* data, size_t size)
+{
+    if (!m_file)
+        return;
+
+    const uint64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+    if (size > 0xFFFF)
+        size = 0xFFFF;
+
+    uint8_t header[RECORD_HEADER_SIZE];
+    for (int i = 0; i < 8; i++)
+        header[i] = (timestamp >> (8 * i)) & 0xFF;
+    header[8] = direction;
+    memcpy(header + 9, &address, 4);    // Already in network byte order
+    header[13] = port & 0xFF;
+    header[14] = port >> 8;
+    header[15] = size & 0xFF;
+    header[16] = size >> 8;
+
+    fwrite(header, sizeof(header), 1, m_file);
+    fwrite(data, 1, size, m_file);
+
+    if (timestamp - m_lastFlush >= FLUSH_INTERVAL)
+    {
+        fflush(m_file);
+        m_lastFlush = timestamp;
+    }
+}
+
+TraceReader::~TraceReader()
+{
+    close();
+}
+
+bool TraceReader::open(const std::string& path, double speed)
+{
+    close();
+
+    m_file = fopen(path.c_str(), "rb");
+    if (!m_file)
+        return false;
+
+    uint8_t header[8];
+    if ((fread(header, sizeof(header), 1, m_file) != 1) || (memcmp(header, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) ||
+        ((header[4] | (header[5] << 8)) != TRACE_VERSION))
+    {
+        close();
+        return false;
+    }
+
+    m_speed = speed;
+    m_start = std::chrono::steady_clock::now();
+    m_hasNext = false;
+    return true;
+}
+
+void TraceReader::close()
+{
+    if (m_file)
+    {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+    m_hasNext = false;
+}
+
+const TraceRecord* TraceReader::peek(TraceRecord::Direction direction)
+{
+    while (!m_hasNext || (m_next.direction != direction))
+    {
+        if (!read(m_next))
+            return nullptr;
+        m_hasNext = true;
+    }
+
+    return &m_next;
+}
+
+std::chrono::steady_clock::time_point TraceReader::due(const TraceRecord& record) const
+{
+    if (m_speed <= 0)
+        return m_start;
+
+    return m_start + std::chrono::microseconds((int64_t)(record.timestamp / m_speed));
+}
+
+bool TraceReader::read(TraceRecord& record)
+{
+    uint8_t header[RECORD_HEADER_SIZE];
+    if (!m_file || (fread(header, sizeof(header), 1, m_file) != 1))
+        return false;
+
+    record.timestamp = 0;
+    for (int i = 0; i < 8; i++)
+        record.timestamp |= (uint64_t)header[i] << (8 * i);
+    record.direction = (TraceRecord::Direction)header[8];
+    memcpy(&record.address, header + 9, 4);
+    record.port = header[13] | (header[14] << 8);
+
+    const size_t size = header[15] | (header[16] << 8);
+    record.data.resize(size);
+    return (size == 0) || (fread(record.data.data(), 1, size, m_file) == size);
+}
@@ -0,0 +1,121 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/*
+ * Binary trace of Speedwire datagrams, used to record the traffic of a plant
+ * and to replay it later without the devices.
+ *
+ * File layout (little endian):
+ *   header  "SBFT", uint16 version, uint16 reserved
+ *   record  uint64 timestamp (us since start of recording, steady clock),
+ *           uint8 direction, uint8[4] IPv4 address of the peer,
+ *           uint16 port, uint16 length, length bytes of data
+ */
+struct TraceRecord
+{
+    enum Direction : uint8_t
+    {
+        Received = 0,
+        Sent = 1
+    };
+
+    uint64_t timestamp = 0;     // us since start of recording
+    Direction direction = Received;
+    uint32_t address = 0;       // IPv4 address of the peer (network byte order)
+    uint16_t port = 0;
+    std::vector<uint8_t> data;
+};
+
+class TraceWriter
+{
+public:
+    TraceWriter() = default;
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+    ~TraceWriter();
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_file != nullptr; }
+
+    void write(TraceRecord::Direction direction, uint32_t address, uint16_t port, const uint8_t* data, size_t size);
+
+private:
+    FILE* m_file = nullptr;
+    std::chrono::steady_clock::time_point m_start;
+    uint64_t m_lastFlush = 0;
+};
+
+class TraceReader
+{
+public:
+    TraceReader() = default;
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+    ~TraceReader();
+
+    /*
+     * Opens a trace for replay. A speed of 1 replays the datagrams at their
+     * original pace, 10 ten times faster, 0 as fast as possible. The replay
+     * clock starts now.
+     */
+    bool open(const std::string& path, double speed = 1.0);
+    void close();
+    bool isOpen() const { return m_file != nullptr; }
+
+    // Next record of the given direction, nullptr at the end of the trace.
+    // The record stays valid until pop() is called.
+    const TraceRecord* peek(TraceRecord::Direction direction);
+    void pop() { m_hasNext = false; }
+
+    // Time at which the record is due in the replay
+    std::chrono::steady_clock::time_point due(const TraceRecord& record) const;
+
+private:
+    bool read(TraceRecord& record);
+
+    FILE* m_file = nullptr;
+    double m_speed = 1.0;
+    std::chrono::steady_clock::time_point m_start;
+    TraceRecord m_next;
+    bool m_hasNext = false;
+};
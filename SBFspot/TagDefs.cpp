@@ -162,6 +162,13 @@ int TagDefs::readall(std::string path, std::string locale)
 	return READ_OK;
 }
 
+const TagDefs::TD& TagDefs::find(unsigned int tagID) const
+{
+	static const TD unknown;
+	const auto it = m_tagdefmap.find(tagID);
+	return (it != m_tagdefmap.end()) ? it->second : unknown;
+}
+
 std::string TagDefs::getDescForLRI(unsigned int LRI)
 {
 	LRI &= 0x00FFFF00;
@@ -72,15 +72,17 @@ private:
     void print_error(std::string msg, unsigned int line, std::string fpath);
     void addTag(unsigned int tagID, std::string tag, unsigned int lri, std::string desc);
 
-    std::string getTag(unsigned int tagID) { return m_tagdefmap[tagID].getTag(); }
-    unsigned int getLRI(unsigned int tagID) { return m_tagdefmap[tagID].getLRI(); }
+    // Lookups don't add unknown tags to the map, the workers of InverterPool read it concurrently
+    const TD& find(unsigned int tagID) const;
+    std::string getTag(unsigned int tagID) const { return find(tagID).getTag(); }
+    unsigned int getLRI(unsigned int tagID) const { return find(tagID).getLRI(); }
     std::map<unsigned int, TD>::size_type size(void) const { return m_tagdefmap.size(); }
 
 public:
 	int readall(std::string path, std::string locale);
     std::string getDescForLRI(unsigned int LRI);
-    std::string getDesc(unsigned int tagID) { return m_tagdefmap[tagID].getDesc(); }
-    std::string getDesc(unsigned int tagID, std::string _default) { return m_tagdefmap[tagID].getDesc().empty() ? _default : m_tagdefmap[tagID].getDesc(); }
+    std::string getDesc(unsigned int tagID) const { return find(tagID).getDesc(); }
+    std::string getDesc(unsigned int tagID, std::string _default) const { return find(tagID).getDesc().empty() ? _default : find(tagID).getDesc(); }
 };
 
 extern TagDefs tagdefs;
@@ -45,6 +45,8 @@ public:
     Timer(Config& config);
 
     bool isBright() const;
+    // The last time point was after sunset, the next one is at sunrise
+    bool isNight() const { return m_isEndOfDay; }
     std::time_t nextTimePoint(bool* isStartOfDay = nullptr);
 
 private:
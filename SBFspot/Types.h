@@ -177,6 +177,7 @@ struct InverterData
     //unsigned char BTAddress[6];
     BluetoothAddress BTAddress;
     std::string IPAddress;
+    bool unreachable = false;   // No answer over Speedwire, skipped until the next logon
     unsigned short SUSyID = 0;
     unsigned long serial = 0;
     unsigned char NetID = 0;
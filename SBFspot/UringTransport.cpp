@@ -0,0 +1,298 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#include "UringTransport.h"
+
+#include "Ethernet.h"
+
+#include <algorithm>
+#include <chrono>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+UringTransport::UringTransport(EthStats& stats) :
+    m_stats(stats)
+{
+    memset(&m_ring, 0, sizeof(m_ring));
+    m_ring.ring_fd = -1;
+}
+
+UringTransport::~UringTransport()
+{
+    close();
+}
+
+bool UringTransport::open(int fd, size_t bufferSize)
+{
+    close();
+
+    int rc = io_uring_queue_init(RING_ENTRIES, &m_ring, 0);
+    if (rc < 0)
+    {
+        m_ring.ring_fd = -1;
+        errno = -rc;
+        return false;
+    }
+
+    m_fd = fd;
+    m_bufferSize = bufferSize;
+    m_rxBuffers.resize(RX_BUFFERS);
+    m_ready.resize(RX_BUFFERS);
+    m_readyHead = 0;
+    m_readyCount = 0;
+
+    for (size_t i = 0; i < m_rxBuffers.size(); i++)
+    {
+        m_rxBuffers[i].data.reset(new uint8_t[bufferSize]);
+        post(i);
+    }
+    flush();
+
+    return true;
+}
+
+void UringTransport::close()
+{
+    if (m_fd == -1)
+        return;
+
+    // Cancels the posted receives
+    io_uring_queue_exit(&m_ring);
+    m_ring.ring_fd = -1;
+    m_fd = -1;
+    m_txMsgs = nullptr;
+    m_txPending = 0;
+}
+
+void UringTransport::flush()
+{
+    if (io_uring_sq_ready(&m_ring) == 0)
+        return;
+
+    m_stats.recvCalls++;
+    int rc = io_uring_submit(&m_ring);
+    if (rc < 0)
+        printf ("io_uring_submit() error : %s\n", strerror(-rc));
+}
+
+size_t UringTransport::send(struct mmsghdr* msgs, size_t count)
+{
+    m_txMsgs = msgs;
+    m_txPending = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        struct io_uring_sqe *sqe = getSqe();
+        if (!sqe)
+            break;
+
+        msgs[i].msg_len = 0;
+        io_uring_prep_sendmsg(sqe, m_fd, &msgs[i].msg_hdr, 0);
+        io_uring_sqe_set_data64(sqe, SEND_TAG | i);
+        ++m_txPending;
+    }
+
+    // A UDP send completes during the submission, so this is usually a single call
+    while (m_txPending > 0)
+    {
+        m_stats.sendCalls++;
+        int rc = io_uring_submit_and_wait(&m_ring, 1);
+        if ((rc < 0) && (rc != -EINTR))
+        {
+            printf ("io_uring_submit_and_wait() error : %s\n", strerror(-rc));
+            break;
+        }
+        reap();
+    }
+
+    // Late completions must not touch the messages anymore
+    m_txMsgs = nullptr;
+    m_txPending = 0;
+
+    size_t sent = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (msgs[i].msg_len > 0)
+            ++sent;
+    }
+
+    return sent;
+}
+
+bool UringTransport::wait(int timeoutMs)
+{
+    reap();
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (m_readyCount == 0)
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0)
+            break;
+
+        struct __kernel_timespec ts;
+        ts.tv_sec = remaining / 1000000000;
+        ts.tv_nsec = remaining % 1000000000;
+
+        // Submits the receive buffers posted since the last call as well
+        struct io_uring_cqe *cqe;
+        m_stats.waitCalls++;
+        int rc = io_uring_submit_and_wait_timeout(&m_ring, &cqe, 1, &ts, NULL);
+        if (rc == -ETIME)
+            break;
+        if ((rc < 0) && (rc != -EINTR))
+        {
+            printf ("io_uring_submit_and_wait_timeout() error : %s\n", strerror(-rc));
+            break;
+        }
+        reap();
+    }
+
+    return m_readyCount > 0;
+}
+
+int UringTransport::take(std::unique_ptr<uint8_t[]>& slot, struct sockaddr_in& from)
+{
+    int index = next();
+    if (index < 0)
+        return 0;
+
+    RxBuffer& buffer = m_rxBuffers[index];
+    std::swap(slot, buffer.data);
+    from = buffer.from;
+    int size = buffer.size;
+    post(index);
+
+    return size;
+}
+
+int UringTransport::take(uint8_t* buf, size_t size, struct sockaddr_in& from)
+{
+    int index = next();
+    if (index < 0)
+        return 0;
+
+    RxBuffer& buffer = m_rxBuffers[index];
+    size = std::min(size, (size_t)buffer.size);
+    memcpy(buf, buffer.data.get(), size);
+    from = buffer.from;
+    post(index);
+
+    return (int)size;
+}
+
+void UringTransport::post(size_t index)
+{
+    RxBuffer& buffer = m_rxBuffers[index];
+    buffer.size = 0;
+    buffer.iov.iov_base = buffer.data.get();
+    buffer.iov.iov_len = m_bufferSize;
+    memset(&buffer.msg, 0, sizeof(buffer.msg));
+    buffer.msg.msg_name = &buffer.from;
+    buffer.msg.msg_namelen = sizeof(buffer.from);
+    buffer.msg.msg_iov = &buffer.iov;
+    buffer.msg.msg_iovlen = 1;
+
+    struct io_uring_sqe *sqe = getSqe();
+    if (!sqe)
+        return;
+
+    io_uring_prep_recvmsg(sqe, m_fd, &buffer.msg, 0);
+    io_uring_sqe_set_data64(sqe, index);
+}
+
+void UringTransport::reap()
+{
+    struct io_uring_cqe *cqe;
+    while (io_uring_peek_cqe(&m_ring, &cqe) == 0)
+    {
+        const uint64_t data = io_uring_cqe_get_data64(cqe);
+        const int res = cqe->res;
+        io_uring_cqe_seen(&m_ring, cqe);
+
+        if (data & SEND_TAG)
+        {
+            if (res < 0)
+                printf ("sendmsg() error : %s\n", strerror(-res));
+            if (m_txMsgs)
+            {
+                m_txMsgs[data & ~SEND_TAG].msg_len = (res > 0) ? res : 0;
+                --m_txPending;
+            }
+        }
+        else if (res > 0)
+        {
+            m_rxBuffers[data].size = res;
+            m_ready[(m_readyHead + m_readyCount) % m_ready.size()] = (uint32_t)data;
+            ++m_readyCount;
+        }
+        else
+        {
+            // Error or empty datagram, the buffer goes right back
+            if (res < 0)
+                printf ("recvmsg() error : %s\n", strerror(-res));
+            post(data);
+        }
+    }
+}
+
+int UringTransport::next()
+{
+    reap();
+    if (m_readyCount == 0)
+        return -1;
+
+    int index = m_ready[m_readyHead];
+    m_readyHead = (m_readyHead + 1) % m_ready.size();
+    --m_readyCount;
+
+    return index;
+}
+
+struct io_uring_sqe* UringTransport::getSqe()
+{
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&m_ring);
+    if (!sqe)
+    {
+        // Submission queue is full, make room
+        m_stats.sendCalls++;
+        io_uring_submit(&m_ring);
+        sqe = io_uring_get_sqe(&m_ring);
+        if (!sqe)
+            printf ("io_uring_get_sqe() failed\n");
+    }
+
+    return sqe;
+}
@@ -0,0 +1,127 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <liburing.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+struct EthStats;
+
+/*
+ * io_uring backed datagram I/O of a UDP socket, an alternative to the
+ * epoll/sendmmsg/recvmmsg path of Ethernet (build with -DUSE_IO_URING=ON).
+ *
+ * A fixed pool of receive buffers is kept posted on the socket, so datagrams
+ * land in them without any receive call. A received buffer is handed over by
+ * swapping it with a buffer of the caller, which is then posted in its place.
+ * All datagrams of a send() go out with a single submission.
+ *
+ * The system calls are counted in the EthStats of the owning Ethernet.
+ * Nothing is allocated after open().
+ */
+class UringTransport
+{
+public:
+    explicit UringTransport(EthStats& stats);
+    ~UringTransport();
+
+    // Set up the ring for socket fd and post the receive buffers of bufferSize bytes.
+    // Returns false if io_uring is not available (errno is set).
+    bool open(int fd, size_t bufferSize);
+    void close();
+    bool isOpen() const { return m_fd != -1; }
+
+    // File descriptor of the ring, readable while a completion is queued
+    int ringFd() const { return m_ring.ring_fd; }
+
+    // Submits the receive buffers posted since the last call. Only needed
+    // before waiting on ringFd(), wait() and send() do that by themselves.
+    void flush();
+
+    // Sends all messages with one submission and waits until they are sent.
+    // msgs[i].msg_len is set to the number of bytes sent, 0 on error.
+    // Returns the number of messages sent.
+    size_t send(struct mmsghdr* msgs, size_t count);
+
+    // Waits up to timeoutMs for a datagram, true if one is ready
+    bool wait(int timeoutMs);
+
+    // Next received datagram, without blocking. Its buffer is swapped with slot
+    // (which must be bufferSize bytes too). Returns the size of the datagram or 0.
+    int take(std::unique_ptr<uint8_t[]>& slot, struct sockaddr_in& from);
+
+    // Same as above, but copies the datagram to buf
+    int take(uint8_t* buf, size_t size, struct sockaddr_in& from);
+
+private:
+    struct RxBuffer
+    {
+        std::unique_ptr<uint8_t[]> data;
+        struct sockaddr_in from;
+        struct iovec iov;
+        struct msghdr msg;
+        int size = 0;
+    };
+
+    void post(size_t index);
+    void reap();
+    int next();     // Index of the next received buffer or -1
+    struct io_uring_sqe* getSqe();
+
+    static const unsigned RING_ENTRIES = 256;
+    static const unsigned RX_BUFFERS = 64;
+    static const uint64_t SEND_TAG = 1ULL << 63;  // user_data of send completions
+
+    EthStats& m_stats;
+    struct io_uring m_ring;
+    int m_fd = -1;
+    size_t m_bufferSize = 0;
+    std::vector<RxBuffer> m_rxBuffers;
+
+    // Received buffers in order of completion (ring of RX_BUFFERS indices)
+    std::vector<uint32_t> m_ready;
+    size_t m_readyHead = 0;
+    size_t m_readyCount = 0;
+
+    // Messages of the running send()
+    struct mmsghdr* m_txMsgs = nullptr;
+    size_t m_txPending = 0;
+};
@@ -34,10 +34,13 @@ DISCLAIMER:
 
 #include "osselect.h"
 
+#include "Cache.h"
 #include "Config.h"
 #include "Ethernet.h"
+#include "ExporterManager.h"
 #include "Socket.h"
 #include "Inverter.h"
+#include "InverterPool.h"
 #include "SBFspot.h"
 #include "TagDefs.h"
 #include "Timer.h"
@@ -47,6 +50,25 @@ DISCLAIMER:
 
 using namespace boost;
 
+// Polls an Inverter or InverterPool, once or at each time point of the daemon
+template <typename Poller>
+static void run(const Config& config, Timer& timer, Poller& poller)
+{
+    do
+    {
+        bool isStartOfDay = false;
+        auto timePoint = timer.nextTimePoint(&isStartOfDay);
+        if (isStartOfDay)
+        {
+            poller.reset();
+        }
+        std::this_thread::sleep_until(std::chrono::system_clock::from_time_t(timePoint));
+
+        poller.process(timePoint);
+    }
+    while (config.command == Config::Command::RunDaemon);
+}
+
 int main(int argc, char **argv)
 {
 #if defined(WIN32)
@@ -97,23 +119,33 @@ int main(int argc, char **argv)
         return(2);
     }
 
-    Ethernet ethernet;
-    Socket import(config, ethernet);
-    SbfSpot sbfSpot;
-    Inverter inverter(config, ethernet, import, sbfSpot);
-    do
+    Cache cache;
+    ExporterManager exporterManager(config, cache);
+
+    if (InverterPool::isEnabled(config))
     {
-        bool isStartOfDay = false;
-        auto timePoint = timer.nextTimePoint(&isStartOfDay);
-        if (isStartOfDay)
+        InverterPool pool(config, exporterManager);
+        run(config, timer, pool);
+    }
+    else
+    {
+        Ethernet ethernet;
+        if (!config.recordFile.empty() && !ethernet.startRecording(config.recordFile))
         {
-            inverter.reset();
+            printf("Error creating trace file %s\n", config.recordFile.c_str());
+            return 1;
+        }
+        if (!config.replayFile.empty() && !ethernet.startReplay(config.replayFile, config.replaySpeed))
+        {
+            printf("Error opening trace file %s\n", config.replayFile.c_str());
+            return 1;
         }
-        std::this_thread::sleep_until(std::chrono::system_clock::from_time_t(timePoint));
 
-        inverter.process(timePoint);
+        Socket import(config, ethernet);
+        SbfSpot sbfSpot;
+        Inverter inverter(config, ethernet, import, sbfSpot, exporterManager);
+        run(config, timer, inverter);
     }
-    while (config.command == Config::Command::RunDaemon);
 
     if (VERBOSE_NORMAL) print_error(stdout, PROC_INFO, "Done.\n");
 
@@ -111,12 +111,33 @@ const char *delim2txt(const char delim)
     return "?";
 }
 
+struct tm localtime_tm(const time_t rawtime)
+{
+    struct tm tm_struct;
+#if defined(WIN32)
+    localtime_s(&tm_struct, &rawtime);
+#else
+    localtime_r(&rawtime, &tm_struct);
+#endif
+    return tm_struct;
+}
+
+struct tm gmtime_tm(const time_t rawtime)
+{
+    struct tm tm_struct;
+#if defined(WIN32)
+    gmtime_s(&tm_struct, &rawtime);
+#else
+    gmtime_r(&rawtime, &tm_struct);
+#endif
+    return tm_struct;
+}
+
 //print time as UTC time
 char *strfgmtime_t (const char *format, const time_t rawtime)
 {
-    static char buffer[256];
-    struct tm tm_struct;
-    memcpy(&tm_struct, gmtime(&rawtime), sizeof(tm_struct));
+    static thread_local char buffer[256];
+    struct tm tm_struct = gmtime_tm(rawtime);
     strftime(buffer, sizeof(buffer), format, &tm_struct);
     return buffer;
 }
@@ -124,17 +145,15 @@ char *strfgmtime_t (const char *format, const time_t rawtime)
 //Print time as local time
 char *strftime_t (const std::string& format, const time_t rawtime)
 {
-    static char buffer[256];
-    struct tm tm_struct;
-    memcpy(&tm_struct, localtime(&rawtime), sizeof(tm_struct));
+    static thread_local char buffer[256];
+    struct tm tm_struct = localtime_tm(rawtime);
     strftime(buffer, sizeof(buffer), format.c_str(), &tm_struct);
     return buffer;
 }
 
 char *strftime_t (char *buffer, size_t maxsize, const char *format, const time_t rawtime)
 {
-    struct tm tm_struct;
-    memcpy(&tm_struct, localtime(&rawtime), sizeof(tm_struct));
+    struct tm tm_struct = localtime_tm(rawtime);
     strftime(buffer, maxsize, format, &tm_struct);
     return buffer;
 }
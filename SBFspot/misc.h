@@ -58,6 +58,9 @@ const char *dp2txt(char dp);
 char *strftime_t (const std::string& format, const time_t rawtime);
 char *strftime_t (char *buffer, size_t maxsize, const char *format, const time_t rawtime);
 char *strfgmtime_t (const char *format, const time_t rawtime);
+// Thread safe localtime()/gmtime()
+struct tm localtime_tm(const time_t rawtime);
+struct tm gmtime_tm(const time_t rawtime);
 char *rtrim(char *txt);
 int get_tzOffset(/*OUT*/int *isDST);
 int CreatePath(const char *dir);
@@ -0,0 +1,187 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#include "SmaArchive.h"
+
+#include <Defines.h>
+#include <misc.h>
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace sma {
+
+namespace {
+
+const size_t recordSize = 12;
+
+// The records are little endian, on little endian hosts the byte swap is a plain load
+inline uint32_t loadLe32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+inline uint64_t loadLe64(const uint8_t* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+// Bit i set if the total of record i of the 4 records (48 bytes) at p is NaN.
+// The totals are at bytes 4, 16, 28 and 40, i.e. the dwords 1+2, 4+5, 7+8 and 10+11.
+inline unsigned nanMask4(const uint8_t* p)
+{
+    unsigned m;
+#if defined(__SSE2__)
+    const __m128i ones = _mm_set1_epi32(-1);
+    const unsigned m0 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)p), ones)));
+    const unsigned m1 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(p + 16)), ones)));
+    const unsigned m2 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(p + 32)), ones)));
+    m = m0 | (m1 << 4) | (m2 << 8);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    static const uint32_t bits[4] = { 1, 2, 4, 8 };
+    const uint32x4_t ones = vdupq_n_u32(0xFFFFFFFF);
+    const uint32x4_t weights = vld1q_u32(bits);
+    const unsigned m0 = vaddvq_u32(vandq_u32(vceqq_u32(vreinterpretq_u32_u8(vld1q_u8(p)), ones), weights));
+    const unsigned m1 = vaddvq_u32(vandq_u32(vceqq_u32(vreinterpretq_u32_u8(vld1q_u8(p + 16)), ones), weights));
+    const unsigned m2 = vaddvq_u32(vandq_u32(vceqq_u32(vreinterpretq_u32_u8(vld1q_u8(p + 32)), ones), weights));
+    m = m0 | (m1 << 4) | (m2 << 8);
+#else
+    m = 0;
+    for (int i = 0; i < 12; i++)
+        m |= (loadLe32(p + 4 * i) == 0xFFFFFFFF) ? (1u << i) : 0;
+#endif
+    // Both dwords of a total must be all ones
+    const unsigned both = m & (m >> 1);
+    return ((both >> 1) & 1) | (((both >> 4) & 1) << 1) | (((both >> 7) & 1) << 2) | (((both >> 10) & 1) << 3);
+}
+
+}
+
+void ArchiveRecords::clear()
+{
+    datetime.clear();
+    totalWh.clear();
+    valid.clear();
+}
+
+size_t decodeArchiveRecords(const uint8_t* data, size_t size, ArchiveRecords& records)
+{
+    // Same bound as before: a record must be followed by at least one byte of the end marker
+    const size_t count = (size > 0) ? (size - 1) / recordSize : 0;
+    const size_t first = records.size();
+    records.datetime.resize(first + count);
+    records.totalWh.resize(first + count);
+    records.valid.resize(first + count);
+
+    std::time_t* datetime = records.datetime.data() + first;
+    uint64_t* totalWh = records.totalWh.data() + first;
+    uint8_t* valid = records.valid.data() + first;
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint8_t* p = data + i * recordSize;
+        const unsigned nan = nanMask4(p);
+        for (size_t j = 0; j < 4; j++)
+        {
+            datetime[i + j] = (std::time_t)(int32_t)loadLe32(p + j * recordSize);
+            totalWh[i + j] = loadLe64(p + j * recordSize + 4);
+            valid[i + j] = ((nan >> j) & 1) ^ 1;
+        }
+    }
+
+    for (; i < count; i++)
+    {
+        const uint8_t* p = data + i * recordSize;
+        datetime[i] = (std::time_t)(int32_t)loadLe32(p);
+        totalWh[i] = loadLe64(p + 4);
+        valid[i] = (totalWh[i] != NaN_U64);
+    }
+
+    return count;
+}
+
+LocalDay::LocalDay(std::time_t midnight)
+{
+    struct tm day_tm;
+    day_tm = localtime_tm(midnight);
+    m_mday = day_tm.tm_mday;
+
+    day_tm.tm_hour = 0;
+    day_tm.tm_min = 0;
+    day_tm.tm_sec = 0;
+    day_tm.tm_isdst = -1;
+    m_begin = mktime(&day_tm);
+    day_tm.tm_mday++;
+    day_tm.tm_isdst = -1;
+    m_end = mktime(&day_tm);
+
+    // 23 or 25 hours, or a day that doesn't start at 00:00
+    m_dstTransition = (m_end - m_begin != 86400);
+}
+
+int LocalDay::slot(std::time_t datetime) const
+{
+    if (m_dstTransition)
+    {
+        struct tm timeinfo;
+        timeinfo = localtime_tm(datetime);
+        if (timeinfo.tm_mday != m_mday)
+            return -1;
+        return (timeinfo.tm_hour * 12) + (timeinfo.tm_min / 5);
+    }
+
+    if ((datetime < m_begin) || (datetime >= m_end))
+        return -1;
+
+    return (int)((datetime - m_begin) / 300);
+}
+
+}
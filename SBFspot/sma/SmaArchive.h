@@ -0,0 +1,103 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+// Batch decoding of DayData/MonthData response payloads.
+
+namespace sma {
+
+/**
+ * @brief Records of archive responses as struct of arrays.
+ *
+ * The raw totals are kept, also the NaN ones, because the importers use the
+ * previous total of a record whether or not it is valid.
+ */
+struct ArchiveRecords
+{
+    std::vector<std::time_t> datetime;
+    std::vector<uint64_t> totalWh;
+    std::vector<uint8_t> valid;     // 0 if totalWh is NaN
+
+    size_t size() const { return datetime.size(); }
+    void clear();
+};
+
+/**
+ * @brief Appends the complete 12 byte records (timestamp + total Wh) of a payload.
+ * @param data payload, records followed by the end marker
+ * @param size payload size in bytes
+ * @param records the records are appended
+ * @return number of appended records
+ */
+size_t decodeArchiveRecords(const uint8_t* data, size_t size, ArchiveRecords& records);
+
+/**
+ * @brief Maps timestamps to the 5 minute slots of one local day.
+ *
+ * localtime() is only called per timestamp on days with a DST transition,
+ * on all other days the slot follows from the seconds since local midnight.
+ */
+class LocalDay
+{
+public:
+    static const int slotsPerDay = 288;
+
+    /**
+     * @param midnight local midnight of the day, as returned by mktime()
+     */
+    explicit LocalDay(std::time_t midnight);
+
+    std::time_t begin() const { return m_begin; }
+    std::time_t end() const { return m_end; }
+
+    /**
+     * @return 5 minute slot of datetime, -1 if datetime is not on this day
+     */
+    int slot(std::time_t datetime) const;
+
+private:
+    std::time_t m_begin;
+    std::time_t m_end;
+    int m_mday;
+    bool m_dstTransition;
+};
+
+}
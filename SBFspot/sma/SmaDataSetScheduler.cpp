@@ -0,0 +1,151 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#include "SmaDataSetScheduler.h"
+
+#include <algorithm>
+
+#include <Config.h>
+#include <sma/SmaInverterRequests.h>
+
+namespace sma {
+
+std::vector<SmaDataSetScheduler::Tier> SmaDataSetScheduler::tiers(const Config& config) {
+    return {
+        { SpotACPower | SpotACVoltage | SpotACTotalPower | SpotGridFrequency, config.acInterval },
+        { SpotDCPower | SpotDCVoltage, config.dcInterval },
+        { DeviceStatus | EnergyProduction | OperationTime, config.statusInterval },
+        // Temperature is not answered by all inverter models. So, not part of any tier.
+        { TypeLabel | SoftwareVersion | MaxACPower, config.nameplateInterval },
+    };
+}
+
+SmaDataSetScheduler::SmaDataSetScheduler(const std::vector<Tier>& tiers) {
+    for (const auto& tier : tiers) {
+        m_dataSets |= tier.dataSets;
+        for (size_t bit = 0; bit < m_period.size(); ++bit) {
+            if (tier.dataSets & (1u << bit)) {
+                m_period[bit] = tier.period;
+            }
+        }
+    }
+}
+
+uint32_t SmaDataSetScheduler::due(std::time_t timestamp) const {
+    uint32_t dataSets = 0;
+    for (size_t bit = 0; bit < m_period.size(); ++bit) {
+        const uint32_t flag = 1u << bit;
+        if ((m_dataSets & flag) == 0) {
+            continue;
+        }
+
+        const std::time_t period = m_period[bit];
+        const std::time_t answered = m_answered[bit];
+        if ((period == 0) || (answered == 0) || (timestamp / period != answered / period)) {
+            dataSets |= flag;
+        }
+    }
+
+    return dataSets;
+}
+
+void SmaDataSetScheduler::answered(uint32_t dataSets, std::time_t timestamp) {
+    for (size_t bit = 0; bit < m_answered.size(); ++bit) {
+        if (dataSets & (1u << bit)) {
+            m_answered[bit] = timestamp;
+        }
+    }
+}
+
+void SmaDataSetScheduler::reset() {
+    m_answered.fill(0);
+}
+
+void SmaDataSetScheduler::fill(LiveData& liveData, const LiveData& cached, uint32_t dataSets) {
+    if (dataSets & SpotACTotalPower) {
+        liveData.acPowerTotal = cached.acPowerTotal;
+    }
+
+    for (size_t i = 0; i < liveData.ac.size(); ++i) {
+        if (dataSets & SpotACPower) {
+            liveData.ac[i].power = cached.ac[i].power;
+        }
+        if (dataSets & SpotACVoltage) {
+            liveData.ac[i].voltage = cached.ac[i].voltage;
+            liveData.ac[i].current = cached.ac[i].current;
+        }
+    }
+
+    if (dataSets & (SpotDCPower | SpotDCVoltage)) {
+        liveData.dc.resize(std::max(liveData.dc.size(), cached.dc.size()));
+    }
+
+    for (size_t i = 0; i < cached.dc.size(); ++i) {
+        if (dataSets & SpotDCPower) {
+            liveData.dc[i].power = cached.dc[i].power;
+        }
+        if (dataSets & SpotDCVoltage) {
+            liveData.dc[i].voltage = cached.dc[i].voltage;
+            liveData.dc[i].current = cached.dc[i].current;
+        }
+    }
+
+    if (dataSets & SpotDCPower) {
+        liveData.dcPowerTotal = cached.dcPowerTotal;
+    }
+
+    if (dataSets & EnergyProduction) {
+        liveData.energyExportToday = cached.energyExportToday;
+        liveData.energyExportTotal = cached.energyExportTotal;
+    }
+}
+
+void SmaDataSetScheduler::fill(InverterDataMap& dataMap, const InverterDataMap& cached, uint32_t dataSets) {
+    for (uint32_t flag = 1; flag != 0; flag <<= 1) {
+        if ((dataSets & flag) == 0) {
+            continue;
+        }
+
+        // LRIs are in bits 8-23, bits 0-7 select the class
+        const auto request = SmaInverterRequests::create(static_cast<SmaInverterDataSet>(flag));
+        const uint32_t first = request.first & 0x00FFFF00;
+        const uint32_t last = request.last & 0x00FFFF00;
+        for (auto it = cached.lower_bound(static_cast<LriDef>(first)); (it != cached.end()) && (static_cast<uint32_t>(it->first) <= last); ++it) {
+            dataMap.insert(*it);
+        }
+    }
+}
+
+} // namespace sma
@@ -0,0 +1,109 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+#include <LiveData.h>
+#include <Types.h>
+
+class Config;
+
+namespace sma {
+
+/**
+ * @brief Decides which live data sets are due in a poll. Every data set has
+ * a period of its own, e.g. the AC values every poll and the type label once
+ * a day. A data set is due once a new period has begun since it was last
+ * answered, so the periods stay aligned to multiples of themselves like the
+ * ArchiveInterval. Data sets that were not answered stay due.
+ *
+ * The values of the data sets that were not requested in a poll are taken
+ * from the last poll that answered them, see fill().
+ */
+class SmaDataSetScheduler {
+public:
+    // The data sets of sub-second polls, see Config::fastInterval
+    static const uint32_t fastDataSets = SpotACPower | SpotACTotalPower;
+
+    struct Tier {
+        uint32_t dataSets = 0;  // SmaInverterDataSet flags
+        uint32_t period = 0;    // [sec], 0: every poll
+    };
+
+    /**
+     * @brief The live data tiers with the periods of the config.
+     */
+    static std::vector<Tier> tiers(const Config& config);
+
+    explicit SmaDataSetScheduler(const std::vector<Tier>& tiers);
+
+    /**
+     * @brief All data sets of the tiers.
+     */
+    uint32_t dataSets() const { return m_dataSets; }
+
+    /**
+     * @brief The data sets due in the poll of the given timestamp.
+     */
+    uint32_t due(std::time_t timestamp) const;
+
+    /**
+     * @brief Learns that the data sets were answered in the poll of the given timestamp.
+     */
+    void answered(uint32_t dataSets, std::time_t timestamp);
+
+    /**
+     * @brief Makes all data sets due again, e.g. for a (re)discovered inverter.
+     */
+    void reset();
+
+    /**
+     * @brief Copies the values of the given data sets from a previous poll.
+     */
+    static void fill(LiveData& liveData, const LiveData& cached, uint32_t dataSets);
+    static void fill(InverterDataMap& dataMap, const InverterDataMap& cached, uint32_t dataSets);
+
+private:
+    uint32_t m_dataSets = 0;
+    std::array<uint32_t, 32> m_period {};       // by data set flag
+    std::array<std::time_t, 32> m_answered {};  // by data set flag, 0: never
+};
+
+} // namespace sma
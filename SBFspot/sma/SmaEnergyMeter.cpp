@@ -37,14 +37,74 @@ DISCLAIMER:
 #include "LiveData.h"
 #include "Logger.h"
 
-#include <SpeedwireSocketFactory.hpp>
+#include <cstring>
+
 #include <SpeedwireByteEncoding.hpp>
 #include <SpeedwireHeader.hpp>
 #include <SpeedwireEmeterProtocol.hpp>
-#include <ObisFilter.hpp>
 
 namespace sma {
 
+namespace {
+
+const size_t maxMeters = 64;
+
+struct SignedPower {
+    int32_t total = 0;
+    int32_t l1 = 0;
+    int32_t l2 = 0;
+    int32_t l3 = 0;
+};
+
+// The OBIS elements that contribute to LiveData
+bool isUsed(uint8_t index, uint8_t type) {
+    if (type == 4) {
+        switch (index) {
+        case  1: case  2: case 21: case 22: case 41: case 42: case 61: case 62:
+        case 31: case 32: case 51: case 52: case 71: case 72:
+            return true;
+        }
+    } else if (type == 8) {
+        return (index == 1) || (index == 2);
+    }
+    return false;
+}
+
+// obis points to the OBIS header (channel, index, type, tariff), followed by the big endian value
+void applyObisValue(const uint8_t* obis, LiveData& liveData, SignedPower& power) {
+    const uint8_t index = obis[1];
+    const uint8_t type = obis[2];
+
+    // ugly hack to calculate the signed power value
+    if (type == 4) {
+        uint32_t value = SpeedwireByteEncoding::getUint32BigEndian(obis + 4);
+        switch (index) {
+        case  1: power.total += value;  break;
+        case  2: power.total -= value;  break;
+        case 21: power.l1    += value;  break;
+        case 22: power.l1    -= value;  break;
+        case 41: power.l2    += value;  break;
+        case 42: power.l2    -= value;  break;
+        case 61: power.l3    += value;  break;
+        case 62: power.l3    -= value;  break;
+        case 31: liveData.ac.at(0).current = value/1000.0f; break;
+        case 32: liveData.ac.at(0).voltage = value/10.0f; break;
+        case 51: liveData.ac.at(1).current = value/1000.0f; break;
+        case 52: liveData.ac.at(1).voltage = value/10.0f; break;
+        case 71: liveData.ac.at(2).current = value/1000.0f; break;
+        case 72: liveData.ac.at(2).voltage = value/10.0f; break;
+        }
+    } else if (type == 8) {
+        uint64_t value = SpeedwireByteEncoding::getUint64BigEndian(obis + 4);
+        switch (index) {
+        case  1: liveData.energyImportTotal = value/3600;  break;
+        case  2: liveData.energyExportTotal = value/3600;  break;
+        }
+    }
+}
+
+}
+
 SmaEnergyMeter::SmaEnergyMeter() {
 }
 
@@ -55,78 +115,67 @@ LiveData SmaEnergyMeter::parsePacket(const char* data, uint16_t size)
 {
     // check if it is an sma emeter packet
     SpeedwireHeader speedwirePacket(data, size);
-    bool valid = speedwirePacket.checkHeader();
-    if (valid) {
-        uint16_t protocolID = speedwirePacket.getProtocolID();
-        auto offset = speedwirePacket.getPayloadOffset();
-
-        if (protocolID == SpeedwireHeader::sma_emeter_protocol_id) {
-            //printf("RECEIVED EMETER PACKET  time 0x%016llx\n", LocalHost::getTickCountInMs());
-            SpeedwireEmeterProtocol emeter(speedwirePacket);
-            uint32_t serial = emeter.getSerialNumber();
-            uint32_t timer = emeter.getTime();
-
-            // extract obis data from the emeter packet and pass each obis data element to the obis filter
-            int32_t signed_power_total = 0, signed_power_l1 = 0, signed_power_l2 = 0, signed_power_l3 = 0;
-            LiveData liveData(serial);
-            //liveData.ac.resize(3);
-            void* obis = emeter.getFirstObisElement();
-            while (obis != nullptr) {
-                auto channel = SpeedwireEmeterProtocol::getObisChannel(obis);
-                auto index = SpeedwireEmeterProtocol::getObisIndex(obis);
-                auto type = SpeedwireEmeterProtocol::getObisType(obis);
-                bool doLog = ((index%10) == 1) || ((index%10) == 2);
-                uint64_t value = (type == 4) ? SpeedwireEmeterProtocol::getObisValue4(obis) : SpeedwireEmeterProtocol::getObisValue8(obis);
-                LOG_IF_F(2, doLog, "OBIS %i:%i.%i.0: %llu", channel, index, type, value);
-
-                //emeter.printObisElement(obis, stderr);
-                // ugly hack to calculate the signed power value
-                if (SpeedwireEmeterProtocol::getObisType(obis) == 4) {
-                    uint32_t value = SpeedwireEmeterProtocol::getObisValue4(obis);
-                    switch (SpeedwireEmeterProtocol::getObisIndex(obis)) {
-                    case  1: signed_power_total += value;  break;
-                    case  2: signed_power_total -= value;  break;
-                    case 21: signed_power_l1    += value;  break;
-                    case 22: signed_power_l1    -= value;  break;
-                    case 41: signed_power_l2    += value;  break;
-                    case 42: signed_power_l2    -= value;  break;
-                    case 61: signed_power_l3    += value;  break;
-                    case 62: signed_power_l3    -= value;  break;
-                    case 31: liveData.ac.at(0).current = value/1000.0f; break;
-                    case 32: liveData.ac.at(0).voltage = value/10.0f; break;
-                    case 51: liveData.ac.at(1).current = value/1000.0f; break;
-                    case 52: liveData.ac.at(1).voltage = value/10.0f; break;
-                    case 71: liveData.ac.at(2).current = value/1000.0f; break;
-                    case 72: liveData.ac.at(2).voltage = value/10.0f; break;
-                    }
-                } else if (SpeedwireEmeterProtocol::getObisType(obis) == 8) {
-                    uint64_t value = SpeedwireEmeterProtocol::getObisValue8(obis);
-                    switch (SpeedwireEmeterProtocol::getObisIndex(obis)) {
-                    case  1: liveData.energyImportTotal = value/3600;  break;
-                    case  2: liveData.energyExportTotal = value/3600;  break;
-                    }
-                }
-                obis = emeter.getNextObisElement(obis);
+    if (!speedwirePacket.checkHeader() || (speedwirePacket.getProtocolID() != SpeedwireHeader::sma_emeter_protocol_id)) {
+        return LiveData(0);
+    }
+
+    //printf("RECEIVED EMETER PACKET  time 0x%016llx\n", LocalHost::getTickCountInMs());
+    SpeedwireEmeterProtocol emeter(speedwirePacket);
+    uint32_t serial = emeter.getSerialNumber();
+    const uint8_t* udp = reinterpret_cast<const uint8_t*>(data);
+
+    // Don't let datagrams with random serials grow the cache
+    if ((m_layouts.size() >= maxMeters) && !m_layouts.count(serial)) {
+        m_layouts.clear();
+    }
+
+    // Meters send the same layout every time, check the headers of the used elements only
+    ObisLayout& layout = m_layouts[serial];
+    bool valid = (layout.size == size) && !layout.fields.empty();
+    for (size_t i = 0; valid && (i < layout.fields.size()); ++i) {
+        valid = (memcmp(udp + layout.fields[i].offset, layout.fields[i].header, sizeof(ObisField::header)) == 0);
+    }
+
+    if (!valid) {
+        layout.size = size;
+        layout.fields.clear();
+        const void* obis = emeter.getFirstObisElement();
+        while (obis != nullptr) {
+            auto channel = SpeedwireEmeterProtocol::getObisChannel(obis);
+            auto index = SpeedwireEmeterProtocol::getObisIndex(obis);
+            auto type = SpeedwireEmeterProtocol::getObisType(obis);
+            bool doLog = ((index%10) == 1) || ((index%10) == 2);
+            uint64_t value = (type == 4) ? SpeedwireEmeterProtocol::getObisValue4(obis) : SpeedwireEmeterProtocol::getObisValue8(obis);
+            LOG_IF_F(2, doLog, "OBIS %i:%i.%i.0: %llu", channel, index, type, value);
+
+            //emeter.printObisElement(obis, stderr);
+            if (isUsed(index, type)) {
+                ObisField field;
+                field.offset = static_cast<const uint8_t*>(obis) - udp;
+                memcpy(field.header, obis, sizeof(field.header));
+                layout.fields.push_back(field);
             }
-            // send the calculated signed power values to the obis filter
-            auto obis_signed_power_total = ObisData::SignedActivePowerTotal.toByteArray();
-            auto obis_signed_power_L1    = ObisData::SignedActivePowerL1.toByteArray();
-            auto obis_signed_power_L2    = ObisData::SignedActivePowerL2.toByteArray();
-            auto obis_signed_power_L3    = ObisData::SignedActivePowerL3.toByteArray();
-            SpeedwireByteEncoding::setUint32BigEndian(&obis_signed_power_total[4], signed_power_total);
-            SpeedwireByteEncoding::setUint32BigEndian(&obis_signed_power_L1   [4], signed_power_l1);
-            SpeedwireByteEncoding::setUint32BigEndian(&obis_signed_power_L2   [4], signed_power_l2);
-            SpeedwireByteEncoding::setUint32BigEndian(&obis_signed_power_L3   [4], signed_power_l3);
-            liveData.acPowerTotal = signed_power_total/10;
-            liveData.ac.at(0).power = signed_power_l1/10;
-            liveData.ac.at(1).power = signed_power_l2/10;
-            liveData.ac.at(2).power = signed_power_l3/10;
-            liveData.timestamp = time(nullptr);
-            return liveData;
+            obis = emeter.getNextObisElement(obis);
         }
+        LOG_F(1, "Energy meter %u: %zu of the OBIS elements are used", serial, layout.fields.size());
+    }
+
+    // extract obis data from the emeter packet at the offsets of the layout
+    SignedPower power;
+    LiveData liveData(serial);
+    for (const auto& field : layout.fields) {
+        const uint8_t* obis = udp + field.offset;
+        LOG_IF_F(2, valid, "OBIS %i:%i.%i.0: %llu", obis[0], obis[1], obis[2],
+                 (unsigned long long)((obis[2] == 4) ? SpeedwireByteEncoding::getUint32BigEndian(obis + 4) : SpeedwireByteEncoding::getUint64BigEndian(obis + 4)));
+        applyObisValue(obis, liveData, power);
     }
 
-    return LiveData(0);
+    liveData.acPowerTotal = power.total/10;
+    liveData.ac.at(0).power = power.l1/10;
+    liveData.ac.at(1).power = power.l2/10;
+    liveData.ac.at(2).power = power.l3/10;
+    liveData.timestamp = time(nullptr);
+    return liveData;
 }
 
 }
@@ -35,6 +35,7 @@ DISCLAIMER:
 #pragma once
 
 #include <cstdint>
+#include <map>
 #include <vector>
 
 struct LiveData;
@@ -46,7 +47,28 @@ public:
     SmaEnergyMeter();
     ~SmaEnergyMeter();
 
-    static LiveData parsePacket(const char* data, uint16_t size);
+    /**
+     * @brief Parses an energy meter datagram.
+     *
+     * The offsets of the used OBIS elements are learned from the first datagram of
+     * each meter. Later datagrams of the same length with the same OBIS headers at
+     * these offsets are read directly, any other datagram is walked again.
+     * @return live data of the meter, serial 0 if it is no energy meter datagram
+     */
+    LiveData parsePacket(const char* data, uint16_t size);
+
+private:
+    struct ObisField {
+        uint16_t offset;    // of the OBIS header in the datagram
+        uint8_t header[4];  // channel, index, type, tariff
+    };
+
+    struct ObisLayout {
+        uint16_t size = 0;
+        std::vector<ObisField> fields;
+    };
+
+    std::map<uint32_t, ObisLayout> m_layouts;  // by serial
 };
 
-}
\ No newline at end of file
+}
@@ -34,20 +34,26 @@ DISCLAIMER:
 
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <ctime>
+#include <map>
 #include <set>
 
 #include <QObject>
 
 #include "LiveData.h"
+#include "RttEstimator.h"
 #include "SBFspot.h"
 #include "Types.h"
+#include "sma/SmaDataSetScheduler.h"
+#include "sma/SmaRequestPlanner.h"
+#include "sma/SmaSessionMonitor.h"
+#include "sma/SmaTypes.h"
 
 class Config;
 class Ethernet_qt;
 class Storage;
-class QNetworkDatagram;
 
 namespace sma {
 
@@ -70,14 +76,16 @@ public:
      * @param parent
      * @param config
      * @param ioDevice
+     * @param planner coalesces the data set requests
      * @param address
      * @param storage
      */
-    SmaInverter(QObject* parent, const Config& config, Ethernet_qt& ioDevice, uint32_t address, Storage* storage);
+    SmaInverter(QObject* parent, const Config& config, Ethernet_qt& ioDevice, SmaRequestPlanner& planner, uint32_t address, Storage* storage);
 
     // TODO: these are candidates for std::future and std::promise
     /**
-     * @brief Log in to inverter.
+     * @brief Log in to inverter. With KeepSession the session of the previous
+     * poll is resumed instead, until it is due for renewal.
      * @param timestamp for upcoming request
      */
     void login(std::time_t timestamp);
@@ -89,9 +97,18 @@ public:
 
     /**
      * @brief Request LiveData from inverter asynchronously. The result can be obtained via result().
+     * Only the data sets that are due are requested, the others are taken from the previous polls.
      */
     void requestLiveData();
 
+    /**
+     * @brief Request the fast data sets of a sub-second poll asynchronously, in the
+     * session of the previous poll. The result can be obtained via result().
+     * @param timestamp of the poll
+     * @param milliseconds fraction of timestamp
+     */
+    void requestFastData(std::time_t timestamp, uint16_t milliseconds);
+
     /**
      * @brief Request DayData from inverter asynchronously. The result can be obtained via result().
      * @param from timestamp to start from
@@ -112,6 +129,19 @@ public:
      */
     std::list<SmaResponse> result();
 
+    /**
+     * @brief True once all requests of the current poll are answered.
+     */
+    bool isComplete() const { return m_complete; }
+
+    /**
+     * @brief How long the current poll waits for this inverter, estimated from
+     * the time its previous polls of the same kind (live or sub-second) took,
+     * at most Config::pollTimeout. Polls with a login or archive requests get
+     * Config::pollTimeout.
+     */
+    RttEstimator::Duration deadline() const;
+
 signals:
     /**
      * @brief Notifies about the current inverter state.
@@ -126,16 +156,21 @@ private:
     void init();
 
     void resetPendingData();
-    void requestDataSet(SmaInverterDataSet dataSet);
+    void checkComplete();
+    RttEstimator* pollTime();
+    void requestDataSets(uint32_t dataSets);
+    void rejectMergedRequest(uint16_t packetId);
 
-    void onDatagram(const QNetworkDatagram& datagram);
+    void onPacket(const SmaPacketView& packet);
 
-    void decodeResponse(ByteBuffer& buffer, InverterDataMap& inverterDataMap, std::set<LriDef>& lris);
-    void decodeDayData(const ByteBuffer& buffer);
-    void decodeMonthData(const ByteBuffer& buffer);
+    void decodeResponse(const SmaPacketView& packet, InverterDataMap& inverterDataMap, std::set<LriDef>& lris);
+    void decodeDayData(const uint8_t* data, size_t size);
+    void decodeMonthData(const uint8_t* data, size_t size);
 
     const Config&   m_config;
     Ethernet_qt&    m_ioDevice;
+    SmaRequestPlanner& m_planner;
+    SmaDataSetScheduler m_scheduler;
     Storage*        m_storage = nullptr;
     SbfSpot         m_sbfSpot;
 
@@ -145,13 +180,30 @@ private:
     std::time_t m_lastSeen = 0;
 
     State m_state = State::Invalid;
-
+    std::time_t m_loginTime = 0;
+    SmaSessionMonitor m_session;    // KeepSession: is the session of the previous poll still known
+    std::vector<SmaInverterRequest> m_rejectedMerges;   // merged requests rejected in this poll
+
+    std::chrono::steady_clock::time_point m_requestTime;    // start of the current poll
+    bool m_requested = false;       // the requests of the current poll are sent
+    bool m_complete = false;        // and all of them are answered
+    int m_pendingArchiveRequests = 0;
+    bool m_archiveRequested = false;
+    // Time the polls take until complete, of resumed sessions without archive requests
+    RttEstimator m_livePollTime;
+    RttEstimator m_fastPollTime;
+
+    uint32_t            m_requestedDataSets = 0;    // live data sets due in this poll
     std::set<LriDef>    m_pendingLris;
+    std::map<uint16_t, SmaInverterRequest> m_pendingMergedRequests;    // by packet ID
     LiveData            m_pendingLiveData;
     std::vector<DayData>  m_pendingDayData;
     std::vector<MonthData> m_pendingMonthData;
     // TODO: just an experiment.
     InverterDataMap     m_pendingDataMap;
+    // Values of the last polls, for the data sets that are not due
+    LiveData            m_cachedLiveData;
+    InverterDataMap     m_cachedDataMap;
 
     friend class SmaManager;
 };
@@ -42,7 +42,7 @@ DISCLAIMER:
 namespace sma {
 
 struct SmaInverterRequest {
-    SmaInverterDataSet dataSet = SmaInverterDataSet::Invalid;
+    SmaInverterDataSet dataSet = SmaInverterDataSet::Invalid;   // Several flags for merged requests, see SmaRequestPlanner
     uint32_t command = 0;
     uint32_t first = 0;
     uint32_t last = 0;
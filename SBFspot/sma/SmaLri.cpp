@@ -0,0 +1,134 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#include "SmaLri.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <Defines.h>
+#include <misc.h>
+
+namespace sma {
+
+bool LriDecoder::next(LriRecord& record) {
+    if (m_position + 8 > m_size)
+        return false;
+
+    const uint8_t* data = m_data + m_position;
+    const uint32_t code = (uint32_t)get_long(data);
+    const LriDef lri = (LriDef)(code & 0x00FFFF00);
+    const LriDescriptor* descriptor = findLriDescriptor(lri);
+
+    if (m_recordSize == 0)
+        m_recordSize = descriptor ? descriptor->recordSize() : 12;
+
+    if (m_position + m_recordSize > m_size)
+        return false;
+
+    record.lri = lri;
+    record.cls = code & 0xFF;
+    record.dataType = code >> 24;
+    record.datetime = (std::time_t)get_long(data + 4);
+    record.descriptor = descriptor;
+    record.data = data;
+    record.size = m_recordSize;
+    record.value = 0;
+
+    if (descriptor)
+        record.format = descriptor->format;
+    else if (record.dataType == DT_STRING)
+        record.format = LriFormat::Text;
+    else if (record.dataType == DT_STATUS)
+        record.format = LriFormat::Status;
+    else
+        record.format = LriFormat::Dword;
+
+    const bool isSigned = descriptor ? descriptor->isSigned : (record.dataType == DT_SLONG);
+    if ((record.format == LriFormat::Qword) && (m_recordSize >= 16)) {
+        const int64_t value = get_longlong(data + 8);
+        if ((value != (int64_t)NaN_S64) && (value != (int64_t)NaN_U64))
+            record.value = value;
+    } else if ((record.format == LriFormat::Dword) && (m_recordSize >= 20)) {
+        const int32_t value = get_long(data + 16);
+        if ((value != (int32_t)NaN_S32) && (value != (int32_t)NaN_U32))
+            record.value = isSigned ? (int64_t)value : (int64_t)(uint32_t)value;
+    }
+
+    m_position += m_recordSize;
+    return true;
+}
+
+std::string LriRecord::text() const {
+    char text[33] = { 0 };
+    if (size > 8)
+        strncpy(text, (const char*)data + 8, std::min(sizeof(text) - 1, size - 8));
+    return text;
+}
+
+uint32_t LriRecord::selectedAttribute() const {
+    uint32_t selected = 0;
+    for (size_t idx = 8; idx + 4 <= size; idx += 4) {
+        const uint32_t attribute = ((uint32_t)get_long(data + idx)) & 0x00FFFFFF;
+        if (attribute == 0xFFFFFE)
+            break;	//End of attributes
+        if (data[idx + 3] == 1)
+            selected = attribute;
+    }
+    return selected;
+}
+
+std::string LriRecord::softwareVersion() const {
+    if (size < 28)
+        return {};
+
+    const uint8_t Vtype = data[24];
+    const uint8_t Vbuild = data[25];
+    const uint8_t Vminor = data[26];
+    const uint8_t Vmajor = data[27];
+
+    char ReleaseType[4];
+    if (Vtype > 5)
+        snprintf(ReleaseType, sizeof(ReleaseType), "%d", Vtype);
+    else
+        snprintf(ReleaseType, sizeof(ReleaseType), "%c", "NEABRS"[Vtype]); //NOREV-EXPERIMENTAL-ALPHA-BETA-RELEASE-SPECIAL
+
+    //Vmajor and Vminor = 0x12 should be printed as '12' and not '18' (BCD)
+    char swVersion[16];
+    snprintf(swVersion, sizeof(swVersion), "%c%c.%c%c.%02d.%s", '0'+(Vmajor >> 4), '0'+(Vmajor & 0x0F), '0'+(Vminor >> 4), '0'+(Vminor & 0x0F), Vbuild, ReleaseType);
+    return swVersion;
+}
+
+} // namespace sma
@@ -0,0 +1,235 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <iterator>
+#include <string>
+
+#include <Types.h>
+
+namespace sma {
+
+enum class LriFormat : uint8_t {
+    Dword,      // 28 byte record, value at offset 16
+    Qword,      // 16 byte record, value at offset 8
+    Text,       // 40 byte record, zero terminated string at offset 8
+    Status,     // 40 byte record, attribute list at offset 8
+    Version     // 40 byte record, BCD software version at offset 24
+};
+
+/**
+ * @brief Destination of a decoded LRI value. Both InverterData (SBFspot) and
+ * LiveData (SBFspot_qt) map these to their own members.
+ */
+enum class LriField : uint8_t {
+    None,
+    AcPowerTotal,
+    AcPowerMax,         // index: 0 = Ok, 1 = Warning, 2 = Fault mode
+    AcPower,            // index: phase
+    AcVoltage,          // index: phase
+    AcCurrent,          // index: phase
+    GridFrequency,
+    DcPower,            // cls: MPP tracker
+    DcVoltage,          // cls: MPP tracker
+    DcCurrent,          // cls: MPP tracker
+    EnergyTotal,
+    EnergyToday,
+    OperationTime,
+    FeedInTime,
+    DeviceName,
+    SoftwareVersion,
+    DeviceType,
+    DeviceClass,
+    DeviceStatus,
+    GridRelayStatus,
+    BatteryChargeStatus,
+    BatteryCycles,
+    BatteryAhIn,
+    BatteryAhOut,
+    BatteryTemperature,
+    BatteryVoltage,
+    BatteryCurrent,
+    Temperature,
+    MeteringPowerOut,
+    MeteringPowerIn
+};
+
+struct LriDescriptor {
+    LriDef lri;
+    LriFormat format;
+    bool isSigned;      // SLONG (0x40) or ULONG (0x00) data type
+    float scale;        // raw value * scale = value in W, V, A, Hz, Wh, s or °C
+    LriField field;
+    uint8_t index;
+
+    constexpr uint8_t recordSize() const {
+        return (format == LriFormat::Dword) ? 28 : (format == LriFormat::Qword) ? 16 : 40;
+    }
+};
+
+/**
+ * @brief All LRIs decoded by SBFspot, sorted by LRI.
+ */
+constexpr LriDescriptor lriDescriptors[] = {
+    { OperationHealth,          LriFormat::Status,  false, 1.0f,    LriField::DeviceStatus,         0 },
+    { CoolsysTmpNom,            LriFormat::Dword,   true,  0.01f,   LriField::Temperature,          0 },
+    { DcMsWatt,                 LriFormat::Dword,   true,  1.0f,    LriField::DcPower,              0 },
+    { MeteringTotWhOut,         LriFormat::Qword,   false, 1.0f,    LriField::EnergyTotal,          0 },
+    { MeteringDyWhOut,          LriFormat::Qword,   false, 1.0f,    LriField::EnergyToday,          0 },
+    { GridMsTotW,               LriFormat::Dword,   true,  1.0f,    LriField::AcPowerTotal,         0 },
+    { BatChaStt,                LriFormat::Dword,   false, 1.0f,    LriField::BatteryChargeStatus,  0 },
+    { OperationHealthSttOk,     LriFormat::Dword,   false, 1.0f,    LriField::AcPowerMax,           0 },
+    { OperationHealthSttWrn,    LriFormat::Dword,   false, 1.0f,    LriField::AcPowerMax,           1 },
+    { OperationHealthSttAlm,    LriFormat::Dword,   false, 1.0f,    LriField::AcPowerMax,           2 },
+    { OperationGriSwStt,        LriFormat::Status,  false, 1.0f,    LriField::GridRelayStatus,      0 },
+    { DcMsVol,                  LriFormat::Dword,   true,  0.01f,   LriField::DcVoltage,            0 },
+    { DcMsAmp,                  LriFormat::Dword,   true,  0.001f,  LriField::DcCurrent,            0 },
+    { MeteringTotOpTms,         LriFormat::Qword,   false, 1.0f,    LriField::OperationTime,        0 },
+    { MeteringTotFeedTms,       LriFormat::Qword,   false, 1.0f,    LriField::FeedInTime,           0 },
+    { MeteringGridMsTotWOut,    LriFormat::Dword,   true,  1.0f,    LriField::MeteringPowerOut,     0 },
+    { MeteringGridMsTotWIn,     LriFormat::Dword,   true,  1.0f,    LriField::MeteringPowerIn,      0 },
+    { GridMsWphsA,              LriFormat::Dword,   true,  1.0f,    LriField::AcPower,              0 },
+    { GridMsWphsB,              LriFormat::Dword,   true,  1.0f,    LriField::AcPower,              1 },
+    { GridMsWphsC,              LriFormat::Dword,   true,  1.0f,    LriField::AcPower,              2 },
+    { GridMsPhVphsA,            LriFormat::Dword,   false, 0.01f,   LriField::AcVoltage,            0 },
+    { GridMsPhVphsB,            LriFormat::Dword,   false, 0.01f,   LriField::AcVoltage,            1 },
+    { GridMsPhVphsC,            LriFormat::Dword,   false, 0.01f,   LriField::AcVoltage,            2 },
+    { GridMsAphsA_1,            LriFormat::Dword,   false, 0.001f,  LriField::AcCurrent,            0 },
+    { GridMsAphsB_1,            LriFormat::Dword,   false, 0.001f,  LriField::AcCurrent,            1 },
+    { GridMsAphsC_1,            LriFormat::Dword,   false, 0.001f,  LriField::AcCurrent,            2 },
+    { GridMsAphsA,              LriFormat::Dword,   false, 0.001f,  LriField::AcCurrent,            0 },
+    { GridMsAphsB,              LriFormat::Dword,   false, 0.001f,  LriField::AcCurrent,            1 },
+    { GridMsAphsC,              LriFormat::Dword,   false, 0.001f,  LriField::AcCurrent,            2 },
+    { GridMsHz,                 LriFormat::Dword,   false, 0.01f,   LriField::GridFrequency,        0 },
+    { BatDiagCapacThrpCnt,      LriFormat::Dword,   true,  1.0f,    LriField::BatteryCycles,        0 },
+    { BatDiagTotAhIn,           LriFormat::Dword,   false, 1.0f,    LriField::BatteryAhIn,          0 },
+    { BatDiagTotAhOut,          LriFormat::Dword,   false, 1.0f,    LriField::BatteryAhOut,         0 },
+    { BatTmpVal,                LriFormat::Dword,   true,  0.1f,    LriField::BatteryTemperature,   0 },
+    { BatVol,                   LriFormat::Dword,   true,  0.01f,   LriField::BatteryVoltage,       0 },
+    { BatAmp,                   LriFormat::Dword,   true,  0.001f,  LriField::BatteryCurrent,       0 },
+    { NameplateLocation,        LriFormat::Text,    false, 1.0f,    LriField::DeviceName,           0 },
+    { NameplateMainModel,       LriFormat::Status,  false, 1.0f,    LriField::DeviceClass,          0 },
+    { NameplateModel,           LriFormat::Status,  false, 1.0f,    LriField::DeviceType,           0 },
+    { NameplatePkgRev,          LriFormat::Version, false, 1.0f,    LriField::SoftwareVersion,      0 },
+};
+
+constexpr bool isSorted(const LriDescriptor* first, const LriDescriptor* last) {
+    for (auto it = first + 1; it < last; ++it) {
+        if ((it - 1)->lri >= it->lri)
+            return false;
+    }
+    return true;
+}
+
+static_assert(isSorted(std::begin(lriDescriptors), std::end(lriDescriptors)), "lriDescriptors must be sorted by LRI");
+
+/**
+ * @brief Look up the descriptor of an LRI.
+ * @return nullptr if SBFspot does not decode the LRI.
+ */
+constexpr const LriDescriptor* findLriDescriptor(LriDef lri) {
+    size_t first = 0;
+    size_t last = sizeof(lriDescriptors) / sizeof(lriDescriptors[0]);
+    while (first < last) {
+        const size_t mid = (first + last) / 2;
+        if (lriDescriptors[mid].lri < lri)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+
+    return ((first < sizeof(lriDescriptors) / sizeof(lriDescriptors[0])) && (lriDescriptors[first].lri == lri)) ? &lriDescriptors[first] : nullptr;
+}
+
+static_assert(findLriDescriptor(GridMsHz)->field == LriField::GridFrequency, "findLriDescriptor() is broken");
+static_assert(findLriDescriptor(InverterWLim) == nullptr, "findLriDescriptor() is broken");
+
+struct LriRecord {
+    LriDef lri = LriDef(0);
+    uint8_t cls = 0;
+    uint8_t dataType = 0;
+    std::time_t datetime = 0;
+    const LriDescriptor* descriptor = nullptr;  // nullptr for unknown LRIs
+    LriFormat format = LriFormat::Dword;
+    int64_t value = 0;                          // Dword and Qword records, 0 for NaN
+    const uint8_t* data = nullptr;              // Start of the record
+    size_t size = 0;
+
+    float scaled() const { return descriptor ? value * descriptor->scale : value; }
+
+    // Text records
+    std::string text() const;
+
+    // Status records: the last attribute tagged as selected, or 0
+    uint32_t selectedAttribute() const;
+
+    // Version records, e.g. "03.01.05.R"
+    std::string softwareVersion() const;
+};
+
+/**
+ * @brief Walks the records of an LRI response in one pass.
+ *
+ * All records of a response have the same size, which is taken from the
+ * descriptor of the first record. Unknown LRIs are decoded by their data type,
+ * with a record size of 12 if they come first.
+ * Both the signed and the unsigned NaN of a value's width are decoded as 0,
+ * devices don't always send the one that matches the data type.
+ */
+class LriDecoder {
+public:
+    /**
+     * @param data first record, i.e. behind the first/last LRI of the response
+     * @param size bytes from data to the end of the packet
+     */
+    LriDecoder(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    /**
+     * @brief Decodes the next record.
+     * @return false if there is no complete record left.
+     */
+    bool next(LriRecord& record);
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_position = 0;
+    size_t m_recordSize = 0;
+};
+
+} // namespace sma
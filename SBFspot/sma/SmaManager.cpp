@@ -34,8 +34,9 @@ DISCLAIMER:
 
 #include "SmaManager.h"
 
+#include <algorithm>
+
 #include <QByteArray>
-#include <QNetworkDatagram>
 #include <QTimer>
 #include <QtConcurrent>
 
@@ -57,20 +58,35 @@ SmaManager::SmaManager(Config& config, Exporter& exporter, Storage* storage) :
     m_ethernet(*this),
     m_discoverTimer(startTimer(1*60*1000)),   // discover every 60 seconds
     m_requestStrategy(config),
-    m_timeComputation(config)
+    m_timeComputation(config),
+    m_fastSchedule(std::chrono::milliseconds(config.fastInterval))
 {   
     srand(time(nullptr));
     AppSerial = 900000000 + ((rand() << 16) + rand()) % 100000000;
 
+    LOG_IF_S(ERROR, !config.recordFile.empty() && !m_ethernet.startRecording(config.recordFile)) << "Error creating trace file " << config.recordFile;
+    LOG_IF_S(ERROR, !config.replayFile.empty() && !m_ethernet.startReplay(config.replayFile, config.replaySpeed)) << "Error opening trace file " << config.replayFile;
+
     connect(&m_liveTimer, &QTimer::timeout, this, &SmaManager::onLiveTimeout);
     m_liveTimer.setSingleShot(true);
 
     connect(&m_pollTimer, &QTimer::timeout, this, &SmaManager::onPollTimeout);
     m_pollTimer.setSingleShot(true);
-    m_pollTimer.setInterval(1000);
+
+    connect(&m_fastTimer, &QTimer::timeout, this, &SmaManager::onFastTimeout);
+    m_fastTimer.setSingleShot(true);
+    m_fastTimer.setTimerType(Qt::PreciseTimer);
 
     if (m_config.command == Config::Command::RunDaemon) {
         startNextLiveTimer();
+
+        if (m_config.fastInterval > 0) {
+            if (m_config.keepSession) {
+                startNextFastTimer();
+            } else {
+                LOG_S(WARNING) << "FastInterval requires KeepSession=1, sub-second polling disabled";
+            }
+        }
     }
 }
 
@@ -90,9 +106,9 @@ const std::map<uint32_t, SmaInverter*>& SmaManager::inverters() const
     return m_inverters;
 }
 
-void SmaManager::onEnergyMeterDatagram(const QNetworkDatagram& buffer)
+void SmaManager::onEnergyMeterDatagram(const uint8_t* data, size_t size)
 {
-    auto liveData = m_energyMeter.parsePacket(buffer.data().data(), buffer.data().size());
+    auto liveData = m_energyMeter.parsePacket(reinterpret_cast<const char*>(data), size);
     if (liveData.serial != 0) {
         m_exporter.open();
         m_exporter.exportLiveData(liveData);
@@ -100,12 +116,11 @@ void SmaManager::onEnergyMeterDatagram(const QNetworkDatagram& buffer)
     }
 }
 
-void SmaManager::onDiscoveryResponseDatagram(const QNetworkDatagram& datagram)
+void SmaManager::onDiscoveryResponseDatagram(uint32_t ip)
 {
-    auto ip = datagram.senderAddress().toIPv4Address();
     if (!m_inverters.count(ip)) {
-        LOG_S(INFO) << "Discovered inverter at: " << datagram.senderAddress().toString().toStdString();
-        auto inverter = new SmaInverter(this, m_config, m_ethernet, ip, m_storage);
+        LOG_S(INFO) << "Discovered inverter at: " << asIp(ip);
+        auto inverter = new SmaInverter(this, m_config, m_ethernet, m_requestPlanner, ip, m_storage);
         inverter->m_lastSeen = std::time(nullptr);
         m_inverters.emplace(ip, inverter);
         m_requestStrategy.addInverter(inverter);
@@ -114,19 +129,20 @@ void SmaManager::onDiscoveryResponseDatagram(const QNetworkDatagram& datagram)
     }
 }
 
-void SmaManager::onUnknownDatagram(const QNetworkDatagram& datagram)
+void SmaManager::onUnknownDatagram(uint32_t ip, const uint8_t* data, size_t size)
 {
-    auto ba = datagram.data();
-    ByteBuffer buffer(ba.begin(), ba.end());
-    auto packet = SmaPacket::fromBuffer(buffer);
-    LOG_S(2) << packet;
-    //LOG_S(INFO) << buffer;
+    const SmaPacketView packet(data, size);
+    if (!packet.isValid()) {
+        LOG_F(2, "Discard datagram of %zu bytes from %s", size, asIp(ip).c_str());
+        return;
+    }
 
-    //const ethPacket* pckt = (ethPacket*)datagram.data().data();
+    LOG_S(2) << packet;
 
-    auto ip = datagram.senderAddress().toIPv4Address();
-    if (m_inverters.count(ip)) {
-        m_inverters.at(ip)->onDatagram(datagram);
+    auto it = m_inverters.find(ip);
+    if (it != m_inverters.end()) {
+        it->second->onPacket(packet);
+        onPollProgress();
     }
 }
 
@@ -143,7 +159,14 @@ void SmaManager::onLiveTimeout()
 {
     bool pollStarted = false;
 
+    // A sub-second poll still running is finished first
+    if (m_pollTimer.isActive()) {
+        m_pollTimer.stop();
+        onPollTimeout();
+    }
+
     LOG_S(INFO) << "Polling inverters, timestamp: " << m_currentTimePoint;
+    m_polledInverters.clear();
     for (auto& kv : m_inverters) {
         if (kv.second->m_state == SmaInverter::State::Invalid) {
             kv.second->init();
@@ -151,23 +174,135 @@ void SmaManager::onLiveTimeout()
         }
 
         pollStarted = true;
+        m_polledInverters.push_back(kv.first);
         kv.second->login(m_currentTimePoint);
     }
 
-    if (pollStarted) m_pollTimer.start();
+    if (pollStarted) {
+        startPollTimer(std::chrono::milliseconds(m_config.pollTimeout));
+        // Resumed sessions with nothing due are complete already
+        onPollProgress();
+    }
 
     startNextLiveTimer();
 }
 
+void SmaManager::startNextFastTimer()
+{
+    const auto overruns = m_fastSchedule.overruns();
+    const auto now = PollSchedule::Clock::now();
+    const auto tick = m_fastSchedule.next(now);
+    LOG_IF_S(WARNING, m_fastSchedule.overruns() != overruns) << "Sub-second poll overrun, ticks skipped: " << m_fastSchedule.overruns() - overruns;
+
+    m_fastTimer.start(std::chrono::ceil<std::chrono::milliseconds>(tick - now).count());
+}
+
+void SmaManager::onFastTimeout()
+{
+    startNextFastTimer();
+
+    // Not at night, and not next to a regular poll, that polls the fast data sets as well
+    if (m_timeComputation.isNight() ||
+        (m_liveTimer.remainingTime() < m_config.fastInterval) ||
+        (m_pollTimer.isActive() && !m_fastRound)) {
+        return;
+    }
+
+    if (m_pollTimer.isActive()) {
+        m_fastSchedule.overrun();
+        LOG_S(WARNING) << "Sub-second poll overrun, previous poll still running (" << m_fastSchedule.overruns() << " overruns)";
+        return;
+    }
+
+    const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    const std::time_t timestamp = now / 1000;
+    const uint16_t milliseconds = now % 1000;
+
+    bool pollStarted = false;
+    m_polledInverters.clear();
+    for (auto& kv : m_inverters) {
+        if (kv.second->m_state == SmaInverter::State::LoggedIn) {
+            m_polledInverters.push_back(kv.first);
+            kv.second->requestFastData(timestamp, milliseconds);
+            pollStarted = true;
+        }
+    }
+
+    if (pollStarted) {
+        m_fastRound = true;
+        startPollTimer(std::chrono::milliseconds(m_config.fastInterval * 3 / 4));
+    }
+}
+
+void SmaManager::startPollTimer(RttEstimator::Duration limit)
+{
+    m_pollStart = std::chrono::steady_clock::now();
+    m_pollEnd = m_pollStart;
+    m_pollLimit = limit;
+    extendPollTimer();
+}
+
+void SmaManager::extendPollTimer()
+{
+    // Wait for the slowest inverter of the poll
+    RttEstimator::Duration deadline(0);
+    for (uint32_t ip : m_polledInverters) {
+        auto it = m_inverters.find(ip);
+        if (it != m_inverters.end()) {
+            deadline = std::max(deadline, it->second->deadline());
+        }
+    }
+
+    const auto end = m_pollStart + std::min(deadline, m_pollLimit);
+    if (m_pollTimer.isActive() && (end <= m_pollEnd)) {
+        return;
+    }
+
+    m_pollEnd = end;
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(end - std::chrono::steady_clock::now());
+    m_pollTimer.start(std::max<long long>(remaining.count(), 0));
+}
+
+void SmaManager::onPollProgress()
+{
+    if (!m_pollTimer.isActive()) {
+        return;
+    }
+
+    // An inverter that has to log in again needs longer than planned
+    extendPollTimer();
+
+    for (uint32_t ip : m_polledInverters) {
+        auto it = m_inverters.find(ip);
+        if ((it != m_inverters.end()) && !it->second->isComplete()) {
+            return;
+        }
+    }
+
+    // All inverters have answered, no need to wait for the deadline
+    m_pollTimer.stop();
+    onPollTimeout();
+}
+
 void SmaManager::onPollTimeout()
 {
     LOG_IF_F(ERROR, !m_exporter.open(), "Error opening database");
 
-    LOG_S(1) << "Polling inverters finished";
+    using namespace std::chrono;
+    LOG_S(1) << "Polling inverters finished after " << duration_cast<milliseconds>(steady_clock::now() - m_pollStart).count() << " ms";
+
+    struct Latency {
+        Serial serial;
+        steady_clock::time_point requestTime;
+        bool complete;
+    };
+    std::vector<Latency> latencies;
+
     for (auto& kv : m_inverters) {
         if (kv.second->m_state != SmaInverter::State::LoggedIn)
             continue;
 
+        latencies.push_back({ kv.second->m_serial, kv.second->m_requestTime, kv.second->isComplete() });
         auto results = kv.second->result();
         for (const auto& result : results) {
             std::visit([this](auto&& arg) {
@@ -184,6 +319,18 @@ void SmaManager::onPollTimeout()
     }
 
     m_exporter.close();
+
+    // End-to-end latency, from the first request to the export of the results
+    const auto now = steady_clock::now();
+    for (const auto& latency : latencies) {
+        if (latency.requestTime == steady_clock::time_point())
+            continue;
+        VLOG_S(m_fastRound ? 1 : loguru::Verbosity_INFO) << "(" << latency.serial << ") " << (latency.complete ? "Latency: " : "Timed out, latency: ")
+                                                        << duration_cast<milliseconds>(now - latency.requestTime).count() << " ms";
+    }
+
+    m_polledInverters.clear();
+    m_fastRound = false;
 }
 
 void SmaManager::timerEvent(QTimerEvent* event)
@@ -37,9 +37,11 @@ DISCLAIMER:
 #include <QTimer>
 
 #include <Ethernet_qt.h>
+#include <PollSchedule.h>
 #include <Timer.h>
 #include <sma/SmaInverter.h>
 #include <sma/SmaEnergyMeter.h>
+#include <sma/SmaRequestPlanner.h>
 #include <sma/SmaRequestStrategy.h>
 #include <msgpack/MsgPackSerializer.h>
 
@@ -61,12 +63,17 @@ public:
     const std::map<uint32_t, SmaInverter*>& inverters() const;
 
 private:
-    void onEnergyMeterDatagram(const QNetworkDatagram& datagram);
-    void onDiscoveryResponseDatagram(const QNetworkDatagram& datagram);
-    void onUnknownDatagram(const QNetworkDatagram& datagram);
+    void onEnergyMeterDatagram(const uint8_t* data, size_t size);
+    void onDiscoveryResponseDatagram(uint32_t ip);
+    void onUnknownDatagram(uint32_t ip, const uint8_t* data, size_t size);
 
     void startNextLiveTimer();
     void onLiveTimeout();
+    void startNextFastTimer();
+    void onFastTimeout();
+    void startPollTimer(RttEstimator::Duration limit);
+    void extendPollTimer();
+    void onPollProgress();
     void onPollTimeout();
     void timerEvent(QTimerEvent *event) override;
 
@@ -80,12 +87,22 @@ private:
     int m_discoverTimer = 0;
     std::map<uint32_t, SmaInverter*> m_inverters;
     SmaRequestStrategy  m_requestStrategy;
+    SmaRequestPlanner   m_requestPlanner;   // Shared by all inverters, learns per model
 
     Timer  m_timeComputation;
     QTimer m_liveTimer;
     QTimer m_archiveTimer;
     QTimer  m_pollTimer;
     std::time_t m_currentTimePoint = 0;
+    std::vector<uint32_t> m_polledInverters;    // by IP, the inverters of the running poll
+    std::chrono::steady_clock::time_point m_pollStart;
+    std::chrono::steady_clock::time_point m_pollEnd;    // deadline of the running poll
+    RttEstimator::Duration m_pollLimit;
+
+    // Sub-second polls of the fast data sets, see Config::fastInterval
+    PollSchedule m_fastSchedule;
+    QTimer  m_fastTimer;
+    bool    m_fastRound = false;    // the running poll is a sub-second one
 
     friend class ::Ethernet_qt;
 };
@@ -0,0 +1,114 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#include "SmaRequestPlanner.h"
+
+#include <algorithm>
+
+namespace sma {
+
+void SmaRequestPlanner::plan(uint16_t susyId, uint32_t dataSets, std::vector<SmaInverterRequest>& requests) const {
+    // At most 32 data sets, sorted by command and range
+    SmaInverterRequest wanted[32];
+    size_t count = 0;
+    for (uint32_t flag = 1; flag != 0; flag <<= 1) {
+        if (dataSets & flag) {
+            auto request = SmaInverterRequests::create(static_cast<SmaInverterDataSet>(flag));
+            if (request.command != 0) {
+                wanted[count++] = request;
+            }
+        }
+    }
+
+    std::sort(wanted, wanted + count, [] (const SmaInverterRequest& a, const SmaInverterRequest& b) {
+        return (a.command != b.command) ? (a.command < b.command) : (a.first < b.first);
+    });
+
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            SmaInverterRequest& current = requests.back();
+            const SmaInverterRequest& next = wanted[i];
+            const uint32_t merged = current.dataSet | next.dataSet;
+            // LRIs are in bits 8-23, bits 0-7 select the class
+            const bool adjacent = (next.command == current.command) &&
+                    ((next.first >> 8) <= (current.last >> 8) + 1 + maxGap);
+            auto rejection = m_rejected.find({ susyId, merged });
+            if (adjacent && ((rejection == m_rejected.end()) || !rejection->second.active)) {
+                current.dataSet = static_cast<SmaInverterDataSet>(merged);
+                current.last = std::max(current.last, next.last);
+                continue;
+            }
+        }
+        requests.push_back(wanted[i]);
+    }
+}
+
+void SmaRequestPlanner::reject(uint16_t susyId, const SmaInverterRequest& request, Clock::time_point now) {
+    if (!isMerged(request.dataSet)) {
+        return;
+    }
+
+    auto it = m_rejected.find({ susyId, request.dataSet });
+    if (it == m_rejected.end()) {
+        m_rejected[{ susyId, request.dataSet }] = { now + minHold, minHold, true };
+    } else if (!it->second.active) {
+        // Rejected again after the probe
+        it->second.hold = std::min<Clock::duration>(it->second.hold * 2, maxHold);
+        it->second.until = now + it->second.hold;
+        it->second.active = true;
+    }
+}
+
+void SmaRequestPlanner::expire(Clock::time_point now) {
+    for (auto& rejection : m_rejected) {
+        if (rejection.second.active && (now >= rejection.second.until)) {
+            rejection.second.active = false;
+        }
+    }
+}
+
+void SmaRequestPlanner::forget(uint16_t susyId, const SmaInverterRequest& request) {
+    m_rejected.erase({ susyId, request.dataSet });
+}
+
+void SmaRequestPlanner::clear() {
+    m_rejected.clear();
+}
+
+bool SmaRequestPlanner::isMerged(uint32_t dataSets) {
+    return (dataSets & (dataSets - 1)) != 0;
+}
+
+} // namespace sma
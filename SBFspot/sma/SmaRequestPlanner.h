@@ -0,0 +1,120 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <sma/SmaInverterRequests.h>
+
+namespace sma {
+
+/**
+ * @brief Coalesces the data sets wanted in a poll cycle into as few range
+ * requests as possible. Data sets with the same command whose LRI ranges are
+ * at most maxGap LRIs apart are requested as one range. The dataSet of a
+ * merged request holds the flags of all data sets it covers.
+ *
+ * Not every inverter model accepts every merged range. A merge that a model
+ * answered with an error code is remembered, and later plans for that model
+ * request those data sets separately again. A merge that was not answered at
+ * all is not a rejection, the inverter may just be asleep or unreachable.
+ *
+ * Rejections expire, see expire(). The merge is then probed again, each
+ * repeated rejection holds it back twice as long, up to maxHold.
+ */
+class SmaRequestPlanner {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Unrequested LRIs allowed between two ranges to still merge them
+    static const uint32_t maxGap = 0x20;
+
+    // Time until a rejected merge is probed again
+    static constexpr std::chrono::minutes minHold{15};
+    static constexpr std::chrono::hours maxHold{24};
+
+    /**
+     * @brief Appends the requests covering the given data sets.
+     * @param susyId model of the inverter
+     * @param dataSets one or more SmaInverterDataSet flags
+     * @param requests the planned requests are appended
+     */
+    void plan(uint16_t susyId, uint32_t dataSets, std::vector<SmaInverterRequest>& requests) const;
+
+    /**
+     * @brief Learns that the model answered the merged request with an error code.
+     * @param now time of the response, the rejection expires after its hold time
+     */
+    void reject(uint16_t susyId, const SmaInverterRequest& request, Clock::time_point now);
+
+    /**
+     * @brief Lets the rejections whose hold time has passed be merged again,
+     * to be called before planning a poll.
+     */
+    void expire(Clock::time_point now);
+
+    /**
+     * @brief Forgets a single rejected merge, see clear().
+     */
+    void forget(uint16_t susyId, const SmaInverterRequest& request);
+
+    /**
+     * @brief Forgets all rejected merges, e.g. when they were rejected because
+     * the inverter had dropped the session.
+     */
+    void clear();
+
+    /**
+     * @brief True if more than one data set flag is set.
+     */
+    static bool isMerged(uint32_t dataSets);
+
+private:
+    struct Rejection {
+        Clock::time_point until;    // not merged before
+        Clock::duration hold;       // of the last rejection
+        bool active;
+    };
+
+    // Rejected merges by (SUSyID, data set flags), expired ones keep their hold time
+    std::map<std::pair<uint16_t, uint32_t>, Rejection> m_rejected;
+};
+
+} // namespace sma
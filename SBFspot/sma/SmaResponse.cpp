@@ -0,0 +1,142 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#include "SmaResponse.h"
+
+#include <algorithm>
+
+#include <Defines.h>
+#include <misc.h>
+#include <sma/SmaArchive.h>
+#include <sma/SmaLri.h>
+
+namespace sma {
+
+template <class T>
+static void setClsData(std::vector<ElectricParameters>& data, uint8_t cls, T value, T ElectricParameters::*field ) {
+    if (cls < 1) {
+        return;
+    }
+
+    if (data.size() < cls) {
+        data.resize(cls);
+    }
+
+    data.at(cls-1).*field = value;
+}
+
+void decodeLiveData(const uint8_t* data, size_t size, LiveData& liveData, InverterDataMap& inverterDataMap, std::set<LriDef>& lris) {
+    LriDecoder decoder(data, size);
+    LriRecord record;
+    while (decoder.next(record)) {
+        const LriDef lri = record.lri;
+        if ((record.format == LriFormat::Qword) ||
+            ((record.format == LriFormat::Dword) && (lri >= OperationHealth) && (lri <= InverterWLim))) {
+            inverterDataMap[lri] = record.value;
+        }
+        lris.erase(lri);
+
+        if (!record.descriptor) {
+            continue;
+        }
+
+        const uint8_t index = record.descriptor->index;
+        switch (record.descriptor->field) {
+        case LriField::AcPowerTotal: //SPOT_PACTOT
+            liveData.acPowerTotal = record.value;
+            break;
+        case LriField::AcPower: //SPOT_PAC1, SPOT_PAC2, SPOT_PAC3
+            liveData.ac[index].power = record.value;
+            break;
+        case LriField::AcVoltage: //SPOT_UAC1, SPOT_UAC2, SPOT_UAC3
+            liveData.ac[index].voltage = record.scaled();
+            break;
+        case LriField::AcCurrent: //SPOT_IAC1, SPOT_IAC2, SPOT_IAC3
+            liveData.ac[index].current = record.scaled();
+            break;
+        case LriField::DcPower: //SPOT_PDC1 / SPOT_PDC2
+            setClsData(liveData.dc, record.cls, (int32_t)record.value, &ElectricParameters::power);
+            break;
+        case LriField::DcVoltage: //SPOT_UDC1 / SPOT_UDC2
+            setClsData(liveData.dc, record.cls, record.scaled(), &ElectricParameters::voltage);
+            break;
+        case LriField::DcCurrent: //SPOT_IDC1 / SPOT_IDC2
+            setClsData(liveData.dc, record.cls, record.scaled(), &ElectricParameters::current);
+            break;
+        case LriField::EnergyTotal: //SPOT_ETOTAL
+            liveData.energyExportTotal = record.value;
+            break;
+        case LriField::EnergyToday: //SPOT_ETODAY
+            liveData.energyExportToday = record.value;
+            break;
+        default:
+            // Not part of LiveData (yet)
+            break;
+        }
+    }
+}
+
+template <class T>
+static std::time_t decodeArchiveData(const uint8_t* data, size_t size, Serial serial, std::vector<T>& archiveData) {
+    ArchiveRecords records;
+    const size_t count = decodeArchiveRecords(data, size, records);
+    archiveData.reserve(archiveData.size() + count);
+
+    std::time_t endOfData = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!records.valid[i]) {
+            endOfData = std::max(endOfData, records.datetime[i]);
+            continue;   // Fix Issue 109: Bad request 400: Power value too high for system size
+        }
+
+        T record;
+        record.datetime = records.datetime[i];
+        record.totalWh = records.totalWh[i];
+        record.serial = serial;
+        archiveData.push_back(record);
+    }
+
+    return endOfData;
+}
+
+std::time_t decodeDayData(const uint8_t* data, size_t size, Serial serial, std::vector<DayData>& dayData) {
+    return decodeArchiveData(data, size, serial, dayData);
+}
+
+std::time_t decodeMonthData(const uint8_t* data, size_t size, Serial serial, std::vector<MonthData>& monthData) {
+    return decodeArchiveData(data, size, serial, monthData);
+}
+
+}
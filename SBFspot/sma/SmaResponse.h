@@ -0,0 +1,76 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <set>
+#include <vector>
+
+#include <LiveData.h>
+#include <Types.h>
+
+// Decoders for the payload of inverter responses, independent of the transport.
+
+namespace sma {
+
+/**
+ * @brief Decodes the LRI records of a spot value response.
+ * @param data payload, LRI records followed by the end marker
+ * @param size payload size in bytes
+ * @param liveData receives the values that are part of LiveData
+ * @param inverterDataMap receives all QWORD values and the DWORD values of the operation data
+ * @param lris the received LRIs are removed from this set
+ */
+void decodeLiveData(const uint8_t* data, size_t size, LiveData& liveData, InverterDataMap& inverterDataMap, std::set<LriDef>& lris);
+
+/**
+ * @brief Appends the records of a DayData response payload.
+ * @param data payload, 12 byte records (timestamp + total Wh) followed by the end marker
+ * @param size payload size in bytes
+ * @param serial serial of the sending inverter
+ * @param dayData records with a valid total are appended
+ * @return the latest timestamp without data (NaN), 0 if there is none
+ */
+std::time_t decodeDayData(const uint8_t* data, size_t size, Serial serial, std::vector<DayData>& dayData);
+
+/**
+ * @brief Appends the records of a MonthData response payload. See decodeDayData().
+ */
+std::time_t decodeMonthData(const uint8_t* data, size_t size, Serial serial, std::vector<MonthData>& monthData);
+
+}
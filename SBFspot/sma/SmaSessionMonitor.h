@@ -0,0 +1,80 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#pragma once
+
+#include <cstdint>
+
+namespace sma {
+
+/**
+ * @brief Tells from the responses to the requests of a poll whether the
+ * inverter still knows the session. An inverter that has dropped a resumed
+ * session (KeepSession) rejects every request with an error code. A single
+ * rejection says nothing, e.g. a merged range or a data set the model does
+ * not support.
+ */
+class SmaSessionMonitor {
+public:
+    /**
+     * @brief A poll begins.
+     * @param resumed the poll continues the session of the previous one
+     */
+    void start(bool resumed);
+
+    void requestSent() { ++m_sent; }
+    void responseReceived(uint16_t error);
+
+    bool isResumed() const { return m_resumed; }
+    bool isAnswered() const { return m_answered; }
+
+    /**
+     * @brief All requests of the resumed session were rejected so far.
+     */
+    bool isRejected() const;
+
+    /**
+     * @brief Nothing the resumed session requested was answered, the session is lost.
+     */
+    bool isLost() const;
+
+private:
+    bool m_resumed = false;
+    bool m_answered = false;    // a response without error code was received
+    unsigned m_sent = 0;
+    unsigned m_rejected = 0;
+};
+
+} // namespace sma
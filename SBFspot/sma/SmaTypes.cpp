@@ -42,70 +42,36 @@ DISCLAIMER:
 
 #include <Logger.h>
 
-SmaPacket SmaPacket::fromBuffer(ByteBuffer& buffer) {
-    buffer.reset();
-    SmaPacket packet;
-    packet.smaSignatureL1 = buffer.readUint32();
-    packet.smaTag = buffer.readUint32();
-    packet.smaGroup = buffer.readUint32();
-    packet.size = buffer.readUint16();
-
-    packet.version = buffer.readUint16();
-    packet.type = static_cast<SmaPacketType>(buffer.readUint16());
-    packet.longCount = buffer.readUint8();
-    packet.control = buffer.readUint8();
-
-    packet.destinationSusyId = buffer.readUint16(false);
-    packet.destinationSerial = buffer.readUint32(false);;
-    packet.destinationControl = buffer.readUint16(false);
-
-    packet.sourceSusyId = buffer.readUint16(false);
-    packet.sourceSerial = buffer.readUint32(false);
-    packet.sourceControl = buffer.readUint16(false);
-
-    packet.error = buffer.readUint16(false);
-    packet.fragmentId = buffer.readUint16(false);
-    packet.packetId = buffer.readUint16(false);
-
-    packet.dataSet = static_cast<SmaInverterDataSet>(buffer.readUint32(false));
-    packet.first = buffer.readUint32();
-    packet.last = buffer.readUint32();
-
-    packet.payload = buffer.readByteArray(std::numeric_limits<uint16_t>::max());
-
-    return packet;
-}
-
-std::ostream& operator<< (std::ostream& out, SmaPacket const& c) {
-    //out << "signature: " << std::uppercase << std::hex << c.smaSignatureL1;
+std::ostream& operator<< (std::ostream& out, SmaPacketView const& c) {
+    //out << "signature: " << std::uppercase << std::hex << c.smaSignatureL1();
     out << std::endl;
-    out << "tag: " << std::uppercase << std::hex << c.smaTag;
-    out << ", net: " << std::dec << c.smaGroup;
-    out << ", size: " << c.size;
-    out << ", network version: " << c.version;
-    out << ", type: " << std::hex << static_cast<uint16_t>(c.type);
-    //out << ", long words: " << std::dec << static_cast<uint32_t>(c.longCount);
-    out << ", control: " << std::dec << static_cast<uint32_t>(c.control);
+    out << "tag: " << std::uppercase << std::hex << c.smaTag();
+    out << ", net: " << std::dec << c.smaGroup();
+    out << ", size: " << c.packetSize();
+    out << ", network version: " << c.version();
+    out << ", type: " << std::hex << static_cast<uint16_t>(c.type());
+    //out << ", long words: " << std::dec << static_cast<uint32_t>(c.longCount());
+    out << ", control: " << std::dec << static_cast<uint32_t>(c.control());
 
     out << "," << std::endl;
     out << "to: { ";
-    out << "susyId: " << static_cast<uint16_t>(c.destinationSusyId);
-    out << ", serial: " << c.destinationSerial;
-    out << ", control: " << static_cast<uint16_t>(c.destinationControl) << " }," << std::endl;
+    out << "susyId: " << static_cast<uint16_t>(c.destinationSusyId());
+    out << ", serial: " << c.destinationSerial();
+    out << ", control: " << static_cast<uint16_t>(c.destinationControl()) << " }," << std::endl;
     out << "from: { ";
-    out << "susyId: " << static_cast<uint16_t>(c.sourceSusyId);
-    out << ", serial: " << c.sourceSerial;
-    out << ", control: " << static_cast<uint16_t>(c.sourceControl) << " }," << std::endl;
+    out << "susyId: " << static_cast<uint16_t>(c.sourceSusyId());
+    out << ", serial: " << c.sourceSerial();
+    out << ", control: " << static_cast<uint16_t>(c.sourceControl()) << " }," << std::endl;
 
-    out << "error: " << c.error;
-    out << ", fragment: " << c.fragmentId;
-    out << ", packet: " << c.packetId << "," << std::endl;
+    out << "error: " << c.error();
+    out << ", fragment: " << c.fragmentId();
+    out << ", packet: " << c.packetId() << "," << std::endl;
 
-    out << "dataset: " << c.dataSet;
-    out << ", first: " << c.first;
-    out << ", last: " << c.last << "," << std::endl;
+    out << "dataset: " << c.dataSet();
+    out << ", first: " << c.first();
+    out << ", last: " << c.last() << "," << std::endl;
 
-    out << "payload: " << c.payload << std::endl;
+    out << "payload: " << ByteBuffer(c.payload(), c.payload() + c.payloadSize()) << std::endl;
 
     return out;
 }
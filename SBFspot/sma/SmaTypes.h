@@ -51,38 +51,62 @@ enum class SmaPacketType : uint16_t {
     Discovery = 0xFFFF
 };
 
-struct SmaPacket {
-    static SmaPacket fromBuffer(ByteBuffer& buffer);
-
-    uint32_t smaSignatureL1 = 0;    // 53 4D 41 00
-    uint32_t smaTag = 0;            // 00 04 02 A0
-    uint32_t smaGroup = 0;          // 00 00 00 01
-    uint16_t size = 0;              // size in bytes
+/**
+ * @brief Non-owning view on a received Speedwire datagram. The header fields
+ * are decoded on access, nothing is copied. The view is only valid as long as
+ * the datagram is.
+ */
+class SmaPacketView {
+public:
+    static const size_t headerSize = 54;
+
+    SmaPacketView(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+    // Large enough for all header fields
+    bool isValid() const { return m_size >= headerSize; }
+
+    uint32_t smaSignatureL1() const { return be32(0); }     // 53 4D 41 00
+    uint32_t smaTag() const { return be32(4); }             // 00 04 02 A0
+    uint32_t smaGroup() const { return be32(8); }           // 00 00 00 01
+    uint16_t packetSize() const { return be16(12); }        // size in bytes
 //14
-    uint16_t version = 0;           // 00 10
-    SmaPacketType type = SmaPacketType::Invalid;    // Inverter: 0x6065, Energy meter: 0x6069, Discovery: 0xFFFF
-    uint8_t  longCount = 0;         // count of uint32s (size/4)
-    uint8_t  control= 0;            // ?
+    uint16_t version() const { return be16(14); }           // 00 10
+    SmaPacketType type() const { return static_cast<SmaPacketType>(be16(16)); } // Inverter: 0x6065, Energy meter: 0x6069, Discovery: 0xFFFF
+    uint8_t longCount() const { return m_data[18]; }        // count of uint32s (size/4)
+    uint8_t control() const { return m_data[19]; }          // ?
 //20
-    uint16_t destinationSusyId;
-    Serial destinationSerial = 0;
-    uint16_t destinationControl;    // ?
+    uint16_t destinationSusyId() const { return le16(20); }
+    Serial destinationSerial() const { return le32(22); }
+    uint16_t destinationControl() const { return le16(26); }    // ?
 //28
-    uint16_t sourceSusyId;
-    Serial sourceSerial = 0;
-    uint16_t sourceControl;     // ?
+    uint16_t sourceSusyId() const { return le16(28); }
+    Serial sourceSerial() const { return le32(30); }
+    uint16_t sourceControl() const { return le16(34); }     // ?
 //36
-    uint16_t error;
-    uint16_t fragmentId;  //Count Down
-    uint16_t packetId;    //Count Up
+    uint16_t error() const { return le16(36); }
+    uint16_t fragmentId() const { return le16(38); }        //Count Down
+    uint16_t packetId() const { return le16(40); }          //Count Up
 //42
-    SmaInverterDataSet dataSet = Invalid;
-    uint32_t first;
-    uint32_t last;
+    SmaInverterDataSet dataSet() const { return static_cast<SmaInverterDataSet>(le32(42)); }
+    uint32_t first() const { return le32(46); }
+    uint32_t last() const { return le32(50); }
 //54
-    ByteBuffer payload; // 54?
+    const uint8_t* payload() const { return m_data + headerSize; }
+    size_t payloadSize() const { return isValid() ? m_size - headerSize : 0; }
+
+private:
+    uint16_t be16(size_t offset) const { return (m_data[offset] << 8) | m_data[offset + 1]; }
+    uint32_t be32(size_t offset) const { return ((uint32_t)be16(offset) << 16) | be16(offset + 2); }
+    uint16_t le16(size_t offset) const { return m_data[offset] | (m_data[offset + 1] << 8); }
+    uint32_t le32(size_t offset) const { return le16(offset) | ((uint32_t)le16(offset + 2) << 16); }
+
+    const uint8_t* m_data;
+    size_t m_size;
 };
-std::ostream& operator<< (std::ostream& out, SmaPacket const& c);
+std::ostream& operator<< (std::ostream& out, SmaPacketView const& c);
 
 // Nameplate response
 // 0  // 53 4D 41 00 00 04 02 A0  00 00 00 01 00 4E 00 10 // signatureL1 + tag   group + size + version
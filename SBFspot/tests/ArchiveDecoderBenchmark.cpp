@@ -0,0 +1,182 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+/*
+ * Records decoded per second by sma::decodeArchiveRecords() and the day slot
+ * assignment of importDayData, compared with the per record get_long/localtime
+ * loop it replaces.
+ */
+
+#include "../misc.h"
+#include "../sma/SmaArchive.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+static const int PACKETS = 100000;
+static const uint64_t NaN = 0xFFFFFFFFFFFFFFFFULL;
+
+static void putLong(std::vector<uint8_t>& packet, size_t offset, uint64_t v, int size)
+{
+    for (int i = 0; i < size; i++)
+        packet[offset + i] = (v >> (8 * i)) & 0xFF;
+}
+
+// 84 five minute records followed by the 4 byte end marker, every 7th record NaN
+static std::vector<uint8_t> makeDayData(std::time_t start)
+{
+    const size_t records = 84;
+    std::vector<uint8_t> packet(records * 12 + 4);
+    for (size_t i = 0; i < records; i++)
+    {
+        putLong(packet, i * 12, start + i * 300, 4);
+        putLong(packet, i * 12 + 4, (i % 7 == 3) ? NaN : 12345678 + 50 * i, 8);
+    }
+    return packet;
+}
+
+static int localtimeSlot(std::time_t datetime, int mday)
+{
+    struct tm timeinfo;
+    memcpy(&timeinfo, localtime(&datetime), sizeof(timeinfo));
+    return (timeinfo.tm_mday == mday) ? (timeinfo.tm_hour * 12) + (timeinfo.tm_min / 5) : -1;
+}
+
+static std::time_t localMidnight(int year, int mon, int mday)
+{
+    struct tm day_tm = {};
+    day_tm.tm_year = year - 1900;
+    day_tm.tm_mon = mon - 1;
+    day_tm.tm_mday = mday;
+    day_tm.tm_isdst = -1;
+    return mktime(&day_tm);
+}
+
+// LocalDay must agree with localtime() on ordinary and DST transition days
+static void checkLocalDay(int year, int mon, int mday)
+{
+    const std::time_t midnight = localMidnight(year, mon, mday);
+    const sma::LocalDay day(midnight);
+    for (std::time_t t = midnight - 86400; t < midnight + 2 * 86400; t += 60)
+        assert(day.slot(t) == localtimeSlot(t, mday));
+}
+
+static void checkDecoder(const std::vector<uint8_t>& packet)
+{
+    sma::ArchiveRecords records;
+    // Every alignment of the SIMD blocks and a truncated record
+    for (size_t size = 0; size <= packet.size(); size++)
+    {
+        records.clear();
+        const size_t count = sma::decodeArchiveRecords(packet.data(), size, records);
+        assert((count == records.size()) && (count == (size ? (size - 1) / 12 : 0)));
+        for (size_t i = 0; i < count; i++)
+        {
+            const uint64_t totalWh = (uint64_t)get_longlong(packet.data() + i * 12 + 4);
+            assert(records.datetime[i] == (std::time_t)get_long(packet.data() + i * 12));
+            assert(records.totalWh[i] == totalWh);
+            assert(records.valid[i] == (totalWh != NaN));
+        }
+    }
+}
+
+int main()
+{
+    setenv("TZ", "Europe/Brussels", 1);
+    tzset();
+
+    checkLocalDay(2021, 3, 27);
+    checkLocalDay(2021, 3, 28);     // 23 hours
+    checkLocalDay(2021, 10, 31);    // 25 hours
+    checkLocalDay(2021, 6, 30);
+
+    const std::time_t midnight = localMidnight(2021, 6, 30);
+    const auto packet = makeDayData(midnight + 6 * 3600);
+    checkDecoder(packet);
+
+    int mday;
+    {
+        struct tm day_tm;
+        memcpy(&day_tm, localtime(&midnight), sizeof(day_tm));
+        mday = day_tm.tm_mday;
+    }
+
+    // Before: get_long/get_longlong and localtime() per record
+    int64_t sum = 0;
+    size_t decoded = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < PACKETS; p++)
+    {
+        for (size_t x = 0; x + 12 < packet.size(); x += 12)
+        {
+            const std::time_t datetime = (std::time_t)get_long(packet.data() + x);
+            const uint64_t totalWh = (uint64_t)get_longlong(packet.data() + x + 4);
+            if (totalWh != NaN)
+                sum += localtimeSlot(datetime, mday) + totalWh;
+            decoded++;
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    std::cout << "per record : " << (decoded / elapsed.count() / 1e6) << " M records/s (" << sum << ")" << std::endl;
+
+    // After: batch decoding and LocalDay
+    const int64_t expected = sum;
+    sum = 0;
+    decoded = 0;
+    sma::ArchiveRecords records;
+    const sma::LocalDay day(midnight);
+    start = std::chrono::steady_clock::now();
+    for (int p = 0; p < PACKETS; p++)
+    {
+        records.clear();
+        const size_t count = sma::decodeArchiveRecords(packet.data(), packet.size(), records);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (records.valid[i])
+                sum += day.slot(records.datetime[i]) + records.totalWh[i];
+        }
+        decoded += count;
+    }
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    std::cout << "batch      : " << (decoded / elapsed.count() / 1e6) << " M records/s (" << sum << ")" << std::endl;
+
+    assert(sum == expected);
+
+    return 0;
+}
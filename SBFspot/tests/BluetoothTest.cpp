@@ -98,17 +98,12 @@ int logOn(Config& config)
 
 void logOff()
 {
-    do
-    {
-        pcktID++;
-        buffer.writePacketHeader(0x01, addr_unknown);
-        buffer.writePacket(0x08, 0xA0, 0x0300, anySUSyID, anySerial);
-        buffer.writeLong(0xFFFD010E);
-        buffer.writeLong(0xFFFFFFFF);
-        buffer.writePacketTrailer();
-        buffer.writePacketLength();
-    }
-    while (!buffer.isCrcValid());
+    buffer.writePacketHeader(0x01, addr_unknown);
+    buffer.writePacket(0x08, 0xA0, 0x0300, anySUSyID, anySerial);
+    buffer.writeLong(0xFFFD010E);
+    buffer.writeLong(0xFFFFFFFF);
+    buffer.writePacketTrailer();
+    buffer.writePacketLength();
 
     buetooth.bthSend(buffer.data().data());
 }
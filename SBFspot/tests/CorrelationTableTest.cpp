@@ -0,0 +1,83 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#include "../CorrelationTable.h"
+
+#include <cassert>
+
+int main()
+{
+    CorrelationTable table(2, 4);
+
+    // Responses complete their request regardless of the order they arrive in
+    table.expect(1001, 10, 0x0100007F, 0);
+    table.expect(1002, 11, 0x0100007F, 1);
+    table.expect(1001, 12, 0x0100007F, 2);
+    assert(table.pending() == 3);
+    assert(table.complete(1001, 12, 0x0100007F) == 2);
+    assert(table.complete(1002, 10, 0x0100007F) == -1);   // Wrong serial
+    assert(table.complete(1001, 10, 0x0100007F) == 0);
+    assert(table.complete(1001, 10, 0x0100007F) == -1);   // Already completed
+    assert(table.complete(1002, 11, 0x0100007F) == 1);
+    assert(table.pending() == 0);
+
+    // Requests to any serial are told apart by address
+    table.clear();
+    table.expect(CorrelationTable::AnySerial, 20, 0x0100007F, 0);
+    table.expect(CorrelationTable::AnySerial, 20, 0x0200007F, 1);
+    assert(table.complete(2002, 20, 0x0200007F) == 1);
+    assert(table.complete(2001, 20, 0x0100007F) == 0);
+
+    // Late responses are kept until somebody asks for them, oldest first
+    uint8_t data[4] = { 1, 2, 3, 4 };
+    uint8_t out[4] = { 0 };
+    table.stash(3001, 30, 0x0100007F, data, 1);
+    table.stash(3001, 30, 0x0100007F, data, 2);
+    assert(table.stashed() == 2);
+    assert(table.takeStashed(3001, 31, 0x0100007F, out, sizeof(out)) == 0);
+    assert(table.takeStashed(3001, 30, 0x0100007F, out, sizeof(out)) == 1);
+    assert(out[0] == 1);
+    assert(table.takeStashed(CorrelationTable::AnySerial, 30, 0x0100007F, out, sizeof(out)) == 2);
+    assert(table.stashed() == 0);
+
+    // The oldest response is dropped when the stash is full
+    table.stash(4001, 40, 0x0100007F, data, 4);
+    table.stash(4001, 41, 0x0100007F, data, 4);
+    table.stash(4001, 42, 0x0100007F, data, 4);
+    assert(table.stashed() == 2);
+    assert(table.takeStashed(4001, 40, 0x0100007F, out, sizeof(out)) == 0);
+    assert(table.takeStashed(4001, 42, 0x0100007F, out, sizeof(out)) == 4);
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+/*
+ * Compares the cost of classifying a datagram with the cached local address
+ * set against enumerating the interfaces for every datagram, as
+ * Ethernet_qt::onReadyRead() used to do with QNetworkInterface::allAddresses()
+ * (getifaddrs() is what Qt uses underneath on Linux).
+ */
+
+#include "../DatagramClassifier.h"
+
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <netinet/in.h>
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+static const int DATAGRAMS = 100000;
+
+static std::vector<uint32_t> interfaceAddresses()
+{
+    std::vector<uint32_t> addresses;
+    struct ifaddrs* ifaddr;
+    if (getifaddrs(&ifaddr) == -1)
+        return addresses;
+
+    for (struct ifaddrs* ifa = ifaddr; ifa; ifa = ifa->ifa_next)
+    {
+        if (ifa->ifa_addr && (ifa->ifa_addr->sa_family == AF_INET))
+            addresses.push_back(ntohl(((struct sockaddr_in*)ifa->ifa_addr)->sin_addr.s_addr));
+    }
+
+    freeifaddrs(ifaddr);
+    return addresses;
+}
+
+static void report(const char* name, int count, std::chrono::nanoseconds elapsed)
+{
+    std::cout << name << " ns/datagram: " << elapsed.count() / count << std::endl;
+}
+
+int main()
+{
+    DatagramClassifier classifier;
+    classifier.setLocalAddresses({ 0x7F000001, 0xC0A8B201 });
+
+    std::vector<uint8_t> meter(600, 0);
+    std::vector<uint8_t> discovery = { 0x53, 0x4D, 0x41, 0x00, 0x00, 0x04, 0x02, 0xA0, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x04 };
+    std::vector<uint8_t> response(98, 0);
+
+    assert(classifier.classify(0xC0A8B201, meter.data(), meter.size()) == DatagramClassifier::Type::Own);
+    assert(classifier.classify(0xC0A8B21F, meter.data(), meter.size()) == DatagramClassifier::Type::EnergyMeter);
+    assert(classifier.classify(0xC0A8B21F, discovery.data(), discovery.size()) == DatagramClassifier::Type::DiscoveryResponse);
+    assert(classifier.classify(0xC0A8B21F, response.data(), response.size()) == DatagramClassifier::Type::Device);
+    classifier.setLocalAddresses({ 0xC0A8B201 });
+    assert(classifier.classify(0x7F000001, response.data(), response.size()) == DatagramClassifier::Type::Localhost);
+
+    classifier.setLocalAddresses(interfaceAddresses());
+    const uint32_t sender = 0xC0A8B21F;
+    size_t meters = 0;
+
+    // Enumerate the interfaces for every datagram (one datagram per readyRead)
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < DATAGRAMS / 10; i++)
+    {
+        auto addresses = interfaceAddresses();
+        bool own = false;
+        for (auto address : addresses)
+            own |= (address == sender);
+        meters += !own && (meter.size() == 600);
+    }
+    report("enumerate", DATAGRAMS / 10, std::chrono::steady_clock::now() - start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < DATAGRAMS; i++)
+        meters += classifier.classify(sender, meter.data(), meter.size()) == DatagramClassifier::Type::EnergyMeter;
+    report("cached   ", DATAGRAMS, std::chrono::steady_clock::now() - start);
+
+    assert(meters == DATAGRAMS / 10 + DATAGRAMS);
+    return 0;
+}
@@ -0,0 +1,108 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+/*
+ * Cost of encoding the data requests of one poll cycle (16 datasets x N
+ * inverters), building every frame from scratch vs. patching cached frames.
+ */
+
+#include "../Defines.h"
+#include "../SBFspot.h"
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+static const int CYCLES = 20000;
+
+static const SmaInverterDataSet DATASETS[] = {
+    EnergyProduction, SpotDCPower, SpotDCVoltage, SpotACPower, SpotACVoltage,
+    SpotGridFrequency, SpotACTotalPower, TypeLabel, SoftwareVersion,
+    DeviceStatus, GridRelayStatus, OperationTime, BatteryChargeStatus,
+    BatteryInfo, InverterTemperature, MeteringGridMsTotW
+};
+
+static double encodeCycles(SbfSpot& sbfspot, int inverters, ByteBuffer& frame)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int cycle = 0; cycle < CYCLES; cycle++)
+    {
+        for (int inverter = 0; inverter < inverters; inverter++)
+        {
+            for (auto dataSet : DATASETS)
+                frame = sbfspot.encodeDataRequest(0x8A, 2000000000 + inverter, dataSet);
+        }
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    const size_t datasets = ARRAYSIZE(DATASETS);
+    return (double)elapsed.count() / CYCLES / inverters / datasets;
+}
+
+int main()
+{
+    ConnType = CT_ETHERNET;
+    AppSerial = 900000001;
+
+    // Patched frames are the same as built ones
+    {
+        SbfSpot built;
+        SbfSpot cached;
+        built.setRequestCache(false);
+        for (int i = 0; i < 1000; i++)
+        {
+            auto dataSet = DATASETS[i % (ARRAYSIZE(DATASETS))];
+            assert(cached.encodeDataRequest(SID_SB240 + (i & 1), 2000000000 + (i % 3), dataSet) ==
+                   built.encodeDataRequest(SID_SB240 + (i & 1), 2000000000 + (i % 3), dataSet));
+            assert(cached.packetId() == built.packetId());
+        }
+    }
+
+    for (int inverters : { 1, 4, 10 })
+    {
+        ByteBuffer frame;
+        SbfSpot sbfspot;
+
+        sbfspot.setRequestCache(false);
+        const double built = encodeCycles(sbfspot, inverters, frame);
+
+        sbfspot.setRequestCache(true);
+        const double cached = encodeCycles(sbfspot, inverters, frame);
+
+        std::cout << "inverters: " << inverters
+                  << " ns/request built: " << built
+                  << " cached: " << cached << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+/*
+ * Encodes the same sequence of requests on several threads at once, each
+ * thread with its own SbfSpot. Every frame must match the frame encoded
+ * alone beforehand, byte for byte, packet ID included.
+ */
+
+#include "../Defines.h"
+#include "../SBFspot.h"
+
+#include <cassert>
+#include <iostream>
+#include <thread>
+
+static const int THREADS = 8;
+static const int FRAMES = 40000;    // More than the 0x7FFF packet IDs, so the counter wraps
+
+static const SmaInverterDataSet DATASETS[] = {
+    EnergyProduction, SpotDCPower, SpotDCVoltage, SpotACPower, SpotACVoltage,
+    SpotGridFrequency, SpotACTotalPower, TypeLabel, SoftwareVersion,
+    DeviceStatus, GridRelayStatus, OperationTime, BatteryChargeStatus,
+    BatteryInfo, InverterTemperature, MeteringGridMsTotW
+};
+
+// Frame number i of the sequence
+static const ByteBuffer& encode(SbfSpot& sbfspot, int i)
+{
+    const uint16_t susyId = 100 + (i % 7);
+    const uint32_t serial = 2000000000 + (i % 13);
+
+    switch (i % 6)
+    {
+    case 0:
+        return sbfspot.encodeHistoricDayDataRequest(susyId, serial, 1600000000 + i, 1600086400 + i, BluetoothAddress());
+    case 1:
+        return sbfspot.encodeHistoricMonthDataRequest(susyId, serial, 1600000000 - i, 1603000000 + i, BluetoothAddress());
+    case 2:
+        return sbfspot.encodeEventDataRequest(susyId, serial, 1600000000, 1602600000, (i & 1) ? UG_USER : UG_INSTALLER, BluetoothAddress());
+    case 3:
+        return sbfspot.encodeLogoutRequest(SID_SB240, serial);
+    case 4:
+        return sbfspot.encodeDeviceListRequest(susyId, serial);
+    default:
+        return sbfspot.encodeDataRequest(susyId, serial, DATASETS[i % (ARRAYSIZE(DATASETS))]);
+    }
+}
+
+static void run(const char* name)
+{
+    std::vector<ByteBuffer> expected(FRAMES);
+    std::vector<uint16_t> expectedIds(FRAMES);
+    {
+        SbfSpot sbfspot;
+        for (int i = 0; i < FRAMES; i++)
+        {
+            expected[i] = encode(sbfspot, i);
+            expectedIds[i] = sbfspot.packetId();
+            assert((expectedIds[i] >= 1) && (expectedIds[i] <= 0x7FFF));
+        }
+    }
+
+    int mismatches[THREADS] = { 0 };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++)
+    {
+        threads.emplace_back([&expected, &expectedIds, &mismatches, t]() {
+            SbfSpot sbfspot;
+            for (int i = 0; i < FRAMES; i++)
+            {
+                if ((encode(sbfspot, i) != expected[i]) || (sbfspot.packetId() != expectedIds[i]))
+                    mismatches[t]++;
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (int t = 0; t < THREADS; t++)
+        assert(mismatches[t] == 0);
+
+    std::cout << name << ": " << THREADS << " x " << FRAMES << " frames OK" << std::endl;
+}
+
+int main()
+{
+    // Two frames under construction at the same time don't touch each other
+    ConnType = CT_ETHERNET;
+    SbfSpot first;
+    SbfSpot second;
+    const ByteBuffer& a = first.encodeDataRequest(0xFFFF, 0xFFFFFFFF, SpotACPower);
+    const ByteBuffer copy = a;
+    second.encodeHistoricDayDataRequest(0xFFFF, 0xFFFFFFFF, 0, 86400, BluetoothAddress());
+    assert(a == copy);
+    assert(first.packetId() == 1);
+    assert(second.packetId() == 1);
+    assert(first.encodeDataRequest(0xFFFF, 0xFFFFFFFF, SpotACPower) != copy);
+    assert(first.packetId() == 2);
+
+    run("Ethernet");
+
+    // Bluetooth frames add the escaping and the running checksum
+    ConnType = CT_BLUETOOTH;
+    run("Bluetooth");
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+/*
+ * Energy meter datagrams parsed per second by sma::SmaEnergyMeter, walking
+ * all OBIS elements (first datagram of a meter) and with the learned layout.
+ */
+
+#include "../LiveData.h"
+#include "../sma/SmaEnergyMeter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+static const int PACKETS = 200000;
+
+static void putLongBE(std::vector<uint8_t>& buf, uint32_t v)
+{
+    for (int i = 3; i >= 0; i--)
+        buf.push_back((v >> (8 * i)) & 0xFF);
+}
+
+static void putObis(std::vector<uint8_t>& frame, uint8_t index, uint8_t type, uint64_t value)
+{
+    frame.insert(frame.end(), { 0x00, index, type, 0x00 });
+    if (type == 8)
+        putLongBE(frame, value >> 32);
+    putLongBE(frame, value & 0xFFFFFFFF);
+}
+
+// Datagram of an SMA Energy Meter, about 600 bytes
+static std::vector<uint8_t> makeDatagram(uint32_t serial, uint32_t offset)
+{
+    std::vector<uint8_t> frame = { 0x53, 0x4D, 0x41, 0x00, 0x00, 0x04, 0x02, 0xA0, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x10, 0x60, 0x69 };
+    frame.push_back(0x01);          // SUSyID 349
+    frame.push_back(0x5D);
+    putLongBE(frame, serial);
+    putLongBE(frame, 123456789);    // Ticker
+
+    // Totals and the values of L1..L3: powers with their counters, then the measurands without counter
+    for (uint8_t base : { 0, 20, 40, 60 })
+    {
+        for (uint8_t index : { 1, 2, 3, 4, 9, 10 })
+        {
+            putObis(frame, base + index, 4, 1000 + offset + base + index);
+            putObis(frame, base + index, 8, 3600000000ULL + offset + base + index);
+        }
+        for (uint8_t index : (base == 0) ? std::vector<uint8_t>{ 13, 14 } : std::vector<uint8_t>{ 11, 12, 13 })
+            putObis(frame, base + index, 4, 1000 + offset + base + index);
+    }
+    frame.insert(frame.end(), { 0x90, 0x00, 0x00, 0x00, 0x02, 0x00, 0x12, 0x52 });  // Software version
+
+    const size_t size = frame.size() - 16;
+    frame[12] = (size >> 8) & 0xFF;
+    frame[13] = size & 0xFF;
+    putLongBE(frame, 0);            // End tag
+    return frame;
+}
+
+static bool operator==(const LiveData& a, const LiveData& b)
+{
+    bool equal = (a.serial == b.serial) && (a.acPowerTotal == b.acPowerTotal) &&
+                 (a.energyImportTotal == b.energyImportTotal) && (a.energyExportTotal == b.energyExportTotal);
+    for (size_t i = 0; i < a.ac.size(); i++)
+        equal = equal && (a.ac[i].power == b.ac[i].power) && (a.ac[i].voltage == b.ac[i].voltage) && (a.ac[i].current == b.ac[i].current);
+    return equal;
+}
+
+template <class Parse>
+static void benchmark(const char* name, const std::vector<uint8_t>& datagram, Parse parse)
+{
+    int64_t sum = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < PACKETS; i++)
+        sum += parse(reinterpret_cast<const char*>(datagram.data()), datagram.size()).energyImportTotal;
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    std::cout << name << ": " << (PACKETS / elapsed.count() / 1e3) << " k datagrams/s (" << sum << ")" << std::endl;
+}
+
+int main()
+{
+    const auto datagram = makeDatagram(1900123456, 0);
+
+    // The learned layout gives the same values as the walk
+    sma::SmaEnergyMeter energyMeter;
+    const LiveData first = energyMeter.parsePacket(reinterpret_cast<const char*>(datagram.data()), datagram.size());
+    const LiveData cached = energyMeter.parsePacket(reinterpret_cast<const char*>(datagram.data()), datagram.size());
+    assert((first.serial == 1900123456) && (first.ac[0].voltage > 0) && (first.energyImportTotal == 1000000));
+    assert(first == cached);
+
+    // Changed values, same layout
+    const auto next = makeDatagram(1900123456, 7);
+    assert(energyMeter.parsePacket(reinterpret_cast<const char*>(next.data()), next.size()) ==
+           sma::SmaEnergyMeter().parsePacket(reinterpret_cast<const char*>(next.data()), next.size()));
+
+    // Changed layout, same length: the counter of the total import power is moved behind the export power
+    auto moved = datagram;
+    std::rotate(moved.begin() + 36, moved.begin() + 48, moved.begin() + 56);
+    assert(energyMeter.parsePacket(reinterpret_cast<const char*>(moved.data()), moved.size()) ==
+           sma::SmaEnergyMeter().parsePacket(reinterpret_cast<const char*>(moved.data()), moved.size()));
+
+    // Truncated datagram of a known meter
+    auto truncated = datagram;
+    truncated.resize(datagram.size() - 40);
+    assert(energyMeter.parsePacket(reinterpret_cast<const char*>(truncated.data()), truncated.size()) ==
+           sma::SmaEnergyMeter().parsePacket(reinterpret_cast<const char*>(truncated.data()), truncated.size()));
+
+    benchmark("walk  ", datagram, [](const char* data, uint16_t size) { return sma::SmaEnergyMeter().parsePacket(data, size); });
+    benchmark("cached", datagram, [&energyMeter](const char* data, uint16_t size) { return energyMeter.parsePacket(data, size); });
+
+    return 0;
+}
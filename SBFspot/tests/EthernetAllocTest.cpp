@@ -0,0 +1,118 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+/*
+ * Verifies that receiving packets does not allocate heap memory once the
+ * receive pool is warmed up. The socket sends the requests to itself over
+ * the loopback interface, so every request is answered by its own echo.
+ */
+
+#include "../Defines.h"
+#include "../Ethernet.h"
+#include "../SBFspot.h"
+#include "../misc.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+static size_t allocations = 0;
+
+void* operator new(size_t size)
+{
+    ++allocations;
+    if (void* p = std::malloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+int main()
+{
+    ConnType = CT_ETHERNET;
+    SbfSpot sbfspot;
+    Ethernet ethernet;
+    assert(ethernet.ethConnect(19523) == 0);
+
+    std::vector<EthRequest> requests(40);
+    for (auto& request : requests)
+    {
+        request.ip = "127.0.0.1";
+        request.request = sbfspot.encodeDataRequest(0xFFFF, 0xFFFFFFFF, SpotACPower);
+        request.packetId = sbfspot.packetId();
+    }
+
+    for (bool batch : { true, false })
+    {
+        ethernet.setBatchIO(batch);
+
+        // Warm up the receive pool
+        assert(ethernet.ethExchange(requests, 1000) == E_OK);
+
+        allocations = 0;
+        for (int cycle = 0; cycle < 100; cycle++)
+        {
+            assert(ethernet.ethExchange(requests, 1000) == E_OK);
+            for (const auto& request : requests)
+            {
+                assert(request.rc == E_OK);
+                assert(request.response[0] == 0);
+                assert((get_short(request.response.data() + 27) & 0x7FFF) == request.packetId);
+            }
+        }
+        assert(allocations == 0);
+    }
+
+    // Single packets, as used by the Bluetooth compatible path
+    allocations = 0;
+    for (int cycle = 0; cycle < 100; cycle++)
+    {
+        PacketView packet;
+        assert(ethernet.ethSend(requests[cycle % requests.size()].request, "127.0.0.1") > 0);
+        assert(ethernet.ethGetPacket(packet) == E_OK);
+        assert(packet.size() == requests[0].request.size() - sizeof(ethPacketHeaderL1) + 1);
+    }
+    assert(allocations == 0);
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+/*
+ * Counts the system calls needed for one poll cycle (15 datasets x N
+ * inverters). The socket sends the requests to itself over the loopback
+ * interface, so every request is answered by its own echo.
+ */
+
+#include "../Defines.h"
+#include "../Ethernet.h"
+#include "../SBFspot.h"
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+static const int PORT = 19522;
+static const int DATASETS = 15;
+static const int CYCLES = 100;
+
+static std::vector<EthRequest> createRequests(SbfSpot& sbfspot, int inverters)
+{
+    std::vector<EthRequest> requests(inverters * DATASETS);
+    for (auto& request : requests)
+    {
+        request.ip = "127.0.0.1";
+        request.request = sbfspot.encodeDataRequest(0xFFFF, 0xFFFFFFFF, SpotACPower);
+        request.packetId = sbfspot.packetId();
+    }
+    return requests;
+}
+
+static void report(const char* name, int inverters, const EthStats& stats, std::chrono::nanoseconds elapsed)
+{
+    std::cout << name << " inverters: " << inverters
+              << " syscalls/cycle: " << (double)stats.syscalls() / CYCLES
+              << " (send: " << (double)stats.sendCalls / CYCLES
+              << ", recv: " << (double)stats.recvCalls / CYCLES
+              << ", wait: " << (double)stats.waitCalls / CYCLES
+              << ") us/cycle: " << elapsed.count() / 1000 / CYCLES << std::endl;
+}
+
+int main()
+{
+    ConnType = CT_ETHERNET;
+    SbfSpot sbfspot;
+    Ethernet ethernet;
+    assert(ethernet.ethConnect(PORT) == 0);
+
+    for (int inverters : { 1, 4, 10 })
+    {
+        auto requests = createRequests(sbfspot, inverters);
+
+        // One sendto() and one select()/recvfrom() pair per request, as before ethExchange()
+        ethernet.resetStats();
+        auto start = std::chrono::steady_clock::now();
+        for (int cycle = 0; cycle < CYCLES; cycle++)
+        {
+            for (auto& request : requests)
+            {
+                ethernet.ethSend(request.request, request.ip);
+                Buffer response;
+                assert(ethernet.ethGetPacket(response) == E_OK);
+            }
+        }
+        report("sequential", inverters, ethernet.stats(), std::chrono::steady_clock::now() - start);
+
+        for (bool batch : { false, true })
+        {
+            ethernet.setBatchIO(batch);
+            ethernet.resetStats();
+            start = std::chrono::steady_clock::now();
+            for (int cycle = 0; cycle < CYCLES; cycle++)
+            {
+                assert(ethernet.ethExchange(requests, 1000) == E_OK);
+            }
+            report(batch ? "batched   " : "exchange  ", inverters, ethernet.stats(), std::chrono::steady_clock::now() - start);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+/*
+ * Throughput of the FCS16 and of HDLC escaping/unescaping, compared with the
+ * byte-by-byte loops they replace. Typical Bluetooth frames are 40 to 100
+ * bytes, archive responses up to ~500.
+ */
+
+#include "../Hdlc.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static const size_t TOTAL = 64 * 1024 * 1024;
+
+static uint16_t fcstab[256];
+
+static uint16_t bytewiseFcs16(uint16_t fcs, const uint8_t* data, size_t size)
+{
+    while (size-- > 0)
+        fcs = (fcs >> 8) ^ fcstab[(fcs ^ *data++) & 0xFF];
+    return fcs;
+}
+
+static size_t bytewiseEscape(const uint8_t* in, size_t size, uint8_t* out)
+{
+    uint8_t* const start = out;
+    for (size_t i = 0; i < size; i++)
+    {
+        const uint8_t v = in[i];
+        if (v == 0x7d || v == 0x7e || v == 0x11 || v == 0x12 || v == 0x13)
+        {
+            *out++ = 0x7d;
+            *out++ = v ^ 0x20;
+        }
+        else
+            *out++ = v;
+    }
+    return out - start;
+}
+
+static size_t bytewiseUnescape(const uint8_t* in, size_t size, uint8_t* out)
+{
+    uint8_t* const start = out;
+    bool escNext = false;
+    for (size_t i = 0; i < size; i++)
+    {
+        if (escNext)
+        {
+            *out++ = in[i] ^ 0x20;
+            escNext = false;
+        }
+        else if (in[i] == 0x7D)
+            escNext = true;
+        else
+            *out++ = in[i];
+    }
+    return out - start;
+}
+
+// MB/s of f over frames of the given size
+template <typename F>
+static double measure(size_t frameSize, F f)
+{
+    const size_t frames = TOTAL / frameSize;
+    volatile size_t sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < frames; i++)
+        sink += f();
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    (void)sink;
+    return (double)(frames * frameSize) / elapsed.count() / 1e6;
+}
+
+int main()
+{
+    for (int v = 0; v < 256; v++)
+    {
+        uint16_t fcs = v;
+        for (int bit = 0; bit < 8; bit++)
+            fcs = (fcs & 1) ? (fcs >> 1) ^ 0x8408 : (fcs >> 1);
+        fcstab[v] = fcs;
+    }
+
+    std::mt19937 rng(1662);
+
+    for (size_t frameSize : { 64, 512 })
+    {
+        // Real payloads are mostly zeros and small values, ~2% bytes to escape
+        std::vector<uint8_t> data(frameSize);
+        for (auto& v : data)
+            v = (rng() % 50 == 0) ? 0x7D : (rng() % 3 == 0) ? 0 : rng();
+
+        std::vector<uint8_t> escaped(2 * frameSize);
+        std::vector<uint8_t> unescaped(frameSize);
+        const size_t escapedSize = hdlc::escape(data.data(), frameSize, escaped.data());
+
+        const double fcsBytewise = measure(frameSize, [&] { return bytewiseFcs16(hdlc::FCS_INIT, data.data(), frameSize); });
+        const double fcsSliced = measure(frameSize, [&] { return hdlc::fcs16(hdlc::FCS_INIT, data.data(), frameSize); });
+        const double escBytewise = measure(frameSize, [&] { return bytewiseEscape(data.data(), frameSize, escaped.data()); });
+        const double escBulk = measure(frameSize, [&] { return hdlc::escape(data.data(), frameSize, escaped.data()); });
+        const double unescBytewise = measure(frameSize, [&] { return bytewiseUnescape(escaped.data(), escapedSize, unescaped.data()); });
+        const double unescBulk = measure(frameSize, [&] { return hdlc::unescape(escaped.data(), escapedSize, unescaped.data()); });
+
+        std::cout << "frame " << frameSize << " bytes, MB/s bytewise/bulk:"
+                  << " fcs16 " << fcsBytewise << "/" << fcsSliced
+                  << " escape " << escBytewise << "/" << escBulk
+                  << " unescape " << unescBytewise << "/" << unescBulk << std::endl;
+    }
+
+    return 0;
+}
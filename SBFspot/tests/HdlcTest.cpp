@@ -0,0 +1,190 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+/*
+ * Checks the FCS16 and the HDLC escaping of Bluetooth frames against plain
+ * byte-by-byte implementations. No Bluetooth adapter is needed.
+ */
+
+#include "../Defines.h"
+#include "../Hdlc.h"
+#include "../SBFspot.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <random>
+
+// Bitwise FCS16 of RFC 1662
+static uint16_t referenceFcs16(uint16_t fcs, const uint8_t* data, size_t size)
+{
+    while (size-- > 0)
+    {
+        fcs ^= *data++;
+        for (int bit = 0; bit < 8; bit++)
+            fcs = (fcs & 1) ? (fcs >> 1) ^ 0x8408 : (fcs >> 1);
+    }
+    return fcs;
+}
+
+static std::vector<uint8_t> referenceEscape(const std::vector<uint8_t>& in)
+{
+    std::vector<uint8_t> out;
+    for (uint8_t v : in)
+    {
+        if (hdlc::needsEscape(v))
+        {
+            out.push_back(0x7D);
+            out.push_back(v ^ 0x20);
+        }
+        else
+            out.push_back(v);
+    }
+    return out;
+}
+
+static void testFcs16(std::mt19937& rng)
+{
+    // Check value of CRC-16/X-25
+    const char* check = "123456789";
+    assert((hdlc::fcs16(hdlc::FCS_INIT, (const uint8_t*)check, 9) ^ 0xFFFF) == 0x906E);
+
+    for (size_t size = 0; size < 300; size++)
+    {
+        std::vector<uint8_t> data(size);
+        for (auto& v : data)
+            v = rng();
+
+        const uint16_t expected = referenceFcs16(hdlc::FCS_INIT, data.data(), size);
+        assert(hdlc::fcs16(hdlc::FCS_INIT, data.data(), size) == expected);
+
+        // Split anywhere, also in the middle of an 8 byte block
+        const size_t split = size ? rng() % size : 0;
+        const uint16_t first = hdlc::fcs16(hdlc::FCS_INIT, data.data(), split);
+        assert(hdlc::fcs16(first, data.data() + split, size - split) == expected);
+    }
+}
+
+static void testEscape(std::mt19937& rng)
+{
+    const uint8_t special[] = { 0x7D, 0x7E, 0x11, 0x12, 0x13 };
+
+    // From no special bytes to special bytes only
+    for (int density : { 0, 1, 10, 50, 100 })
+    {
+        for (size_t size = 0; size < 200; size++)
+        {
+            std::vector<uint8_t> data(size);
+            for (auto& v : data)
+                v = ((int)(rng() % 100) < density) ? special[rng() % sizeof(special)] : rng();
+
+            const std::vector<uint8_t> expected = referenceEscape(data);
+            std::vector<uint8_t> escaped(2 * size);
+            const size_t escapedSize = hdlc::escape(data.data(), size, escaped.data());
+            assert(escapedSize == expected.size());
+            assert(std::equal(expected.begin(), expected.end(), escaped.begin()));
+
+            // In place
+            assert(hdlc::unescape(escaped.data(), escapedSize, escaped.data()) == size);
+            assert(std::equal(data.begin(), data.end(), escaped.begin()));
+        }
+    }
+}
+
+// Unescapes a Bluetooth frame and verifies its length and checksum
+static void verifyFrame(const ByteBuffer& frame, bool& escapedChecksum)
+{
+    const size_t L1_HEADER = 18;
+    assert(frame.size() > L1_HEADER + 4);
+    assert(frame[0] == 0x7E);
+    assert((size_t)(frame[1] | (frame[2] << 8)) == frame.size());
+    assert(frame[3] == (frame[0] ^ frame[1] ^ frame[2]));
+    assert(frame[L1_HEADER] == 0x7E);
+    assert(frame.back() == 0x7E);
+
+    // No byte in between needs escaping
+    for (size_t i = L1_HEADER + 1; i < frame.size() - 1; i++)
+    {
+        assert((frame[i] != 0x7E) && (frame[i] < 0x11 || frame[i] > 0x13));
+        if (frame[i] == 0x7D)
+            assert(hdlc::needsEscape(frame[++i] ^ 0x20));
+    }
+
+    escapedChecksum |= (frame[frame.size() - 3] == 0x7D) || (frame[frame.size() - 4] == 0x7D);
+
+    // Received packets are unescaped behind the 0x7E of the L2 header
+    Buffer received;
+    auto& data = received.data();
+    data.assign(frame.begin() + L1_HEADER, frame.end() - 1);
+    data.resize(1 + hdlc::unescape(data.data() + 1, data.size() - 1, data.data() + 1));
+    data.push_back(0x7E);
+    assert(received.validateChecksum());
+}
+
+static void testFrames()
+{
+    ConnType = CT_BLUETOOTH;
+    AppSerial = 900000001;
+    for (int i = 0; i < 6; i++)
+        LocalBTAddress[i] = 0x10 + i;
+
+    SbfSpot sbfspot;
+    bool escapedChecksum = false;
+    for (int i = 0; i < 20000; i++)
+    {
+        // Timestamps full of bytes to escape
+        const time_t from = 0x7D7E1100 + i;
+        verifyFrame(sbfspot.encodeHistoricDayDataRequest(0x7D, 0x13121111 + i, from, from + 86400, BluetoothAddress()), escapedChecksum);
+        verifyFrame(sbfspot.encodeDataRequest(0x8A, 2000000000 + i, SpotACPower), escapedChecksum);
+        verifyFrame(sbfspot.encodeLogoutRequest(), escapedChecksum);
+    }
+
+    // Checksums with bytes to escape did show up and were not retried
+    assert(escapedChecksum);
+    assert(sbfspot.packetId() == (60000 % 0x7FFF));
+
+    ConnType = CT_ETHERNET;
+}
+
+int main()
+{
+    std::mt19937 rng(1662);
+
+    testFcs16(rng);
+    testEscape(rng);
+    testFrames();
+
+    std::cout << "hdlctest passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,121 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+/*
+ * Records decoded per second by sma::LriDecoder, for the record formats of
+ * the spot value responses.
+ */
+
+#include "../misc.h"
+#include "../sma/SmaLri.h"
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+static const int PACKETS = 200000;
+
+static void putLong(std::vector<uint8_t>& packet, size_t offset, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+        packet[offset + i] = (v >> (8 * i)) & 0xFF;
+}
+
+// Records of one response followed by the 4 byte end marker
+static std::vector<uint8_t> makeResponse(const std::vector<uint32_t>& codes, size_t recordSize)
+{
+    std::vector<uint8_t> packet(codes.size() * recordSize + 4);
+    for (size_t i = 0; i < codes.size(); i++)
+    {
+        const size_t offset = i * recordSize;
+        putLong(packet, offset, codes[i]);
+        putLong(packet, offset + 4, 1600000000 + i);
+        if (recordSize == 16)
+            putLong(packet, offset + 8, 123456 + i);
+        else if (recordSize == 28)
+            putLong(packet, offset + 16, (i == 1) ? 0x80000000 : 23000 + i);
+        else
+        {
+            putLong(packet, offset + 8, 0x01000133);    // Selected attribute 307
+            putLong(packet, offset + 12, 0x00FFFFFE);
+        }
+    }
+    return packet;
+}
+
+static void benchmark(const char* name, const std::vector<uint8_t>& packet, size_t records)
+{
+    sma::LriRecord record;
+    int64_t sum = 0;
+    size_t decoded = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < PACKETS; i++)
+    {
+        sma::LriDecoder decoder(packet.data(), packet.size());
+        while (decoder.next(record))
+        {
+            sum += record.value + (int)record.descriptor->field;
+            decoded++;
+        }
+    }
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    assert(decoded == records * PACKETS);
+    std::cout << name << ": " << (decoded / elapsed.count() / 1e6) << " M records/s (" << sum << ")" << std::endl;
+}
+
+int main()
+{
+    // SpotACPower, SpotACVoltage: 28 byte DWORD records, one of them NaN
+    const auto spotAc = makeResponse({ 0x40464001, 0x40464101, 0x40464201, 0x00464801, 0x00464901, 0x00464A01,
+                                       0x00465301, 0x00465401, 0x00465501 }, 28);
+    // EnergyProduction, OperationTime: 16 byte QWORD records
+    const auto energy = makeResponse({ 0x00260101, 0x00262201, 0x00462E01, 0x00462F01 }, 16);
+    // DeviceStatus, TypeLabel: 40 byte status records
+    const auto status = makeResponse({ 0x08214801, 0x08821F01, 0x08822001 }, 40);
+
+    sma::LriRecord record;
+    sma::LriDecoder check(spotAc.data(), spotAc.size());
+    assert(check.next(record) && (record.value == 23000) && (record.descriptor->field == sma::LriField::AcPower));
+    assert(check.next(record) && (record.value == 0) && (record.descriptor->index == 1));
+    assert(check.next(record) && check.next(record) && (record.scaled() > 230.02f) && (record.scaled() < 230.04f));
+
+    benchmark("DWORD ", spotAc, 9);
+    benchmark("QWORD ", energy, 4);
+    benchmark("STATUS", status, 3);
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#include "../PollSchedule.h"
+
+#include <cassert>
+
+using namespace std::chrono;
+
+int main()
+{
+    const PollSchedule::Clock::time_point start;
+    PollSchedule schedule(milliseconds(250), start);
+
+    // Ticks are multiples of the interval, however late the timer fires
+    assert(schedule.next(start) == start + milliseconds(250));
+    assert(schedule.next(start + milliseconds(253)) == start + milliseconds(500));
+    assert(schedule.next(start + milliseconds(509)) == start + milliseconds(750));
+    assert(schedule.overruns() == 0);
+
+    // A timer that fires early gets the following tick, not the same one again
+    assert(schedule.next(start + milliseconds(749)) == start + milliseconds(1000));
+    assert(schedule.ticks() == 4);
+
+    // Ticks that have passed are skipped and counted
+    assert(schedule.next(start + milliseconds(1760)) == start + milliseconds(2000));
+    assert(schedule.overruns() == 3);
+
+    schedule.overrun();
+    assert(schedule.overruns() == 4);
+    assert(schedule.next(start + milliseconds(2001)) == start + milliseconds(2250));
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+#include "../RttEstimator.h"
+
+#include <cassert>
+
+using namespace std::chrono;
+
+int main()
+{
+    RttEstimator rtt(milliseconds(1000), milliseconds(50), milliseconds(2000));
+    assert(!rtt.hasSamples());
+    assert(rtt.rto() == milliseconds(1000));
+
+    // First sample: SRTT = R, RTTVAR = R/2, RTO = SRTT + 4 RTTVAR
+    rtt.addSample(milliseconds(20));
+    assert(rtt.srtt() == milliseconds(20));
+    assert(rtt.rttvar() == milliseconds(10));
+    assert(rtt.rto() == milliseconds(60));
+
+    // A steady LAN converges to the minimum RTO
+    for (int i = 0; i < 50; i++)
+        rtt.addSample(milliseconds(10));
+    assert(rtt.srtt() < milliseconds(11));
+    assert(rtt.rto() == milliseconds(50));
+
+    // A slow response raises SRTT by 1/8 of the difference, RTTVAR by 1/4
+    RttEstimator::Duration srtt = rtt.srtt();
+    RttEstimator::Duration rttvar = rtt.rttvar();
+    rtt.addSample(srtt + milliseconds(80));
+    assert(rtt.srtt() == srtt + milliseconds(10));
+    assert(rtt.rttvar() == (rttvar * 3 + milliseconds(80)) / 4);
+    assert(rtt.rto() == rtt.srtt() + rtt.rttvar() * 4);
+
+    // Exponential backoff is capped
+    RttEstimator::Duration rto = rtt.rto();
+    assert(rtt.backoff(0) == rto);
+    assert(rtt.backoff(1) == rto * 2);
+    assert(rtt.backoff(2) == rto * 4);
+    assert(rtt.backoff(10) == milliseconds(2000));
+
+    // Timeouts do not change the estimate, a response resets the failures
+    rtt.addTimeout();
+    rtt.addTimeout();
+    assert(rtt.failures() == 2);
+    assert(rtt.rto() == rto);
+    rtt.addResponse();
+    assert(rtt.failures() == 0);
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#include "../sma/SmaDataSetScheduler.h"
+
+#include <cassert>
+
+using namespace sma;
+
+int main()
+{
+    const uint32_t ac = SpotACPower | SpotACVoltage | SpotACTotalPower | SpotGridFrequency;
+    const uint32_t dc = SpotDCPower | SpotDCVoltage;
+    const uint32_t nameplate = TypeLabel | SoftwareVersion | MaxACPower;
+    SmaDataSetScheduler scheduler({ { ac, 0 }, { dc, 10 }, { nameplate, 86400 } });
+    assert(scheduler.dataSets() == (ac | dc | nameplate));
+
+    // Everything is due in the first poll
+    const std::time_t t0 = 1700006400;    // multiple of a day
+    assert(scheduler.due(t0) == (ac | dc | nameplate));
+    scheduler.answered(ac | dc | nameplate, t0);
+
+    // Then only the data sets whose period has begun again
+    assert(scheduler.due(t0 + 2) == ac);
+    scheduler.answered(ac, t0 + 2);
+    assert(scheduler.due(t0 + 10) == (ac | dc));
+
+    // Data sets that were not answered stay due
+    scheduler.answered(ac | SpotDCPower, t0 + 10);
+    assert(scheduler.due(t0 + 12) == (ac | SpotDCVoltage));
+    scheduler.answered(ac | SpotDCVoltage, t0 + 12);
+
+    // Periods are aligned to their multiples, a missed poll is caught up
+    assert(scheduler.due(t0 + 19) == ac);
+    assert(scheduler.due(t0 + 25) == (ac | dc));
+    assert(scheduler.due(t0 + 86400) == (ac | dc | nameplate));
+
+    scheduler.reset();
+    assert(scheduler.due(t0 + 14) == (ac | dc | nameplate));
+
+    // Every other poll has nothing due, e.g. ACInterval=10 with LiveInterval=5
+    SmaDataSetScheduler slow({ { ac, 10 } });
+    for (std::time_t t = t0; t < t0 + 60; t += 5) {
+        const uint32_t due = slow.due(t);
+        assert(due == ((t % 10 == 0) ? ac : 0));
+        slow.answered(due, t);
+    }
+
+    // Values of the data sets that were not requested are taken from the cache
+    LiveData cached(1);
+    cached.acPowerTotal = 3000;
+    cached.ac[0] = { 1000, 4.3f, 230.0f };
+    cached.dc = { { 1600, 4.0f, 400.0f }, { 1500, 3.75f, 400.0f } };
+    cached.dcPowerTotal = 3100;
+    cached.energyExportToday = 12000;
+
+    LiveData liveData(1);
+    liveData.acPowerTotal = 2900;
+    liveData.ac[0] = { 950, 4.1f, 231.0f };
+    SmaDataSetScheduler::fill(liveData, cached, dc | nameplate);
+    assert(liveData.acPowerTotal == 2900);
+    assert(liveData.ac[0].power == 950);
+    assert(liveData.dc.size() == 2);
+    assert(liveData.dc[1].power == 1500);
+    assert(liveData.dc[1].voltage == 400.0f);
+    assert(liveData.dcPowerTotal == 3100);
+    assert(liveData.energyExportToday == 0);
+
+    InverterDataMap cachedMap = { { GridMsWphsA, 1000.0f }, { DcMsVol, 400.0f } };
+    InverterDataMap dataMap = { { GridMsWphsA, 950.0f } };
+    SmaDataSetScheduler::fill(dataMap, cachedMap, dc);
+    assert(dataMap.size() == 2);
+    assert(dataMap[GridMsWphsA] == 950.0f);
+    assert(dataMap[DcMsVol] == 400.0f);
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+/*
+ * Decodes frames built by the encoder through SmaPacketView.
+ */
+
+#include "../Defines.h"
+#include "../SBFspot.h"
+#include "../sma/SmaInverterRequests.h"
+#include "../sma/SmaTypes.h"
+
+#include <cassert>
+
+int main()
+{
+    ConnType = CT_ETHERNET;
+    AppSerial = 900000001;
+
+    SbfSpot sbfspot;
+    const ByteBuffer& frame = sbfspot.encodeDataRequest(0x8A, 2000000001, SpotACPower);
+    const auto request = sma::SmaInverterRequests::create(SpotACPower);
+
+    const SmaPacketView packet(frame.data(), frame.size());
+    assert(packet.isValid());
+    assert(packet.smaSignatureL1() == 0x534D4100);
+    assert(packet.packetSize() == frame.size() - 20);
+    assert(packet.type() == SmaPacketType::Inverter);
+    assert(packet.longCount() == 0x09);
+    assert(packet.control() == 0xA0);
+    assert(packet.destinationSusyId() == 0x8A);
+    assert(packet.destinationSerial() == 2000000001);
+    assert(packet.sourceSerial() == AppSerial);
+    assert(packet.error() == 0);
+    assert(packet.packetId() == (sbfspot.packetId() | 0x8000));
+    assert(packet.dataSet() == (SmaInverterDataSet)request.command);
+    assert(packet.first() == request.first);
+    assert(packet.last() == request.last);
+    assert(packet.payloadSize() == 4);  // End of packet
+
+    // Too short for the header
+    assert(!SmaPacketView(frame.data(), SmaPacketView::headerSize - 1).isValid());
+    assert(SmaPacketView(frame.data(), 10).payloadSize() == 0);
+
+    return 0;
+}
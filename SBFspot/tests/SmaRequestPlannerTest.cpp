@@ -0,0 +1,132 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#include "../sma/SmaRequestPlanner.h"
+
+#include <cassert>
+
+using namespace sma;
+
+static std::vector<SmaInverterRequest> plan(const SmaRequestPlanner& planner, uint16_t susyId, uint32_t dataSets)
+{
+    std::vector<SmaInverterRequest> requests;
+    planner.plan(susyId, dataSets, requests);
+    return requests;
+}
+
+int main()
+{
+    SmaRequestPlanner planner;
+    const auto now = SmaRequestPlanner::Clock::now();
+
+    // A single data set is requested as is
+    auto requests = plan(planner, 128, SpotACPower);
+    assert(requests.size() == 1);
+    assert(requests[0].dataSet == SpotACPower);
+    assert(requests[0].command == 0x51000200);
+    assert(requests[0].first == 0x00464000);
+    assert(requests[0].last == 0x004642FF);
+
+    // Adjacent ranges of the same command are merged
+    const uint32_t spotAC = SpotACPower | SpotACVoltage | SpotGridFrequency;
+    requests = plan(planner, 128, spotAC);
+    assert(requests.size() == 1);
+    assert(requests[0].dataSet == spotAC);
+    assert(requests[0].first == 0x00464000);
+    assert(requests[0].last == 0x004657FF);
+    assert(SmaRequestPlanner::isMerged(requests[0].dataSet));
+
+    // Distant ranges and other commands are not
+    requests = plan(planner, 128, spotAC | SpotACTotalPower | SpotDCPower | SpotDCVoltage);
+    assert(requests.size() == 4);
+    for (const auto& request : requests)
+        assert((request.dataSet == spotAC) || !SmaRequestPlanner::isMerged(request.dataSet));
+
+    // A rejected merge is split for that model only, smaller merges are tried next
+    planner.reject(128, { static_cast<SmaInverterDataSet>(spotAC), 0x51000200, 0x00464000, 0x004657FF }, now);
+    requests = plan(planner, 128, spotAC);
+    assert(requests.size() == 2);
+    assert(requests[0].dataSet == (SpotACPower | SpotACVoltage));
+    assert(requests[1].dataSet == SpotGridFrequency);
+    assert(plan(planner, 129, spotAC).size() == 1);
+
+    planner.reject(128, requests[0], now);
+    requests = plan(planner, 128, spotAC);
+    assert(requests.size() == 2);
+    assert(requests[0].dataSet == SpotACPower);
+    assert(requests[1].dataSet == (SpotACVoltage | SpotGridFrequency));
+
+    planner.reject(128, requests[1], now);
+    assert(plan(planner, 128, spotAC).size() == 3);
+
+    // Forgotten rejections are merged again
+    planner.clear();
+    assert(plan(planner, 128, spotAC).size() == 1);
+    planner.reject(128, { static_cast<SmaInverterDataSet>(spotAC), 0x51000200, 0x00464000, 0x004657FF }, now);
+    assert(plan(planner, 128, spotAC).size() == 2);
+    planner.forget(128, { static_cast<SmaInverterDataSet>(spotAC), 0x51000200, 0x00464000, 0x004657FF });
+    assert(plan(planner, 128, spotAC).size() == 1);
+
+    // Rejections expire and are probed again, a repeated rejection holds twice as long
+    const SmaInverterRequest merged = { static_cast<SmaInverterDataSet>(spotAC), 0x51000200, 0x00464000, 0x004657FF };
+    planner.clear();
+    planner.reject(128, merged, now);
+    planner.expire(now + SmaRequestPlanner::minHold - std::chrono::seconds(1));
+    assert(plan(planner, 128, spotAC).size() == 2);
+    planner.expire(now + SmaRequestPlanner::minHold);
+    assert(plan(planner, 128, spotAC).size() == 1);
+    auto probe = now + SmaRequestPlanner::minHold;
+    planner.reject(128, merged, probe);
+    planner.expire(probe + SmaRequestPlanner::minHold);
+    assert(plan(planner, 128, spotAC).size() == 2);
+    planner.expire(probe + 2 * SmaRequestPlanner::minHold);
+    assert(plan(planner, 128, spotAC).size() == 1);
+
+    // Up to maxHold
+    for (int i = 0; i < 16; ++i) {
+        probe += SmaRequestPlanner::maxHold;
+        planner.reject(128, merged, probe);
+        planner.expire(probe + SmaRequestPlanner::maxHold);
+    }
+    assert(plan(planner, 128, spotAC).size() == 1);
+
+    // Requests of several inverters are appended
+    requests.clear();
+    planner.plan(128, SpotACPower, requests);
+    planner.plan(129, SpotACPower | SpotACVoltage, requests);
+    assert(requests.size() == 2);
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#include "../sma/SmaSessionMonitor.h"
+
+#include <cassert>
+
+using namespace sma;
+
+int main()
+{
+    SmaSessionMonitor session;
+
+    // A fresh login is never lost
+    session.start(false);
+    session.requestSent();
+    session.responseReceived(0x15);
+    assert(!session.isRejected());
+    assert(!session.isLost());
+
+    // A single rejection in a resumed session, e.g. a merged range, is no session loss
+    session.start(true);
+    session.requestSent();
+    session.requestSent();
+    session.responseReceived(0x15);
+    assert(!session.isRejected());
+    session.responseReceived(0);
+    assert(session.isAnswered());
+    assert(!session.isRejected());
+    assert(!session.isLost());
+
+    // Every request rejected is
+    session.start(true);
+    session.requestSent();
+    session.requestSent();
+    session.responseReceived(0x15);
+    session.responseReceived(0x15);
+    assert(session.isRejected());
+    assert(session.isLost());
+
+    // As is nothing answered at all
+    session.start(true);
+    session.requestSent();
+    assert(!session.isRejected());
+    assert(session.isLost());
+
+    // Unless nothing was due in the poll
+    session.start(true);
+    assert(!session.isAnswered());
+    assert(!session.isRejected());
+    assert(!session.isLost());
+
+    return 0;
+}
@@ -0,0 +1,787 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+/*
+ * Simulates a plant of Speedwire inverters on one Linux box, to load test
+ * SBFspot and SBFspot_qt without real hardware.
+ *
+ * Every virtual inverter has its own UDP socket on a loopback address
+ * (127.0.1.1, 127.0.1.2, ... by default). Linux routes the whole 127.0.0.0/8
+ * network to the loopback interface, so no aliases have to be configured.
+ * Set IP_Address in SBFspot.cfg to the list of simulated addresses.
+ *
+ * Answered requests: discovery (multicast 239.12.255.254), init, login and
+ * logout, the data ranges of SmaInverterRequests, historic day and month data
+ * and events. The values are synthetic and follow a sine shaped day (UTC).
+ *
+ * Options:
+ *   --count=N       Number of virtual inverters (1)
+ *   --base=IP       Address of the first inverter (127.0.1.1)
+ *   --port=N        UDP port (9522)
+ *   --latency=MS    Response delay (0)
+ *   --jitter=MS     Additional random delay, 0..MS (0)
+ *   --loss=PCT      Percentage of responses dropped (0)
+ *   --reorder=PCT   Percentage of responses delayed behind later ones (0)
+ *   --password=PW   Password accepted for login (0000)
+ *   --seed=N        Seed of the random generator (time)
+ *   --stats=S       Print counters every S seconds, 0 disables (10)
+ *   --nodiscovery   Don't answer discovery requests
+ *
+ * Note: SBFspot disables IP_MULTICAST_LOOP, so its discovery does not reach
+ * a simulator on the same host. SBFspot_qt does.
+ */
+
+#include "../Types.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static const char* MULTICAST_GROUP = "239.12.255.254";
+static const uint16_t SIM_SUSYID = 128;
+static const uint32_t SIM_FIRST_SERIAL = 2130000000;
+static const time_t SIM_EPOCH = 1420070400;    // 2015-01-01, start of the simulated energy counters
+static const int MAX_RECORDS = 80;              // Historic records per fragment
+
+// Commands (see SbfSpot::encode*Request())
+static const uint32_t CMD_INIT = 0x00000200;
+static const uint32_t CMD_LOGIN = 0xFFFD040C;
+static const uint32_t CMD_LOGOUT = 0xFFFD010E;
+static const uint32_t CMD_DAYDATA = 0x70000200;
+static const uint32_t CMD_MONTHDATA = 0x70200200;
+static const uint32_t CMD_EVENTS_USER = 0x70100200;
+static const uint32_t CMD_EVENTS_INSTALLER = 0x70120200;
+
+struct Options
+{
+    int count = 1;
+    std::string base = "127.0.1.1";
+    uint16_t port = 9522;
+    int latencyMs = 0;
+    int jitterMs = 0;
+    double loss = 0;
+    double reorder = 0;
+    std::string password = "0000";
+    unsigned seed = (unsigned)time(NULL);
+    int statsInterval = 10;
+    bool discovery = true;
+};
+
+struct VirtualInverter
+{
+    int fd = -1;
+    uint32_t address = 0;       // Network byte order
+    uint16_t susyId = SIM_SUSYID;
+    uint32_t serial = 0;
+    double pmax = 0;            // Nominal power (W)
+    bool loggedIn = false;
+};
+
+// A response waiting for its (simulated) transmission
+struct Delayed
+{
+    Clock::time_point due;
+    uint64_t seq;
+    int fd;
+    struct sockaddr_in to;
+    std::vector<uint8_t> data;
+
+    bool operator>(const Delayed& other) const
+    {
+        return (due > other.due) || ((due == other.due) && (seq > other.seq));
+    }
+};
+
+struct Counters
+{
+    uint64_t received = 0;
+    uint64_t discovery = 0;
+    uint64_t init = 0;
+    uint64_t login = 0;
+    uint64_t loginFailed = 0;
+    uint64_t logout = 0;
+    uint64_t data = 0;
+    uint64_t archive = 0;
+    uint64_t ignored = 0;       // Invalid, for another serial, or not logged in
+    uint64_t sent = 0;
+    uint64_t lost = 0;
+    uint64_t reordered = 0;
+};
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int)
+{
+    stopRequested = 1;
+}
+
+static uint16_t getShort(const uint8_t* p) { uint16_t v; memcpy(&v, p, sizeof(v)); return v; }
+static uint32_t getLong(const uint8_t* p) { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+
+/*
+ * Builds a response frame in the layout written by SBFNet's Buffer.
+ */
+class Frame
+{
+public:
+    Frame(const uint8_t* request, const VirtualInverter& inverter, uint16_t error, uint16_t fragment, uint32_t command)
+    {
+        static const uint8_t header[] = { 'S', 'M', 'A', 0, 0x00, 0x04, 0x02, 0xA0, 0x00, 0x00, 0x00, 0x01, 0, 0 };
+        m_data.assign(header, header + sizeof(header));
+        putLong(0x65601000);                // ETH_L2SIGNATURE
+        putByte(0);                         // Placeholder for longwords
+        putByte(0xA0);
+        m_data.insert(m_data.end(), request + 28, request + 36);   // Destination = source of the request
+        putShort(inverter.susyId);
+        putLong(inverter.serial);
+        putShort(getShort(request + 34));   // ctrl2
+        putShort(error);
+        putShort(fragment);
+        putShort(getShort(request + 40));   // Packet ID
+        putLong(command);
+    }
+
+    void putByte(uint8_t v) { m_data.push_back(v); }
+    void putShort(uint16_t v) { putBytes(&v, sizeof(v)); }
+    void putLong(uint32_t v) { putBytes(&v, sizeof(v)); }
+    void putLongLong(uint64_t v) { putBytes(&v, sizeof(v)); }
+    void putBytes(const void* data, size_t size)
+    {
+        const uint8_t* p = (const uint8_t*)data;
+        m_data.insert(m_data.end(), p, p + size);
+    }
+
+    std::vector<uint8_t>& finish()
+    {
+        putLong(0);     // Trailer
+        const size_t dataLength = m_data.size() - 20;
+        m_data[12] = (dataLength >> 8) & 0xFF;
+        m_data[13] = dataLength & 0xFF;
+        m_data[18] = (uint8_t)((m_data.size() - 22) / 4);
+        return m_data;
+    }
+
+private:
+    std::vector<uint8_t> m_data;
+};
+
+/*
+ * Synthetic plant model: a sine shaped production between 06:00 and 18:00 UTC.
+ */
+class PlantModel
+{
+public:
+    static double power(const VirtualInverter& inverter, time_t t)
+    {
+        const double hour = (t % 86400) / 3600.0;
+        if ((hour <= 6) || (hour >= 18)) return 0;
+        return inverter.pmax * sin(M_PI * (hour - 6) / 12);
+    }
+
+    // Energy produced since SIM_EPOCH (Wh)
+    static uint64_t totalEnergy(const VirtualInverter& inverter, time_t t)
+    {
+        const time_t day = (t - SIM_EPOCH) / 86400;
+        const double hour = (t % 86400) / 3600.0;
+        double today = 0;
+        if (hour >= 18)
+            today = dailyEnergy(inverter);
+        else if (hour > 6)
+            today = inverter.pmax * 12 / M_PI * (1 - cos(M_PI * (hour - 6) / 12));
+        return (uint64_t)(day * dailyEnergy(inverter) + today);
+    }
+
+    static uint64_t dayEnergy(const VirtualInverter& inverter, time_t t)
+    {
+        return totalEnergy(inverter, t) - totalEnergy(inverter, t - t % 86400);
+    }
+
+private:
+    static double dailyEnergy(const VirtualInverter& inverter) { return inverter.pmax * 24 / M_PI; }
+};
+
+class Simulator
+{
+public:
+    explicit Simulator(const Options& options) :
+        m_options(options),
+        m_random(options.seed)
+    {
+    }
+
+    ~Simulator()
+    {
+        for (const auto& inverter : m_inverters)
+            close(inverter.fd);
+        if (m_discoveryFd >= 0)
+            close(m_discoveryFd);
+    }
+
+    bool open()
+    {
+        struct in_addr base;
+        if (inet_aton(m_options.base.c_str(), &base) == 0)
+        {
+            std::cerr << "Invalid base address: " << m_options.base << std::endl;
+            return false;
+        }
+
+        for (int i = 0; i < m_options.count; ++i)
+        {
+            VirtualInverter inverter;
+            inverter.address = htonl(ntohl(base.s_addr) + i);
+            inverter.serial = SIM_FIRST_SERIAL + i;
+            inverter.pmax = 3000 + (i % 8) * 1000;
+            inverter.fd = bindSocket(inverter.address);
+            if (inverter.fd < 0)
+                return false;
+            m_inverters.push_back(inverter);
+        }
+
+        if (m_options.discovery)
+        {
+            m_discoveryFd = bindSocket(inet_addr(MULTICAST_GROUP));
+            if (m_discoveryFd < 0)
+                return false;
+
+            struct ip_mreq mreq;
+            mreq.imr_multiaddr.s_addr = inet_addr(MULTICAST_GROUP);
+            mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+            if (setsockopt(m_discoveryFd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
+                std::cerr << "IP_ADD_MEMBERSHIP failed: " << strerror(errno) << ". Discovery disabled." << std::endl;
+        }
+
+        m_pollFds.clear();
+        for (const auto& inverter : m_inverters)
+            m_pollFds.push_back({ inverter.fd, POLLIN, 0 });
+        if (m_discoveryFd >= 0)
+            m_pollFds.push_back({ m_discoveryFd, POLLIN, 0 });
+
+        return true;
+    }
+
+    void run()
+    {
+        auto nextStats = Clock::now() + std::chrono::seconds(m_options.statsInterval);
+        while (!stopRequested)
+        {
+            int timeoutMs = 1000;
+            if (!m_delayed.empty())
+            {
+                const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(m_delayed.top().due - Clock::now()).count();
+                timeoutMs = (int)std::max<int64_t>(0, std::min<int64_t>(wait, timeoutMs));
+            }
+
+            const int ready = poll(m_pollFds.data(), m_pollFds.size(), timeoutMs);
+            if ((ready < 0) && (errno != EINTR))
+            {
+                std::cerr << "poll() failed: " << strerror(errno) << std::endl;
+                break;
+            }
+
+            for (size_t i = 0; (ready > 0) && (i < m_pollFds.size()); ++i)
+            {
+                if (m_pollFds[i].revents & POLLIN)
+                    receive(m_pollFds[i].fd, (i < m_inverters.size()) ? &m_inverters[i] : nullptr);
+            }
+
+            transmitDue();
+
+            if ((m_options.statsInterval > 0) && (Clock::now() >= nextStats))
+            {
+                printStats();
+                nextStats += std::chrono::seconds(m_options.statsInterval);
+            }
+        }
+
+        printStats();
+    }
+
+private:
+    int bindSocket(uint32_t address)
+    {
+        int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+        if (fd < 0)
+        {
+            std::cerr << "socket() failed: " << strerror(errno) << std::endl;
+            return -1;
+        }
+
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(m_options.port);
+        addr.sin_addr.s_addr = address;
+        if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+        {
+            std::cerr << "bind(" << inet_ntoa(addr.sin_addr) << ":" << m_options.port << ") failed: " << strerror(errno) << std::endl;
+            close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    void receive(int fd, VirtualInverter* inverter)
+    {
+        uint8_t buf[2048];
+        struct sockaddr_in from;
+        socklen_t fromLen = sizeof(from);
+        ssize_t size;
+        while ((size = recvfrom(fd, buf, sizeof(buf), 0, (struct sockaddr*)&from, &fromLen)) > 0)
+        {
+            ++m_counters.received;
+            if (inverter)
+                handleRequest(*inverter, buf, (size_t)size, from);
+            else
+                handleDiscovery(buf, (size_t)size, from);
+            fromLen = sizeof(from);
+        }
+    }
+
+    void handleDiscovery(const uint8_t* buf, size_t size, const struct sockaddr_in& from)
+    {
+        static const uint8_t request[] = { 'S', 'M', 'A', 0, 0x00, 0x04, 0x02, 0xA0, 0xFF, 0xFF, 0xFF, 0xFF };
+        if ((size < 20) || (memcmp(buf, request, sizeof(request)) != 0))
+        {
+            ++m_counters.ignored;
+            return;
+        }
+
+        ++m_counters.discovery;
+        for (const auto& inverter : m_inverters)
+        {
+            // Tagged response, the IP address of the device is at offset 38
+            static const uint8_t head[] = {
+                'S', 'M', 'A', 0, 0x00, 0x04, 0x02, 0xA0, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00,
+                0x00, 0x01, 0x00, 0x04, 0x00, 0x10, 0x00, 0x01, 0x00, 0x03, 0x00, 0x04, 0x00, 0x20, 0x00, 0x00,
+                0x00, 0x01, 0x00, 0x04, 0x00, 0x30 };
+            static const uint8_t tail[] = { 0x00, 0x04, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x70, 0xEF, 0x0C, 0x00, 0x00, 0x00, 0x00 };
+            std::vector<uint8_t> response(head, head + sizeof(head));
+            const uint8_t* ip = (const uint8_t*)&inverter.address;
+            response.insert(response.end(), ip, ip + 4);
+            response.insert(response.end(), tail, tail + sizeof(tail));
+            schedule(inverter.fd, from, std::move(response), responseDelay());
+        }
+    }
+
+    void handleRequest(VirtualInverter& inverter, const uint8_t* buf, size_t size, const struct sockaddr_in& from)
+    {
+        static const uint8_t l2Signature[] = { 0x00, 0x10, 0x60, 0x65 };
+        if ((size < 54) || (memcmp(buf, "SMA", 4) != 0) || (memcmp(buf + 14, l2Signature, sizeof(l2Signature)) != 0))
+        {
+            ++m_counters.ignored;
+            return;
+        }
+
+        const uint32_t dstSerial = getLong(buf + 22);
+        if ((dstSerial != 0xFFFFFFFF) && (dstSerial != inverter.serial))
+        {
+            ++m_counters.ignored;
+            return;
+        }
+
+        const uint32_t command = getLong(buf + 42);
+        const uint32_t first = getLong(buf + 46);
+        const uint32_t last = getLong(buf + 50);
+
+        switch (command)
+        {
+        case CMD_INIT:
+        {
+            ++m_counters.init;
+            Frame frame(buf, inverter, 0, 0, command + 1);
+            frame.putLong(0);
+            frame.putLong(0);
+            schedule(inverter.fd, from, std::move(frame.finish()), responseDelay());
+            return;
+        }
+
+        case CMD_LOGIN:
+        {
+            if (size < 74) break;
+            const bool accepted = checkPassword(first, buf + 62);
+            inverter.loggedIn = accepted;
+            ++(accepted ? m_counters.login : m_counters.loginFailed);
+            Frame frame(buf, inverter, accepted ? 0 : 0x0100, 0, command + 1);
+            frame.putBytes(buf + 46, 28);   // Echo user group, timeout, time and password
+            schedule(inverter.fd, from, std::move(frame.finish()), responseDelay());
+            return;
+        }
+
+        case CMD_LOGOUT:
+            ++m_counters.logout;
+            inverter.loggedIn = false;
+            return;     // Not answered
+
+        default:
+            break;
+        }
+
+        if (!inverter.loggedIn || ((command & 0xFFFF) != 0x0200))
+        {
+            ++m_counters.ignored;
+            return;
+        }
+
+        switch (command)
+        {
+        case CMD_DAYDATA:
+            ++m_counters.archive;
+            sendHistory(inverter, buf, from, first, last, 300);
+            break;
+
+        case CMD_MONTHDATA:
+            ++m_counters.archive;
+            sendHistory(inverter, buf, from, first, last, 86400);
+            break;
+
+        case CMD_EVENTS_USER:
+        case CMD_EVENTS_INSTALLER:
+            ++m_counters.archive;
+            sendEvents(inverter, buf, from, first, last);
+            break;
+
+        default:
+            ++m_counters.data;
+            sendData(inverter, buf, from, command, first, last);
+            break;
+        }
+    }
+
+    bool checkPassword(uint32_t userGroup, const uint8_t* encoded) const
+    {
+        const uint8_t encChar = (userGroup == UG_USER) ? 0x88 : 0xBB;
+        char password[13] = { 0 };
+        for (int i = 0; i < 12; ++i)
+        {
+            if (encoded[i] == encChar) break;
+            password[i] = (char)(encoded[i] - encChar);
+        }
+        return m_options.password == password;
+    }
+
+    void sendData(const VirtualInverter& inverter, const uint8_t* request, const struct sockaddr_in& from, uint32_t command, uint32_t first, uint32_t last)
+    {
+        const time_t now = time(NULL);
+        const double pac = PlantModel::power(inverter, now);
+        const double pdc = pac * 1.04 / 2;
+        const int32_t udc = pac > 0 ? 58000 : 0;   // V * 100
+
+        Frame frame(request, inverter, 0, 0, command + 1);
+        frame.putLong(first);
+        frame.putLong(last);
+
+        const uint32_t from_lri = first & 0x00FFFF00;
+        const uint32_t to_lri = last & 0x00FFFF00;
+        auto inRange = [&](LriDef lri) { return (lri >= from_lri) && (lri <= to_lri); };
+
+        auto putDword = [&](LriDef lri, uint8_t cls, uint8_t dataType, int32_t value) {
+            if (!inRange(lri)) return;
+            frame.putLong((dataType << 24) | lri | cls);
+            frame.putLong((uint32_t)now);
+            for (int i = 0; i < 4; ++i) frame.putLong(value);
+            frame.putLong(1);
+        };
+        auto putQword = [&](LriDef lri, uint64_t value) {
+            if (!inRange(lri)) return;
+            frame.putLong(lri | 1);
+            frame.putLong((uint32_t)now);
+            frame.putLongLong(value);
+        };
+        auto putStatus = [&](LriDef lri, const std::vector<uint32_t>& attributes, uint32_t selected) {
+            if (!inRange(lri)) return;
+            frame.putLong((0x08 << 24) | lri | 1);
+            frame.putLong((uint32_t)now);
+            for (size_t i = 0; i < 8; ++i)
+            {
+                if (i < attributes.size())
+                    frame.putLong(attributes[i] | (attributes[i] == selected ? 0x01000000 : 0));
+                else
+                    frame.putLong(i == attributes.size() ? 0x00FFFFFE : 0);
+            }
+        };
+
+        putStatus(OperationHealth, { 35, 303, 307, 455 }, 307);     // Ok
+        putDword(CoolsysTmpNom, 1, 0x40, (int32_t)(2500 + 2000 * pac / inverter.pmax));
+        putDword(DcMsWatt, 1, 0x40, (int32_t)pdc);
+        putDword(DcMsWatt, 2, 0x40, (int32_t)pdc);
+        putQword(MeteringTotWhOut, PlantModel::totalEnergy(inverter, now));
+        putQword(MeteringDyWhOut, PlantModel::dayEnergy(inverter, now));
+        putDword(GridMsTotW, 1, 0x40, (int32_t)pac);
+        putDword(OperationHealthSttOk, 1, 0x00, (int32_t)inverter.pmax);
+        putDword(OperationHealthSttWrn, 1, 0x00, (int32_t)inverter.pmax);
+        putDword(OperationHealthSttAlm, 1, 0x00, (int32_t)inverter.pmax);
+        putStatus(OperationGriSwStt, { 311, 51 }, pac > 0 ? 51 : 311); // Closed / Open
+        putDword(DcMsVol, 1, 0x40, udc);
+        putDword(DcMsVol, 2, 0x40, udc);
+        putDword(DcMsAmp, 1, 0x40, udc ? (int32_t)(pdc * 100000 / udc) : 0);
+        putDword(DcMsAmp, 2, 0x40, udc ? (int32_t)(pdc * 100000 / udc) : 0);
+        putQword(MeteringTotOpTms, (uint64_t)(now - SIM_EPOCH) * 6 / 10);
+        putQword(MeteringTotFeedTms, (uint64_t)(now - SIM_EPOCH) / 2);
+        putDword(GridMsWphsA, 1, 0x40, (int32_t)(pac / 3));
+        putDword(GridMsWphsB, 1, 0x40, (int32_t)(pac / 3));
+        putDword(GridMsWphsC, 1, 0x40, (int32_t)(pac / 3));
+        putDword(GridMsPhVphsA, 1, 0x00, 23010);
+        putDword(GridMsPhVphsB, 1, 0x00, 23040);
+        putDword(GridMsPhVphsC, 1, 0x00, 22990);
+        putDword(GridMsAphsA_1, 1, 0x00, (int32_t)(pac / 3 / 230 * 1000));
+        putDword(GridMsAphsB_1, 1, 0x00, (int32_t)(pac / 3 / 230 * 1000));
+        putDword(GridMsAphsC_1, 1, 0x00, (int32_t)(pac / 3 / 230 * 1000));
+        putDword(GridMsHz, 1, 0x00, 5000);
+
+        if (inRange(NameplateLocation))
+        {
+            char name[32] = { 0 };
+            snprintf(name, sizeof(name), "SN: %u", inverter.serial);
+            frame.putLong((0x10 << 24) | NameplateLocation | 1);
+            frame.putLong((uint32_t)now);
+            frame.putBytes(name, sizeof(name));
+        }
+        putStatus(NameplateMainModel, { SolarInverter }, SolarInverter);
+        putStatus(NameplateModel, { 9067 }, 9067);  // STP 10000TL-10
+        if (inRange(NameplatePkgRev))
+        {
+            const uint32_t version = 0x02300000 | (55 << 8) | 4;   // 02.30.55.R
+            frame.putLong((0x08 << 24) | NameplatePkgRev | 1);
+            frame.putLong((uint32_t)now);
+            for (int i = 0; i < 8; ++i) frame.putLong(version);
+        }
+        putDword(InverterWLim, 1, 0x00, (int32_t)inverter.pmax);
+
+        schedule(inverter.fd, from, std::move(frame.finish()), responseDelay());
+    }
+
+    // Historic day (interval 300) or month (interval 86400) data, split into fragments
+    void sendHistory(const VirtualInverter& inverter, const uint8_t* request, const struct sockaddr_in& from, time_t start, time_t end, time_t interval)
+    {
+        end = std::min(end, time(NULL));
+        std::vector<time_t> times;
+        for (time_t t = start - (start % interval) + (start % interval ? interval : 0); t <= end; t += interval)
+            times.push_back(t);
+
+        const uint32_t command = getLong(request + 42) + 1;
+        const size_t fragments = std::max<size_t>(1, (times.size() + MAX_RECORDS - 1) / MAX_RECORDS);
+        const int delayMs = responseDelay();    // Same for all fragments, so they stay in order
+        for (size_t fragment = 0; fragment < fragments; ++fragment)
+        {
+            // The fragment ID counts down, the last fragment has ID 0
+            Frame frame(request, inverter, 0, (uint16_t)(fragments - 1 - fragment), command);
+            frame.putLong(getLong(request + 46));
+            frame.putLong(getLong(request + 50));
+            for (size_t i = fragment * MAX_RECORDS; (i < times.size()) && (i < (fragment + 1) * MAX_RECORDS); ++i)
+            {
+                frame.putLong((uint32_t)times[i]);
+                frame.putLongLong(PlantModel::totalEnergy(inverter, times[i]));
+            }
+            schedule(inverter.fd, from, std::move(frame.finish()), delayMs);
+        }
+    }
+
+    void sendEvents(const VirtualInverter& inverter, const uint8_t* request, const struct sockaddr_in& from, time_t start, time_t end)
+    {
+        const uint32_t command = getLong(request + 42) + 1;
+        Frame frame(request, inverter, 0, 0, command);
+        frame.putLong((uint32_t)start);
+        frame.putLong((uint32_t)end);
+
+        // Two events a day at 06:00 and 18:00 UTC. The last one sent has EntryID 1.
+        std::vector<time_t> times;
+        end = std::min(end, time(NULL));
+        for (time_t day = start - (start % 86400); day <= end; day += 86400)
+        {
+            for (time_t t : { day + 18 * 3600, day + 6 * 3600 })
+                if ((t >= start) && (t <= end)) times.insert(times.begin(), t);
+        }
+        if (times.size() > 10) times.resize(10);
+
+        for (size_t i = 0; i < times.size(); ++i)
+        {
+            SMA_EVENTDATA event;
+            memset(&event, 0, sizeof(event));
+            event.DateTime = (int32_t)times[i];
+            event.EntryID = (uint16_t)(times.size() - i);
+            event.SUSyID = inverter.susyId;
+            event.SerNo = inverter.serial;
+            event.EventCode = 10;
+            event.EventFlags = 0x4000;
+            event.Group = 1;
+            frame.putBytes(&event, sizeof(event));
+        }
+
+        schedule(inverter.fd, from, std::move(frame.finish()), responseDelay());
+    }
+
+    int responseDelay()
+    {
+        int delayMs = m_options.latencyMs;
+        if (m_options.jitterMs > 0)
+            delayMs += std::uniform_int_distribution<int>(0, m_options.jitterMs)(m_random);
+        return delayMs;
+    }
+
+    void schedule(int fd, const struct sockaddr_in& to, std::vector<uint8_t>&& data, int delayMs)
+    {
+        std::uniform_real_distribution<double> percent(0, 100);
+        if (percent(m_random) < m_options.loss)
+        {
+            ++m_counters.lost;
+            return;
+        }
+
+        if (percent(m_random) < m_options.reorder)
+        {
+            // Hold back long enough to be overtaken by the next responses
+            delayMs += 1 + m_options.latencyMs + m_options.jitterMs;
+            ++m_counters.reordered;
+        }
+
+        if (delayMs == 0 && m_delayed.empty())
+        {
+            transmit(fd, to, data);
+            return;
+        }
+
+        m_delayed.push({ Clock::now() + std::chrono::milliseconds(delayMs), m_seq++, fd, to, std::move(data) });
+    }
+
+    void transmitDue()
+    {
+        const auto now = Clock::now();
+        while (!m_delayed.empty() && (m_delayed.top().due <= now))
+        {
+            const Delayed& d = m_delayed.top();
+            transmit(d.fd, d.to, d.data);
+            m_delayed.pop();
+        }
+    }
+
+    void transmit(int fd, const struct sockaddr_in& to, const std::vector<uint8_t>& data)
+    {
+        if (sendto(fd, data.data(), data.size(), 0, (const struct sockaddr*)&to, sizeof(to)) < 0)
+            std::cerr << "sendto() failed: " << strerror(errno) << std::endl;
+        else
+            ++m_counters.sent;
+    }
+
+    void printStats() const
+    {
+        std::cout << "received: " << m_counters.received
+                  << ", discovery: " << m_counters.discovery
+                  << ", init: " << m_counters.init
+                  << ", login: " << m_counters.login << "/" << m_counters.loginFailed << " failed"
+                  << ", logout: " << m_counters.logout
+                  << ", data: " << m_counters.data
+                  << ", archive: " << m_counters.archive
+                  << ", ignored: " << m_counters.ignored
+                  << ", sent: " << m_counters.sent
+                  << ", lost: " << m_counters.lost
+                  << ", reordered: " << m_counters.reordered
+                  << std::endl;
+    }
+
+    const Options m_options;
+    std::mt19937 m_random;
+    std::vector<VirtualInverter> m_inverters;
+    int m_discoveryFd = -1;
+    std::vector<struct pollfd> m_pollFds;
+    std::priority_queue<Delayed, std::vector<Delayed>, std::greater<Delayed>> m_delayed;
+    uint64_t m_seq = 0;
+    Counters m_counters;
+};
+
+static bool parseOption(const std::string& arg, const char* name, std::string& value)
+{
+    const std::string prefix = std::string("--") + name + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0)
+        return false;
+    value = arg.substr(prefix.size());
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        std::string value;
+        if (parseOption(arg, "count", value)) options.count = std::stoi(value);
+        else if (parseOption(arg, "base", value)) options.base = value;
+        else if (parseOption(arg, "port", value)) options.port = (uint16_t)std::stoi(value);
+        else if (parseOption(arg, "latency", value)) options.latencyMs = std::stoi(value);
+        else if (parseOption(arg, "jitter", value)) options.jitterMs = std::stoi(value);
+        else if (parseOption(arg, "loss", value)) options.loss = std::stod(value);
+        else if (parseOption(arg, "reorder", value)) options.reorder = std::stod(value);
+        else if (parseOption(arg, "password", value)) options.password = value;
+        else if (parseOption(arg, "seed", value)) options.seed = (unsigned)std::stoul(value);
+        else if (parseOption(arg, "stats", value)) options.statsInterval = std::stoi(value);
+        else if (arg == "--nodiscovery") options.discovery = false;
+        else
+        {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    Simulator simulator(options);
+    if (!simulator.open())
+        return 1;
+
+    std::cout << "Simulating " << options.count << " inverter(s) from " << options.base << ":" << options.port << std::endl;
+    simulator.run();
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+/*
+ * Records a poll cycle to a trace and replays it. The socket sends the
+ * requests to itself over the loopback interface, so every request is
+ * answered by its own echo.
+ */
+
+#include "../Defines.h"
+#include "../Ethernet.h"
+#include "../SBFspot.h"
+#include "../misc.h"
+
+#include <cassert>
+#include <cstdio>
+
+static const char* TRACE = "speedwiretracetest.trc";
+
+static std::vector<EthRequest> createRequests(SbfSpot& sbfspot)
+{
+    std::vector<EthRequest> requests(10);
+    for (auto& request : requests)
+    {
+        request.ip = "127.0.0.1";
+        request.request = sbfspot.encodeDataRequest(0xFFFF, 0xFFFFFFFF, SpotACPower);
+        request.packetId = sbfspot.packetId();
+    }
+    return requests;
+}
+
+int main()
+{
+    ConnType = CT_ETHERNET;
+    SbfSpot sbfspot;
+
+    // Record
+    std::vector<EthRequest> recorded;
+    {
+        Ethernet ethernet;
+        assert(ethernet.startRecording(TRACE));
+        assert(ethernet.ethConnect(19524) == 0);
+
+        recorded = createRequests(sbfspot);
+        assert(ethernet.ethExchange(recorded, 1000) == E_OK);
+    }
+
+    // The trace holds every datagram in both directions, in order
+    {
+        TraceReader reader;
+        assert(reader.open(TRACE));
+        for (const auto& request : recorded)
+        {
+            const TraceRecord* record = reader.peek(TraceRecord::Sent);
+            assert(record);
+            assert(record->data == request.request);
+            assert(record->address == 0x0100007F);
+            assert(record->port == 19524);
+            reader.pop();
+        }
+        assert(!reader.peek(TraceRecord::Sent));
+    }
+    {
+        TraceReader reader;
+        assert(reader.open(TRACE, 2.0));
+        uint64_t timestamp = 0;
+        for (size_t i = 0; i < recorded.size(); i++)
+        {
+            const TraceRecord* record = reader.peek(TraceRecord::Received);
+            assert(record);
+            assert(record->data.size() == recorded[i].request.size());
+            assert(record->timestamp >= timestamp);
+            timestamp = record->timestamp;
+            reader.pop();
+        }
+        assert(!reader.peek(TraceRecord::Received));
+    }
+
+    // Replay the same requests, as fast as possible
+    {
+        // A new encoder starts over with the packet IDs of the recording
+        SbfSpot replaySbfspot;
+        Ethernet ethernet;
+        assert(ethernet.startReplay(TRACE, 0));
+        assert(ethernet.ethConnect(19524) == 0);
+
+        auto requests = createRequests(replaySbfspot);
+        assert(ethernet.ethExchange(requests, 1000) == E_OK);
+        for (size_t i = 0; i < requests.size(); i++)
+        {
+            assert(requests[i].response.size() == recorded[i].request.size() - sizeof(ethPacketHeaderL1) + 1);
+            assert((get_short(requests[i].response.data() + 27) & 0x7FFF) == requests[i].packetId);
+        }
+        assert(ethernet.stats().datagramsReceived == requests.size());
+    }
+
+    std::remove(TRACE);
+    return 0;
+}
@@ -0,0 +1,170 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+/*
+ * Driver for the fuzz targets when they are not linked with libFuzzer.
+ *
+ *   <target>                   run the seeds, all their truncations and random mutations
+ *   <target> file...           run the given inputs (AFL with @@, crash reproduction)
+ *   <target> -                 run stdin (AFL without @@)
+ *   <target> --benchmark       decode the seeds in a loop and report the throughput
+ *   <target> --write-seeds dir write the seeds as initial corpus for libFuzzer/AFL
+ *
+ * Build with -fsanitize=address,undefined to catch reads past the datagram.
+ */
+
+#include "FuzzSeeds.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+std::vector<FuzzSeed> fuzzSeeds();
+
+static const int MUTATIONS = 20000;
+static const auto BENCHMARK_TIME = std::chrono::seconds(2);
+
+// Runs the input from a copy of its exact size, so ASan sees any overread
+static void run(const uint8_t* data, size_t size)
+{
+    std::vector<uint8_t> input(data, data + size);
+    LLVMFuzzerTestOneInput(input.data(), input.size());
+}
+
+static int runFile(const char* path)
+{
+    std::vector<uint8_t> input;
+    if (strcmp(path, "-") == 0)
+        input.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+    else
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            std::cerr << "Unable to open " << path << std::endl;
+            return 1;
+        }
+        input.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    run(input.data(), input.size());
+    return 0;
+}
+
+static int smokeTest(const std::vector<FuzzSeed>& seeds)
+{
+    std::mt19937 random(5489);
+    size_t inputs = 0;
+
+    for (const auto& seed : seeds)
+    {
+        for (size_t size = 0; size <= seed.data.size(); size++, inputs++)
+            run(seed.data.data(), size);
+
+        std::vector<uint8_t> input;
+        for (int i = 0; i < MUTATIONS; i++, inputs++)
+        {
+            input = seed.data;
+            const int flips = 1 + random() % 8;
+            for (int f = 0; f < flips; f++)
+                input[random() % input.size()] = random() & 0xFF;
+            input.resize(random() % (input.size() + 1));
+            run(input.data(), input.size());
+        }
+    }
+
+    std::cout << inputs << " inputs OK" << std::endl;
+    return 0;
+}
+
+static int benchmark(const std::vector<FuzzSeed>& seeds)
+{
+    for (const auto& seed : seeds)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::steady_clock::duration::zero();
+        size_t frames = 0;
+        while (elapsed < BENCHMARK_TIME)
+        {
+            for (int i = 0; i < 1000; i++)
+                LLVMFuzzerTestOneInput(seed.data.data(), seed.data.size());
+            frames += 1000;
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+
+        const double seconds = std::chrono::duration<double>(elapsed).count();
+        std::cout << seed.name << ": " << seed.data.size() << " bytes, "
+                  << (long)(frames / seconds) << " frames/s, "
+                  << frames * seed.data.size() / seconds / 1e6 << " MB/s" << std::endl;
+    }
+    return 0;
+}
+
+static int writeSeeds(const std::vector<FuzzSeed>& seeds, const std::string& dir)
+{
+    for (const auto& seed : seeds)
+    {
+        std::ofstream file(dir + "/" + seed.name, std::ios::binary);
+        file.write((const char*)seed.data.data(), seed.data.size());
+        if (!file)
+        {
+            std::cerr << "Unable to write " << dir << "/" << seed.name << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const auto seeds = fuzzSeeds();
+
+    if (argc == 1)
+        return smokeTest(seeds);
+    if (strcmp(argv[1], "--benchmark") == 0)
+        return benchmark(seeds);
+    if (strcmp(argv[1], "--write-seeds") == 0 && argc == 3)
+        return writeSeeds(seeds, argv[2]);
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (runFile(argv[i]) != 0)
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,208 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+#include "FuzzSeeds.h"
+
+#include "../../Types.h"
+
+// Nameplate response from sma/SmaTypes.h (truncated after the first record)
+static const uint8_t nameplateDump[] = {
+    0x53, 0x4D, 0x41, 0x00, 0x00, 0x04, 0x02, 0xA0, 0x00, 0x00, 0x00, 0x01, 0x00, 0x4E, 0x00, 0x10,
+    0x60, 0x65, 0x13, 0xA0, 0x7D, 0x00, 0xD9, 0x96, 0x77, 0x37, 0x00, 0xA0, 0x98, 0x01, 0xCC, 0x24,
+    0x3A, 0xB3, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x80, 0x01, 0x02, 0x00, 0x58, 0x0A, 0x00,
+    0x00, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x01, 0x34, 0x82, 0x00, 0x7E, 0xF9, 0x7A, 0x60, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFE, 0xFF, 0xFF, 0xFF, 0xFE, 0xFF, 0xFF, 0xFF, 0x04, 0x0F
+};
+
+// DayData response from sma/SmaTypes.h (truncated after the second record)
+static const uint8_t dayDataDump[] = {
+    0x53, 0x4D, 0x41, 0x00, 0x00, 0x04, 0x02, 0xA0, 0x00, 0x00, 0x00, 0x01, 0x03, 0xF2, 0x00, 0x10,
+    0x60, 0x65, 0xFC, 0xE0, 0x7D, 0x00, 0xD9, 0x96, 0x77, 0x37, 0x00, 0xA0, 0x98, 0x01, 0xCC, 0x24,
+    0x3A, 0xB3, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00, 0x05, 0x80, 0x01, 0x02, 0x00, 0x70, 0x77, 0x31,
+    0x00, 0x00, 0xC7, 0x31, 0x00, 0x00, 0x4C, 0x6E, 0x7B, 0x60, 0xF7, 0x99, 0x0D, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x78, 0x6F, 0x7B, 0x60, 0xF7, 0x99, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0xA4, 0x70
+};
+
+static void putShort(std::vector<uint8_t>& buf, uint16_t v)
+{
+    buf.push_back(v & 0xFF);
+    buf.push_back(v >> 8);
+}
+
+static void putLong(std::vector<uint8_t>& buf, uint32_t v)
+{
+    putShort(buf, v & 0xFFFF);
+    putShort(buf, v >> 16);
+}
+
+static void putLongBE(std::vector<uint8_t>& buf, uint32_t v)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        buf.push_back((v >> shift) & 0xFF);
+}
+
+// Complete inverter response with the addresses of the dumps above
+static std::vector<uint8_t> inverterFrame(uint32_t dataSet, uint32_t first, uint32_t last, const std::vector<uint8_t>& payload)
+{
+    std::vector<uint8_t> frame = { 0x53, 0x4D, 0x41, 0x00, 0x00, 0x04, 0x02, 0xA0, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x10, 0x60, 0x65, 0x00, 0xA0 };
+    putShort(frame, 0x007D);        // Destination
+    putLong(frame, 0x377796D9);
+    putShort(frame, 0xA000);
+    putShort(frame, 0x0198);        // Source
+    putLong(frame, 0xB33A24CC);
+    putShort(frame, 0x0000);
+    putShort(frame, 0x0000);        // Error
+    putShort(frame, 0x0000);        // Fragment
+    putShort(frame, 0x8005);        // Packet ID
+    putLong(frame, dataSet);
+    putLong(frame, first);
+    putLong(frame, last);
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    putLong(frame, 0);              // End of packet
+
+    const size_t size = frame.size() - 20;
+    frame[12] = (size >> 8) & 0xFF;
+    frame[13] = size & 0xFF;
+    frame[18] = (frame.size() - 18) / 4;
+    return frame;
+}
+
+static std::vector<uint8_t> spotFrame()
+{
+    const uint32_t lris[] = { GridMsTotW, GridMsWphsA, GridMsWphsB, GridMsWphsC, GridMsPhVphsA, GridMsPhVphsB, GridMsPhVphsC };
+    std::vector<uint8_t> payload;
+    for (uint32_t lri : lris)
+    {
+        putLong(payload, 0x40000001 | lri);
+        putLong(payload, 1618700000);
+        for (int i = 0; i < 5; i++)
+            putLong(payload, (i == 2) ? 0x80000000 : 1234);  // NaN in the middle
+    }
+    return inverterFrame(0x51000201, 0x00263F00, 0x004642FF, payload);
+}
+
+static std::vector<uint8_t> energyFrame()
+{
+    const uint32_t lris[] = { MeteringTotWhOut, MeteringDyWhOut, MeteringTotOpTms, MeteringTotFeedTms };
+    std::vector<uint8_t> payload;
+    for (uint32_t lri : lris)
+    {
+        putLong(payload, 0x00000001 | lri);
+        putLong(payload, 1618700000);
+        putLong(payload, 987654321);
+        putLong(payload, 0);
+    }
+    return inverterFrame(0x54000201, 0x00260100, 0x002622FF, payload);
+}
+
+static std::vector<uint8_t> archiveFrame(uint32_t dataSet)
+{
+    std::vector<uint8_t> payload;
+    for (uint32_t i = 0; i < 80; i++)
+    {
+        putLong(payload, 1618700000 + i * 300);
+        putLong(payload, (i == 79) ? 0xFFFFFFFF : 893431 + i);
+        putLong(payload, (i == 79) ? 0xFFFFFFFF : 0);
+    }
+    return inverterFrame(dataSet, 0, 79, payload);
+}
+
+static std::vector<uint8_t> eventFrame()
+{
+    std::vector<uint8_t> payload;
+    for (uint16_t entry = 5; entry > 0; entry--)
+    {
+        putLong(payload, 1618700000 + entry * 60);  // DateTime
+        putShort(payload, entry);                   // EntryID
+        putShort(payload, 0x0198);                  // SUSyID
+        putLong(payload, 0xB33A24CC);               // SerNo
+        putShort(payload, 10000 + entry);           // EventCode
+        putShort(payload, 0x4000);                  // EventFlags
+        for (int i = 0; i < 8; i++)                 // Group ... OldVal
+            putLong(payload, i);
+    }
+    return inverterFrame(0x70100201, 0, 4, payload);
+}
+
+std::vector<FuzzSeed> inverterSeeds()
+{
+    return {
+        { "nameplate_dump", std::vector<uint8_t>(nameplateDump, nameplateDump + sizeof(nameplateDump)) },
+        { "daydata_dump", std::vector<uint8_t>(dayDataDump, dayDataDump + sizeof(dayDataDump)) },
+        { "spot_ac", spotFrame() },
+        { "spot_energy", energyFrame() },
+        { "daydata", archiveFrame(HistoricDayDataResponse) },
+        { "monthdata", archiveFrame(HistoricMonthDataResponse) },
+        { "events", eventFrame() }
+    };
+}
+
+// Energy meter datagram: L1 header, SUSyID + serial + ticker, OBIS elements, end tag
+static std::vector<uint8_t> energyMeterFrame()
+{
+    std::vector<uint8_t> frame = { 0x53, 0x4D, 0x41, 0x00, 0x00, 0x04, 0x02, 0xA0, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x10, 0x60, 0x69 };
+    frame.push_back(0x01);          // SUSyID 349
+    frame.push_back(0x5D);
+    putLongBE(frame, 1900123456);   // Serial
+    putLongBE(frame, 123456789);    // Ticker
+
+    const uint8_t powerIndices[] = { 1, 2, 21, 22, 41, 42, 61, 62 };
+    for (uint8_t index : powerIndices)
+    {
+        frame.insert(frame.end(), { 0x00, index, 0x04, 0x00 });
+        putLongBE(frame, 12345);
+        frame.insert(frame.end(), { 0x00, index, 0x08, 0x00 });
+        putLongBE(frame, 0);
+        putLongBE(frame, 1234567890);
+    }
+    const uint8_t phaseIndices[] = { 31, 32, 51, 52, 71, 72 };
+    for (uint8_t index : phaseIndices)
+    {
+        frame.insert(frame.end(), { 0x00, index, 0x04, 0x00 });
+        putLongBE(frame, 2301);
+    }
+    frame.insert(frame.end(), { 0x90, 0x00, 0x00, 0x00, 0x02, 0x00, 0x12, 0x52 });  // Software version
+
+    const size_t size = frame.size() - 16;
+    frame[12] = (size >> 8) & 0xFF;
+    frame[13] = size & 0xFF;
+    putLongBE(frame, 0);            // End tag
+    return frame;
+}
+
+std::vector<FuzzSeed> energyMeterSeeds()
+{
+    return { { "energymeter", energyMeterFrame() } };
+}
@@ -0,0 +1,67 @@
+/************************************************************************************************
+    SBFspot - Yet another tool to read power production of SMA solar inverters
+    (c)2012-2021, SBF
+
+    Latest version found at https://github.com/SBFspot/SBFspot
+
+    License: Attribution-NonCommercial-ShareAlike 3.0 Unported (CC BY-NC-SA 3.0)
+    http://creativecommons.org/licenses/by-nc-sa/3.0/
+
+    You are free:
+        to Share - to copy, distribute and transmit the work
+        to Remix - to adapt the work
+    Under the following conditions:
+    Attribution:
+        You must attribute the work in the manner specified by the author or licensor
+        (but not in any way that suggests that they endorse you or your use of the work).
+    Noncommercial:
+        You may not use this work for commercial purposes.
+    Share Alike:
+        If you alter, transform, or build upon this work, you may distribute the resulting work
+        only under the same or similar license to this one.
+
+DISCLAIMER:
+    A user of SBFspot software acknowledges that he or she is receiving this
+    software on an "as is" basis and the user is not relying on the accuracy
+    or functionality of the software for any purpose. The user further
+    acknowledges that any use of this software will be at his own risk
+    and the copyright owner accepts no responsibility whatsoever arising from
+    the use or application of the software.
+
+    SMA is a registered trademark of SMA Solar Technology AG
+
+************************************************************************************************/
+
+
+/*
+ * Response handling of SmaInverter::decodeResponse(), without the Qt parts.
+ */
+
+#include "FuzzSeeds.h"
+
+#include "../../sma/SmaResponse.h"
+#include "../../sma/SmaTypes.h"
+
+std::vector<FuzzSeed> fuzzSeeds()
+{
+    return inverterSeeds();
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    const SmaPacketView packet(data, size);
+    if (packet.payloadSize() < 12)
+        return 0;
+
+    std::vector<DayData> dayData;
+    std::vector<MonthData> monthData;
+    LiveData liveData(packet.sourceSerial());
+    InverterDataMap inverterDataMap;
+    std::set<LriDef> lris;
+
+    // Every decoder sees every input, the data set is easily mutated anyway
+    sma::decodeDayData(packet.payload(), packet.payloadSize(), packet.sourceSerial(), dayData);
+    sma::decodeMonthData(packet.payload(), packet.payloadSize(), packet.sourceSerial(), monthData);
+    sma::decodeLiveData(packet.payload(), packet.payloadSize(), liveData, inverterDataMap, lris);
+    return 0;
+}